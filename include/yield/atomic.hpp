@@ -32,6 +32,8 @@
 
 #include "yield/types.hpp"
 
+#include <atomic>
+
 #if defined(_WIN64)
 extern "C" {
   __int64 _InterlockedCompareExchange64(
@@ -40,6 +42,13 @@ extern "C" {
     __int64 old_value
   );
 
+  unsigned char _InterlockedCompareExchange128(
+    volatile __int64* cur_value,
+    __int64 new_value_high,
+    __int64 new_value_low,
+    __int64* old_value
+  );
+
   __int64 _InterlockedIncrement64(volatile __int64* cur_value);
   __int64 _InterlockedDecrement64(volatile __int64* cur_value);
 }
@@ -61,6 +70,12 @@ extern "C" {
   InterlockedDecrement(
     volatile long* cur_value
   );
+
+  __int64 _InterlockedCompareExchange64(
+    volatile __int64* cur_value,
+    __int64 new_value,
+    __int64 old_value
+  );
 }
 #elif defined(__sun)
 #include <atomic.h>
@@ -236,6 +251,289 @@ static inline atomic_t atomic_inc(volatile atomic_t* cur_value) {
   return new_value;
 #endif
 }
+
+/**
+  Memory ordering constraints on atomic operations, from weakest to strongest.
+  The values correspond to those of the C++11 std::memory_order.
+  The atomic_cas, atomic_dec, and atomic_inc functions above are always
+    MEMORY_ORDER_SEQ_CST.
+*/
+enum MemoryOrder {
+  MEMORY_ORDER_RELAXED = std::memory_order_relaxed,
+  MEMORY_ORDER_ACQUIRE = std::memory_order_acquire,
+  MEMORY_ORDER_RELEASE = std::memory_order_release,
+  MEMORY_ORDER_ACQ_REL = std::memory_order_acq_rel,
+  MEMORY_ORDER_SEQ_CST = std::memory_order_seq_cst
+};
+
+/**
+  Memory fence.
+  Orders the caller's surrounding loads and/or stores according to order.
+  @param order the ordering constraint to impose
+*/
+static inline void atomic_fence(MemoryOrder order) {
+  std::atomic_thread_fence(static_cast<std::memory_order>(order));
+}
+
+/**
+  Pair of atomic_t's that can be compared and swapped as a unit with
+    atomic_cas2 (cmpxchg16b on x86-64, cmpxchg8b on x86).
+*/
+struct alignas(2 * sizeof(atomic_t)) atomic2_t {
+  atomic_t lo, hi;
+};
+
+/**
+  Atomic double-width compare-and-swap.
+  If *cur_value == old_value, atomically set *cur_value = new_value,
+    otherwise return the conflicting *cur_value.
+  Always imposes a full memory barrier.
+  @param cur_value volatile pointer to a 2 * sizeof(atomic_t)-aligned
+    memory location
+  @param new_value the new value to swap in
+  @param old_value the old value to compare against before swapping in
+  @return *cur_value before the swap (== old_value on a successful swap)
+*/
+static inline atomic2_t
+atomic_cas2(
+  volatile atomic2_t* cur_value,
+  atomic2_t new_value,
+  atomic2_t old_value
+) {
+#if defined(_WIN64)
+  _InterlockedCompareExchange128(
+    reinterpret_cast<volatile __int64*>(cur_value),
+    new_value.hi,
+    new_value.lo,
+    reinterpret_cast<__int64*>(&old_value)
+  );
+  return old_value;
+#elif defined(_WIN32)
+  __int64 prev
+  = _InterlockedCompareExchange64(
+      reinterpret_cast<volatile __int64*>(cur_value),
+      *reinterpret_cast<__int64*>(&new_value),
+      *reinterpret_cast<__int64*>(&old_value)
+    );
+  return *reinterpret_cast<atomic2_t*>(&prev);
+#elif defined(__x86_64__)
+  asm volatile("lock\n"
+               "cmpxchg16b %0\n"
+               : "+m"(*cur_value), "+a"(old_value.lo), "+d"(old_value.hi)
+               : "b"(new_value.lo), "c"(new_value.hi)
+               : "cc", "memory"
+              );
+  return old_value;
+#elif defined(HAVE_GNUC_ATOMIC_BUILTINS)
+#if defined(__SIZEOF_INT128__)
+  typedef unsigned __int128 atomic2_word_t;
+#else
+  typedef uint64_t atomic2_word_t;
+#endif
+  atomic2_word_t prev
+  = __sync_val_compare_and_swap(
+      reinterpret_cast<volatile atomic2_word_t*>(cur_value),
+      *reinterpret_cast<atomic2_word_t*>(&old_value),
+      *reinterpret_cast<atomic2_word_t*>(&new_value)
+    );
+  return *reinterpret_cast<atomic2_t*>(&prev);
+#else
+#error atomic_cas2 is not implemented on this platform
+#endif
+}
+
+/**
+  A value of integral or pointer type that is read and modified atomically,
+    with explicit memory ordering constraints on every operation.
+  Unlike the atomic_* functions, which always impose a full barrier, callers
+    only pay for the ordering they ask for (e.g., MEMORY_ORDER_RELAXED
+    for statistics counters).
+*/
+template <class ValueType>
+class Atomic {
+public:
+  Atomic(ValueType value = ValueType())
+    : value(value)
+  { }
+
+public:
+  /**
+    If the stored value == expected, atomically set it to desired, otherwise
+      load the conflicting stored value into expected.
+    @param expected the value to compare against, updated on failure
+    @param desired the new value to store
+    @param order ordering constraint on a successful exchange; a failed
+      exchange is a load with the strongest compatible constraint
+    @return true if the exchange succeeded
+  */
+  bool
+  compare_exchange(
+    ValueType& expected,
+    ValueType desired,
+    MemoryOrder order = MEMORY_ORDER_SEQ_CST
+  ) {
+    return value.compare_exchange_strong(
+             expected,
+             desired,
+             static_cast<std::memory_order>(order),
+             get_failure_order(order)
+           );
+  }
+
+  /**
+    Atomically replace the stored value.
+    @param desired the new value to store
+    @param order ordering constraint
+    @return the stored value before the exchange
+  */
+  ValueType exchange(ValueType desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    return value.exchange(desired, static_cast<std::memory_order>(order));
+  }
+
+  /**
+    Atomically add to the stored value.
+    @param delta the value to add
+    @param order ordering constraint
+    @return the stored value before the addition
+  */
+  template <class DeltaType>
+  ValueType fetch_add(DeltaType delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    return value.fetch_add(delta, static_cast<std::memory_order>(order));
+  }
+
+  /**
+    Atomically subtract from the stored value.
+    @param delta the value to subtract
+    @param order ordering constraint
+    @return the stored value before the subtraction
+  */
+  template <class DeltaType>
+  ValueType fetch_sub(DeltaType delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    return value.fetch_sub(delta, static_cast<std::memory_order>(order));
+  }
+
+  /**
+    Atomically load the stored value.
+    @param order ordering constraint, one of RELAXED, ACQUIRE or SEQ_CST
+    @return the stored value
+  */
+  ValueType load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const {
+    return value.load(static_cast<std::memory_order>(order));
+  }
+
+  /**
+    Atomically store a new value.
+    @param desired the new value to store
+    @param order ordering constraint, one of RELAXED, RELEASE or SEQ_CST
+  */
+  void store(ValueType desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    value.store(desired, static_cast<std::memory_order>(order));
+  }
+
+private:
+  Atomic(const Atomic<ValueType>&);
+  Atomic<ValueType>& operator=(const Atomic<ValueType>&);
+
+  static std::memory_order get_failure_order(MemoryOrder order) {
+    switch (order) {
+    case MEMORY_ORDER_RELEASE:
+      return std::memory_order_relaxed;
+    case MEMORY_ORDER_ACQ_REL:
+      return std::memory_order_acquire;
+    default:
+      return static_cast<std::memory_order>(order);
+    }
+  }
+
+private:
+  std::atomic<ValueType> value;
+};
+
+/**
+  A pointer paired with a modification count (tag), the unit of
+    comparison in AtomicTaggedPointer.
+*/
+template <class PointeeType>
+struct TaggedPointer {
+  PointeeType* pointer;
+  atomic_t tag;
+};
+
+/**
+  A pointer with a modification count (tag) that is compared and swapped
+    together with the pointer in a single double-width CAS.
+  Incrementing the tag on every swap defeats the ABA problem in lock-free
+    structures without stealing bits from the pointer.
+*/
+template <class PointeeType>
+class AtomicTaggedPointer {
+public:
+  AtomicTaggedPointer(PointeeType* pointer = NULL, atomic_t tag = 0) {
+    value.lo = reinterpret_cast<atomic_t>(pointer);
+    value.hi = tag;
+  }
+
+public:
+  /**
+    If the stored pointer and tag == expected, atomically set them to desired,
+      otherwise load the conflicting stored pointer and tag into expected.
+    Always imposes a full memory barrier.
+    @param expected the pointer and tag to compare against, updated on failure
+    @param desired the new pointer and tag to store
+    @return true if the exchange succeeded
+  */
+  bool
+  compare_exchange(
+    TaggedPointer<PointeeType>& expected,
+    const TaggedPointer<PointeeType>& desired
+  ) {
+    atomic2_t old_value;
+    old_value.lo = reinterpret_cast<atomic_t>(expected.pointer);
+    old_value.hi = expected.tag;
+    atomic2_t new_value;
+    new_value.lo = reinterpret_cast<atomic_t>(desired.pointer);
+    new_value.hi = desired.tag;
+
+    atomic2_t prev = atomic_cas2(&value, new_value, old_value);
+    if (prev.lo == old_value.lo && prev.hi == old_value.hi) {
+      return true;
+    } else {
+      expected.pointer = reinterpret_cast<PointeeType*>(prev.lo);
+      expected.tag = prev.hi;
+      return false;
+    }
+  }
+
+  /**
+    Load the stored pointer and tag.
+    The two halves are loaded separately (tag first) with acquire semantics.
+      A torn result never matches the stored value, so it can at worst cause
+      a subsequent compare_exchange to fail and be retried.
+    @return the stored pointer and tag
+  */
+  TaggedPointer<PointeeType> load() const {
+    TaggedPointer<PointeeType> tagged_pointer;
+#ifdef _WIN32
+    tagged_pointer.tag = value.hi;
+    tagged_pointer.pointer = reinterpret_cast<PointeeType*>(value.lo);
+#else
+    tagged_pointer.tag = __atomic_load_n(&value.hi, __ATOMIC_ACQUIRE);
+    tagged_pointer.pointer
+    = reinterpret_cast<PointeeType*>(
+        __atomic_load_n(&value.lo, __ATOMIC_ACQUIRE)
+      );
+#endif
+    return tagged_pointer;
+  }
+
+private:
+  AtomicTaggedPointer(const AtomicTaggedPointer<PointeeType>&);
+  AtomicTaggedPointer<PointeeType>&
+  operator=(const AtomicTaggedPointer<PointeeType>&);
+
+private:
+  volatile atomic2_t value;
+};
 }
 
 #endif
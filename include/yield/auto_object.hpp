@@ -43,26 +43,30 @@ namespace yield {
 
  auto_Object is primarily intended for use in testing, where an object
    should be deleted when it goes out of scope because of an exception.
+
+ auto_Object can also be moved, which transfers the contained reference
+   without touching the Object's reference count. A moved-from auto_Object
+   is empty and may only be destroyed or assigned to.
 */
 template <class ObjectType = Object>
 class auto_Object {
 public:
   /**
-    Construct an auto_Object from an Object pointer.
+    Construct an auto_Object from an Object pointer, adopting the reference.
     Throws a std::exception if object is NULL.
   */
   auto_Object(YO_NEW_REF ObjectType* object) throw(std::exception)
-    : object(*object) {
+    : object(object) {
     if (object == NULL) {
       throw std::exception();
     }
   }
 
   /**
-    Construct an auto_Object from an Object reference.
+    Construct an auto_Object from an Object reference, adopting the reference.
   */
   auto_Object(YO_NEW_REF ObjectType& object)
-    : object(object)
+    : object(&object)
   { }
 
   /**
@@ -70,7 +74,25 @@ public:
       reference to the other auto_Object's contained Object.
   */
   auto_Object(const auto_Object<ObjectType>& other)
-    : object(Object::inc_ref(other.object))
+    : object(&Object::inc_ref(*other.object))
+  { }
+
+  /**
+    Construct an auto_Object by taking over the reference contained in
+      another auto_Object, leaving the other auto_Object empty.
+  */
+  auto_Object(auto_Object<ObjectType>&& other)
+    : object(other.object) {
+    other.object = NULL;
+  }
+
+  /**
+    Construct an auto_Object by taking over the reference contained in
+      an auto_Object of a derived type, leaving the other auto_Object empty.
+  */
+  template <class OtherObjectType>
+  auto_Object(auto_Object<OtherObjectType>&& other)
+    : object(other.release())
   { }
 
   /**
@@ -87,7 +109,7 @@ public:
     @return the contained Object reference
   */
   inline ObjectType& get() const {
-    return object;
+    return *object;
   }
 
   /**
@@ -106,6 +128,35 @@ public:
     return &get();
   }
 
+public:
+  /**
+    Replace the contained Object reference with the reference contained in
+      another auto_Object, leaving the other auto_Object empty.
+    @param other the auto_Object to take the reference from
+    @return *this
+  */
+  auto_Object<ObjectType>& operator=(auto_Object<ObjectType>&& other) {
+    if (this != &other) {
+      Object::dec_ref(object);
+      object = other.object;
+      other.object = NULL;
+    }
+    return *this;
+  }
+
+public:
+  /**
+    Give up the contained Object reference without decrementing it,
+      leaving this auto_Object empty.
+    @return the contained Object reference, which the caller now owns,
+      or NULL if this auto_Object was already empty (moved from)
+  */
+  YO_NEW_REF ObjectType* release() {
+    ObjectType* object = this->object;
+    this->object = NULL;
+    return object;
+  }
+
 public:
   /**
     Compare this auto_Object's Object reference (a pointer comparison) to another
@@ -114,7 +165,7 @@ public:
     @return true if the Object references are the same
   */
   inline bool operator==(const auto_Object<ObjectType>& other) const {
-    return &get() == &other.get();
+    return object == other.object;
   }
 
   /**
@@ -124,11 +175,14 @@ public:
     @ return false if the Object references are not the same
   */
   inline bool operator!=(const auto_Object<ObjectType>& other) const {
-    return &get() != &other.get();
+    return object != other.object;
   }
 
 private:
-  ObjectType& object;
+  auto_Object<ObjectType>& operator=(const auto_Object<ObjectType>&);
+
+private:
+  ObjectType* object;
 };
 }
 
@@ -51,6 +51,8 @@ public:
 public:
   /**
     Construct a buffer of capacity with the default alignment.
+    On a system with more than one NUMA node the data is allocated on the
+      node of the processor the caller is running on.
     @param capacity capacity of the new buffer
   */
   Buffer(size_t capacity);
@@ -467,6 +469,7 @@ private:
 private:
   static size_t pagesize;
   Buffer* next_buffer;
+  bool numa_local;
   size_t size_;
 };
 
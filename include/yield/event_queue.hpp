@@ -30,6 +30,8 @@
 #ifndef _YIELD_EVENT_QUEUE_HPP_
 #define _YIELD_EVENT_QUEUE_HPP_
 
+#include "yield/auto_object.hpp"
+#include "yield/event.hpp"
 #include "yield/event_handler.hpp"
 #include "yield/time.hpp"
 
@@ -66,6 +68,23 @@ public:
   */
   virtual bool enqueue(YO_NEW_REF Event& event) = 0;
 
+  /**
+    Enqueue the Event reference contained in an auto_Object.
+    The reference is moved into the queue if the enqueue succeeds and
+      left in event (to be decremented with it) if the enqueue fails.
+    @param event the Event reference to enqueue
+    @return true if the enqueue succeeded.
+  */
+  template <class EventType>
+  bool enqueue(auto_Object<EventType>&& event) {
+    if (enqueue(static_cast<Event&>(event.get()))) {
+      event.release();
+      return true;
+    } else {
+      return false;
+    }
+  }
+
   /**
     Timed dequeue.
     Blocks for the specified timeout or until an Event is available.
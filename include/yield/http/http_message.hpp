@@ -30,6 +30,7 @@
 #ifndef _YIELD_HTTP_HTTP_MESSAGE_HPP_
 #define _YIELD_HTTP_HTTP_MESSAGE_HPP_
 
+#include "yield/auto_object.hpp"
 #include "yield/event.hpp"
 
 #include <utility> // for std::pair
@@ -153,7 +154,7 @@ public:
       (request or response line, fields).
   */
   Buffer& get_header() const {
-    return header;
+    return *header;
   }
 
 public:
@@ -197,6 +198,32 @@ public:
     return get_field(name);
   }
 
+public:
+  /**
+    Move the body reference out of this HTTP message, leaving it
+      without a body.
+    @return the body of this HTTP message, which the caller now owns,
+      or NULL if no body is present
+  */
+  YO_NEW_REF Object* release_body() {
+    Object* body = this->body;
+    this->body = NULL;
+    return body;
+  }
+
+  /**
+    Move the header buffer reference out of this HTTP message.
+    Afterwards the message may only be decremented, so this is for the
+      holder of its only reference (see Object::has_single_reference),
+      e.g. to send a response's header without an inc_ref/dec_ref pair.
+    @return the header buffer, which the caller now owns
+  */
+  YO_NEW_REF Buffer& release_header() {
+    Buffer& header = *this->header;
+    this->header = NULL;
+    return header;
+  }
+
 public:
   /**
     Set the body of an HTTP message.
@@ -204,6 +231,16 @@ public:
   */
   void set_body(YO_NEW_REF Object* body);
 
+  /**
+    Set the body of an HTTP message.
+    Moves the reference out of body and decrements the existing body,
+      if present.
+  */
+  template <class BodyType>
+  void set_body(auto_Object<BodyType>&& body) {
+    set_body(static_cast<Object*>(body.release()));
+  }
+
 public:
   /**
     Set a string field (set_field(..., const char* value) form).
@@ -456,7 +493,7 @@ protected:
 private:
   Object* body;
   uint16_t fields_offset;
-  Buffer& header;
+  Buffer* header;
   uint8_t http_version;
 };
 }
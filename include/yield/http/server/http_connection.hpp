@@ -31,6 +31,7 @@
 #define _YIELD_HTTP_SERVER_HTTP_CONNECTION_HPP_
 
 #include "yield/event_queue.hpp"
+#include "yield/numa_allocator.hpp"
 #include "yield/sockets/aio/accept_aiocb.hpp"
 #include "yield/sockets/aio/recv_aiocb.hpp"
 #include "yield/sockets/aio/send_aiocb.hpp"
@@ -52,6 +53,53 @@ class HTTPConnection : public Object {
 public:
   enum State { STATE_CONNECTED, STATE_ERROR };
 
+  /**
+    An Event carrying a response to a request from another thread to the
+      thread driving a connection's AIO queue, which sends it.
+  */
+  class RespondEvent : public Event {
+  public:
+    const static uint32_t TYPE_ID = 1353270418UL;
+
+  public:
+    RespondEvent(
+      HTTPConnection& connection,
+      uint32_t request_sequence_number,
+      YO_NEW_REF ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk
+    );
+
+    RespondEvent(
+      HTTPConnection& connection,
+      uint32_t request_sequence_number,
+      YO_NEW_REF ::yield::http::HTTPResponse& http_response
+    );
+
+    ~RespondEvent();
+
+  public:
+    HTTPConnection& get_connection() const {
+      return connection;
+    }
+
+  public:
+    // yield::Object
+    uint32_t get_type_id() const {
+      return TYPE_ID;
+    }
+
+    const char* get_type_name() const {
+      return "yield::http::server::HTTPConnection::RespondEvent";
+    }
+
+  private:
+    friend class HTTPConnection;
+
+    HTTPConnection& connection;
+    ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk;
+    ::yield::http::HTTPResponse* http_response;
+    uint32_t request_sequence_number;
+  };
+
 public:
   HTTPConnection(
     EventQueue& aio_queue,
@@ -76,10 +124,38 @@ public:
     return socket_;
   }
 
+  /**
+    Get the time of the connection's last accept, receive, send or
+      response, according to Time::coarse_monotonic_now().
+    @return the time of the connection's last activity
+  */
+  const Time& get_last_activity_time() const {
+    return last_activity_time;
+  }
+
+  /**
+    Get the capacity of the connection's next receive buffer, which adapts
+      to how much the peer sends at once.
+    @return the capacity of the next receive buffer
+  */
+  size_t get_recv_buffer_capacity() const {
+    return recv_buffer_capacity;
+  }
+
   State get_state() const {
     return state;
   }
 
+  /**
+    Check whether any request parsed on the connection is still waiting for
+      its response to be sent in full, for instance while a worker handles
+      it.
+    @return true if a response is outstanding
+  */
+  bool has_outstanding_responses() const {
+    return response_sequence_number != next_request_sequence_number;
+  }
+
 public:
   void handle(YO_NEW_REF ::yield::sockets::aio::acceptAIOCB& accept_aiocb);
   void handle(YO_NEW_REF ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk);
@@ -87,6 +163,46 @@ public:
   void handle(YO_NEW_REF ::yield::sockets::aio::recvAIOCB& recv_aiocb);
   void handle(YO_NEW_REF ::yield::sockets::aio::sendAIOCB& send_aiocb);
   void handle(YO_NEW_REF ::yield::sockets::aio::sendfileAIOCB& sendfile_aiocb);
+  void handle(YO_NEW_REF RespondEvent& respond_event);
+
+public:
+  /**
+    Send a response body chunk to a request received on this connection.
+    May be called from any thread. Calls from a thread other than the one
+      driving the connection's AIO queue are marshalled to that thread
+      through the queue, so a connection's responses are serialized without
+      locking. Responses to pipelined requests are sent in request order:
+      a response that reaches that thread before the responses to earlier
+      requests have been sent in full is held until they have.
+    @param http_request request being responded to
+    @param http_message_body_chunk response body chunk
+  */
+  void
+  respond(
+    const HTTPRequest& http_request,
+    YO_NEW_REF ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk
+  );
+
+  /**
+    Send a response to a request received on this connection.
+    May be called from any thread; see respond(const HTTPRequest&,
+      HTTPMessageBodyChunk&).
+    @param http_request request being responded to
+    @param http_response response
+  */
+  void
+  respond(
+    const HTTPRequest& http_request,
+    YO_NEW_REF ::yield::http::HTTPResponse& http_response
+  );
+
+  /**
+    Record the AIO queue driven by the calling thread, so that respond
+      calls from that thread on connections using the queue are sent
+      directly instead of being marshalled.
+    @param aio_queue the AIO queue driven by the calling thread
+  */
+  static void set_current_aio_queue(EventQueue& aio_queue);
 
 public:
   // yield::Object
@@ -98,14 +214,66 @@ public:
     return Object::inc_ref(*this);
   }
 
+public:
+  // Keep connections on the NUMA node of the thread that accepts them.
+  static void* operator new(size_t size) {
+    return NUMAAllocator::allocate(size);
+  }
+
+  static void operator delete(void* ptr) {
+    NUMAAllocator::deallocate(ptr);
+  }
+
 private:
+  template <class> friend class HTTPRequestQueue;
+
+private:
+  // A response or response body chunk to a pipelined request, held on the
+  // connection's thread until the responses to earlier requests are sent.
+  struct HeldResponse {
+    uint32_t request_sequence_number;
+    ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk;
+    ::yield::http::HTTPResponse* http_response;
+  };
+
+private:
+  void adapt_recv_buffer_capacity(const Buffer& recv_buffer);
   void parse(Buffer& recv_buffer);
+  void recv();
+  void marshal(YO_NEW_REF RespondEvent& respond_event);
+
+  void
+  send(
+    uint32_t request_sequence_number,
+    YO_NEW_REF ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk,
+    YO_NEW_REF ::yield::http::HTTPResponse* http_response
+  );
+
+  bool
+  send(
+    YO_NEW_REF ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk,
+    YO_NEW_REF ::yield::http::HTTPResponse* http_response
+  );
 
 private:
   EventQueue& aio_queue;
   EventHandler& http_request_handler;
+  Time last_activity_time;
+  // Responses that arrived before the one being sent, in arrival order.
+  vector<HeldResponse> held_responses;
   Log* log;
+  // Sequence number of the next request parsed on the connection.
+  uint32_t next_request_sequence_number;
+  // Intrusive links in the owning HTTPRequestQueue's list of connections.
+  HTTPConnection* next_connection;
   yield::sockets::SocketAddress& peername;
+  HTTPConnection* prev_connection;
+  // Capacity of the next lazily-allocated recv buffer.
+  size_t recv_buffer_capacity;
+  // Whether the outstanding recvAIOCB allocates its own buffer.
+  bool recv_buffer_lazy;
+  // Sequence number of the request whose response is being sent.
+  uint32_t response_sequence_number;
   yield::sockets::TCPSocket& socket_;
   State state;
 };
@@ -100,11 +100,21 @@ public:
   /**
     Respond to the HTTP request.
     Steals the reference to http_response, which should not be modified
-      after this method is called.
+      after this method is called. If it's the response's only reference,
+      the connection moves the header and body out of the response rather
+      than taking references to them.
     @param http_response HTTP response
   */
   void respond(YO_NEW_REF ::yield::http::HTTPResponse& http_response);
 
+  /**
+    Respond to the HTTP request.
+    Moves the reference out of http_response, which should not be modified
+      after this method is called, as with respond(HTTPResponse&).
+    @param http_response HTTP response
+  */
+  void respond(auto_Object< ::yield::http::HTTPResponse >&& http_response);
+
   /**
     Respond to the HTTP request.
     @param status_code response status code e.g, 200
@@ -127,6 +137,14 @@ public:
   */
   void respond(uint16_t status_code, YO_NEW_REF Buffer& body);
 
+  /**
+    Respond to the HTTP request.
+    This method should only be called once.
+    @param status_code response status code e.g., 200
+    @param body response body, whose reference is moved into the response
+  */
+  void respond(uint16_t status_code, auto_Object<Buffer>&& body);
+
   /**
     Respond to the HTTP request.
     This method should only be called once.
@@ -187,8 +205,12 @@ protected:
   );
 
 private:
+  friend class HTTPConnection;
+
   HTTPConnection& connection;
   DateTime creation_date_time;
+  // Position of the request among those parsed on its connection.
+  uint32_t sequence_number;
 };
 }
 }
@@ -66,10 +66,14 @@ public:
       socket address.
     @param sockname address to listen to
     @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, greater than zero, or Time::FOREVER to keep idle connections
+      open
   */
   HTTPRequestQueue(
     const yield::sockets::SocketAddress& sockname,
-    YO_NEW_REF Log* log = NULL
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
   ) throw(Exception);
 
   /**
@@ -78,11 +82,15 @@ public:
     @param socket_ server socket to use
     @param sockname address to bind and listen to
     @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, greater than zero, or Time::FOREVER to keep idle connections
+      open
   */
   HTTPRequestQueue(
     YO_NEW_REF yield::sockets::TCPSocket& socket_,
     const yield::sockets::SocketAddress& sockname,
-    YO_NEW_REF Log* log = NULL
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
   ) throw(Exception);
 
   ~HTTPRequestQueue();
@@ -98,12 +106,23 @@ public:
 
 private:
   void handle(YO_NEW_REF yield::sockets::aio::acceptAIOCB& accept_aiocb);
-  template <class AIOCBType> void handle(YO_NEW_REF AIOCBType& aiocb);
+
+  template <class EventType>
+  void handle(YO_NEW_REF EventType& event, HTTPConnection& connection);
+
   void init(const yield::sockets::SocketAddress& sockname) throw(Exception);
+  void link(HTTPConnection& connection);
+  Time reap_idle_connections();
+  void touch(HTTPConnection& connection);
+  void unlink(HTTPConnection& connection);
 
 private:
   AIOQueueType& aio_queue;
-  vector<HTTPConnection*> connections;
+  // Connections in order of last activity, least recent first, so that
+  // touching, removing and finding idle connections are all O(1).
+  HTTPConnection* connections_head;
+  HTTPConnection* connections_tail;
+  Time idle_timeout;
   Log* log;
   yield::sockets::TCPSocket& socket_;
 };
@@ -30,6 +30,7 @@
 #ifndef _YIELD_HTTP_SERVER_HTTP_SERVER_HPP_
 #define _YIELD_HTTP_SERVER_HTTP_SERVER_HPP_
 
+#include "yield/stage/seda_stage_scheduler.hpp"
 #include "yield/stage/stage.hpp"
 #include "yield/http/server/http_request_queue.hpp"
 
@@ -41,7 +42,7 @@ namespace server {
   HTTPServer is an "active" counterpart to HTTPRequestQueue: rather than relying
     on a caller to drive it continuously, it continously polls an underlying
     HTTPRequestQueue and dispatches HTTPRequests and associated Events to
-    an EventHandler.
+    an EventHandler, either on its own thread or on a pool of worker threads.
 */
 template <class AIOQueueType = yield::sockets::aio::AIOQueue>
 class HTTPServer : public yield::stage::Stage {
@@ -54,15 +55,128 @@ public:
       originating from the server
     @param sockname address to listen to
     @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, or Time::FOREVER to keep idle connections open
   */
   HTTPServer(
     YO_NEW_REF EventHandler& http_request_handler,
     const yield::sockets::SocketAddress& sockname,
-    YO_NEW_REF Log* log = NULL
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
   )
     : yield::stage::Stage(
       http_request_handler,
-      *new HTTPRequestQueue<AIOQueueType>(sockname, log)
+      *new HTTPRequestQueue<AIOQueueType>(sockname, log, idle_timeout)
+    ) {
+  }
+
+  /**
+    Construct an HTTPServer around an extant TCP socket, which will then be
+      bound and listen to the given socket address, and dispatch
+      HTTPRequests and related Events originating from the server to the
+      given handler.
+    @param http_request_handler handler for HTTPRequests and related Events
+      originating from the server
+    @param socket_ server socket to use
+    @param sockname address to bind and listen to
+    @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, or Time::FOREVER to keep idle connections open
+  */
+  HTTPServer(
+    YO_NEW_REF EventHandler& http_request_handler,
+    YO_NEW_REF yield::sockets::TCPSocket& socket_,
+    const yield::sockets::SocketAddress& sockname,
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
+  )
+    : yield::stage::Stage(
+      http_request_handler,
+      *new HTTPRequestQueue<AIOQueueType>(
+        socket_,
+        sockname,
+        log,
+        idle_timeout
+      )
+    ) {
+  }
+
+  /**
+    Construct an HTTPServer that will listen to the given socket address and
+      dispatch HTTPRequests and related Events originating from the server
+      to the given handler on a pool of worker threads, leaving the thread
+      driving the server to network I/O.
+    The handler may respond to HTTPRequests from the workers: responses are
+      marshalled back to the server's thread through its queue and sent
+      there. Pipelined requests on a connection may be handled concurrently,
+      but their responses are sent in request order.
+    @param http_request_handler handler for HTTPRequests and related Events
+      originating from the server, which is called from every worker
+      concurrently
+    @param sockname address to listen to
+    @param worker_concurrency_level number of worker threads
+    @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, or Time::FOREVER to keep idle connections open
+  */
+  HTTPServer(
+    YO_NEW_REF EventHandler& http_request_handler,
+    const yield::sockets::SocketAddress& sockname,
+    yield::stage::StageScheduler::ConcurrencyLevel worker_concurrency_level,
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
+  )
+    : HTTPServer(
+      *new HTTPRequestQueue<AIOQueueType>(sockname, log, idle_timeout),
+      http_request_handler,
+      worker_concurrency_level
+    ) {
+  }
+
+private:
+  // Hands Events to a Stage serviced by its own threads.
+  class WorkerPool : public EventHandler {
+  public:
+    WorkerPool(
+      YO_NEW_REF EventHandler& http_request_handler,
+      yield::stage::StageScheduler::ConcurrencyLevel worker_concurrency_level
+    ) : stage(*new yield::stage::Stage(http_request_handler)),
+      stage_scheduler(*new yield::stage::SEDAStageScheduler) {
+      stage_scheduler.schedule(stage, worker_concurrency_level);
+    }
+
+    ~WorkerPool() {
+      // Joins the workers.
+      yield::stage::StageScheduler::dec_ref(stage_scheduler);
+      yield::stage::Stage::dec_ref(stage);
+    }
+
+    // yield::EventHandler
+    void handle(YO_NEW_REF Event& event) {
+      if (event.get_type_id() == yield::stage::Stage::ShutdownEvent::TYPE_ID) {
+        // The workers get their own from stage_scheduler.
+        Event::dec_ref(event);
+      } else {
+        stage.handle(event);
+      }
+    }
+
+  private:
+    yield::stage::Stage& stage;
+    yield::stage::StageScheduler& stage_scheduler;
+  };
+
+private:
+  // Constructs the queue before starting the workers, which would leak
+  //   if the queue's constructor threw.
+  HTTPServer(
+    YO_NEW_REF HTTPRequestQueue<AIOQueueType>& http_request_queue,
+    YO_NEW_REF EventHandler& http_request_handler,
+    yield::stage::StageScheduler::ConcurrencyLevel worker_concurrency_level
+  )
+    : yield::stage::Stage(
+      *new WorkerPool(http_request_handler, worker_concurrency_level),
+      http_request_queue
     ) {
   }
 };
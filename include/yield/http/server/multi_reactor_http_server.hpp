@@ -0,0 +1,202 @@
+// yield/http/server/multi_reactor_http_server.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_HTTP_SERVER_MULTI_REACTOR_HTTP_SERVER_HPP_
+#define _YIELD_HTTP_SERVER_MULTI_REACTOR_HTTP_SERVER_HPP_
+
+#include "yield/log.hpp"
+#include "yield/http/server/http_server.hpp"
+#include "yield/sockets/tcp_socket.hpp"
+#include "yield/stage/seda_stage_scheduler.hpp"
+
+namespace yield {
+namespace http {
+namespace server {
+/**
+  An HTTP server made of several HTTPServers ("reactors") listening to the
+    same socket address, each with its own SO_REUSEPORT listen socket, AIO
+    queue and connections, and each driven by its own thread on its own
+    physical core.
+  The kernel spreads incoming connections across the listen sockets, and a
+    connection is serviced by the reactor that accepted it for its lifetime,
+    so reactors share no I/O state.
+  Requires Socket::Option::REUSEPORT.
+*/
+template <class AIOQueueType = yield::sockets::aio::AIOQueue>
+class MultiReactorHTTPServer : public Object {
+public:
+  /**
+    Construct a MultiReactorHTTPServer whose reactors all dispatch
+      HTTPRequests and related Events to the same handler.
+    Throws Exception if a reactor cannot listen on sockname.
+    @param http_request_handler handler for HTTPRequests and related Events,
+      which is called from every reactor's thread concurrently
+    @param sockname address to listen to
+    @param reactor_count number of reactors, by default one per physical core
+    @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, or Time::FOREVER to keep idle connections open
+  */
+  MultiReactorHTTPServer(
+    YO_NEW_REF EventHandler& http_request_handler,
+    const yield::sockets::SocketAddress& sockname,
+    uint16_t reactor_count
+    = yield::stage::StageScheduler::ConcurrencyLevel::PER_PROCESSOR,
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
+  ) {
+    vector<EventHandler*> http_request_handlers;
+    do {
+      http_request_handlers.push_back(&http_request_handler.inc_ref());
+    } while (http_request_handlers.size() < reactor_count);
+    EventHandler::dec_ref(http_request_handler);
+
+    init(http_request_handlers, sockname, log, idle_timeout);
+  }
+
+  /**
+    Construct a MultiReactorHTTPServer with one reactor per handler, each
+      reactor dispatching HTTPRequests and related Events to its own
+      handler.
+    Throws Exception if a reactor cannot listen on sockname.
+    @param http_request_handlers handlers for HTTPRequests and related
+      Events, one new reference per reactor
+    @param sockname address to listen to
+    @param log optional debug and error log
+    @param idle_timeout time after which a connection with no activity is
+      closed, or Time::FOREVER to keep idle connections open
+  */
+  MultiReactorHTTPServer(
+    const vector<EventHandler*>& http_request_handlers,
+    const yield::sockets::SocketAddress& sockname,
+    YO_NEW_REF Log* log = NULL,
+    const Time& idle_timeout = Time::FOREVER
+  ) {
+    init(http_request_handlers, sockname, log, idle_timeout);
+  }
+
+  /**
+    Stop the reactors' threads and destroy the reactors, closing their
+      listen sockets and connections.
+  */
+  ~MultiReactorHTTPServer() {
+    // Joins the reactors' threads.
+    yield::stage::StageScheduler::dec_ref(*stage_scheduler);
+    fini();
+  }
+
+public:
+  /**
+    Get the number of reactors.
+    @return the number of reactors
+  */
+  size_t get_reactor_count() const {
+    return reactors.size();
+  }
+
+public:
+  // yield::Object
+  const char* get_type_name() const {
+    return "yield::http::server::MultiReactorHTTPServer";
+  }
+
+private:
+  void fini() {
+    for (
+      typename vector<HTTPServer<AIOQueueType>*>::iterator
+      reactor_i = reactors.begin();
+      reactor_i != reactors.end();
+      ++reactor_i
+    ) {
+      HTTPServer<AIOQueueType>::dec_ref(**reactor_i);
+    }
+  }
+
+  void
+  init(
+    const vector<EventHandler*>& http_request_handlers,
+    const yield::sockets::SocketAddress& sockname,
+    YO_NEW_REF Log* log,
+    const Time& idle_timeout
+  ) {
+    using yield::sockets::Socket;
+    using yield::sockets::TCPSocket;
+    using yield::stage::SEDAStageScheduler;
+    using yield::stage::StageScheduler;
+
+    size_t handler_i = 0;
+    try {
+      for (; handler_i < http_request_handlers.size(); ++handler_i) {
+        TCPSocket* socket_ = new TCPSocket(sockname.get_family());
+        if (!socket_->setsockopt(Socket::Option::REUSEPORT, true)) {
+          TCPSocket::dec_ref(*socket_);
+          throw Exception();
+        }
+
+        reactors.push_back(
+          new HTTPServer<AIOQueueType>(
+            *http_request_handlers[handler_i],
+            *socket_,
+            sockname,
+            Object::inc_ref(log),
+            idle_timeout
+          )
+        );
+      }
+    } catch (Exception&) {
+      for (; handler_i < http_request_handlers.size(); ++handler_i) {
+        EventHandler::dec_ref(*http_request_handlers[handler_i]);
+      }
+      fini();
+      Log::dec_ref(log);
+      throw;
+    }
+
+    Log::dec_ref(log);
+
+    stage_scheduler = new SEDAStageScheduler;
+    for (size_t reactor_i = 0; reactor_i < reactors.size(); ++reactor_i) {
+      stage_scheduler->schedule(
+        *reactors[reactor_i],
+        1,
+        StageScheduler::Placement::SPREAD
+      );
+    }
+  }
+
+private:
+  vector<HTTPServer<AIOQueueType>*> reactors;
+  yield::stage::StageScheduler* stage_scheduler;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,117 @@
+// yield/numa_allocator.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_NUMA_ALLOCATOR_HPP_
+#define _YIELD_NUMA_ALLOCATOR_HPP_
+
+#include "yield/types.hpp"
+
+#include <new>
+
+namespace yield {
+/**
+  Allocator of memory on a particular NUMA node, by default the node of the
+    processor the caller is running on.
+  Each NUMA node has an arena of chunks bound to the node with mbind, carved
+    into power-of-two size classes whose blocks are aligned to their size,
+    so an aligned allocation takes no more than its size class. Each thread
+    caches freed blocks in front of the arena. Large allocations are mapped
+    and bound individually. On systems with a single NUMA node (and on
+    platforms other than Linux) allocations come from the ordinary heap.
+  Memory from allocate must be returned with deallocate, from any thread.
+*/
+class NUMAAllocator {
+public:
+  /**
+    Default alignment of allocations.
+  */
+  const static size_t ALIGNMENT_DEFAULT = 16;
+
+  /**
+    Pseudo node id for the node of the processor the caller is running on.
+  */
+  const static int16_t NUMA_NODE_LOCAL = -1;
+
+public:
+  /**
+    Allocate memory on a NUMA node.
+    Throws std::bad_alloc on failure.
+    @param size size of the allocation in bytes
+    @param alignment alignment boundary of the allocation, a power of two
+    @param numa_node_id node to allocate on, or NUMA_NODE_LOCAL
+    @return the allocated memory
+  */
+  static void*
+  allocate(
+    size_t size,
+    size_t alignment = ALIGNMENT_DEFAULT,
+    int16_t numa_node_id = NUMA_NODE_LOCAL
+  );
+
+  /**
+    Free memory returned by allocate.
+    @param ptr memory returned by allocate, or NULL
+  */
+  static void deallocate(void* ptr);
+
+public:
+  /**
+    Get the id of the NUMA node of the processor the caller is running on.
+    @return the id of the caller's NUMA node, or 0 if it is unknown
+  */
+  static uint16_t get_current_numa_node_id();
+
+  /**
+    Get the NUMA node a block returned by allocate was allocated on.
+    @param ptr memory returned by allocate
+    @return the id of the block's NUMA node, or NUMA_NODE_LOCAL if the
+      block came from the ordinary heap
+  */
+  static int16_t get_numa_node_id(const void* ptr);
+
+  /**
+    Query the system for the number of NUMA nodes with memory online.
+    @return the number of online NUMA nodes, at least 1
+  */
+  static uint16_t get_numa_node_count();
+
+public:
+  /**
+    Make the caller's thread prefer a NUMA node for all of its future page
+      allocations (set_mempolicy(MPOL_PREFERRED)), including those made by
+      malloc and new.
+    @param numa_node_id node to prefer, or NUMA_NODE_LOCAL to restore the
+      default (local) policy
+    @return true if the policy was set
+  */
+  static bool set_preferred_numa_node(int16_t numa_node_id);
+};
+}
+
+#endif
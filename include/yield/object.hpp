@@ -76,10 +76,21 @@ public:
   /**
     Atomically decrement the reference count of an Object, deleting the
     Object when the count reaches zero.
+    Thread-confined Objects (see set_thread_confined) are decremented
+      without an atomic read-modify-write.
     @param object the object whose reference count should be decremented.
   */
   static inline void dec_ref(Object& object) {
-    if (atomic_dec(&object.refcnt) == 0) {
+    if (object.thread_confined) {
+      uint32_t refcnt = object.refcnt.load(MEMORY_ORDER_RELAXED);
+      if (refcnt == 1) {
+        delete &object;
+      } else {
+        object.refcnt.store(refcnt - 1, MEMORY_ORDER_RELAXED);
+      }
+    } else if (object.refcnt.fetch_sub(1, MEMORY_ORDER_RELEASE) == 1) {
+      // Order the deletion after every other holder's release.
+      atomic_fence(MEMORY_ORDER_ACQUIRE);
       delete &object;
     }
   }
@@ -121,7 +132,16 @@ public:
   */
   template <class ObjectType>
   static inline ObjectType& inc_ref(ObjectType& object) {
-    atomic_inc(&object.refcnt);
+    if (object.thread_confined) {
+      object.refcnt.store(
+        object.refcnt.load(MEMORY_ORDER_RELAXED) + 1,
+        MEMORY_ORDER_RELAXED
+      );
+    } else {
+      // A new reference can only be created from an existing one, so the
+      // increment needs no ordering of its own.
+      object.refcnt.fetch_add(1, MEMORY_ORDER_RELAXED);
+    }
     return object;
   }
 
@@ -149,12 +169,47 @@ public:
     return *this;
   }
 
+public:
+  /**
+    Check whether the caller's reference to this Object is its only one,
+      in which case the caller may move state out of the Object.
+    @return true if the reference count is 1
+  */
+  bool has_single_reference() const {
+    // Acquire any other holder's writes along with its release.
+    return refcnt.load(MEMORY_ORDER_ACQUIRE) == 1;
+  }
+
+  /**
+    Check whether this Object's reference count is thread-confined.
+    @return true if the reference count is thread-confined
+  */
+  bool is_thread_confined() const {
+    return thread_confined;
+  }
+
+  /**
+    Switch this Object's reference count between atomic and thread-confined
+      (non-atomic) updates.
+    A thread-confined Object may be handed off between threads through a
+      synchronized queue, but references to it must never be held by
+      two threads at the same time.
+    Must only be called by the holder of the Object's only reference.
+    @param thread_confined true to make the reference count thread-confined,
+      false to make it atomic again
+  */
+  void set_thread_confined(bool thread_confined) {
+    this->thread_confined = thread_confined;
+  }
+
 protected:
-  Object() : refcnt(1) { }
+  Object() : refcnt(1), thread_confined(false) { }
   virtual ~Object() { }
 
 private:
-  volatile atomic_t refcnt;
+  // 32 bits of count and the flag fit beside the vptr on 64-bit platforms.
+  Atomic<uint32_t> refcnt;
+  bool thread_confined;
 };
 
 
@@ -43,6 +43,13 @@ public:
   const static uint32_t TYPE_ID = 117149474;
 
 public:
+  /**
+    Bitmask of file descriptor events.
+    A single FDEvent may carry several of the TYPE_* bits at once, e.g.
+      TYPE_READ_READY | TYPE_WRITE_READY for a socket that is both readable
+      and writable, or TYPE_READ_READY | TYPE_HUP for a peer that wrote and
+      then hung up. Test for an event with (get_type() & TYPE_*) != 0.
+  */
   typedef uint16_t Type;
   const static Type TYPE_ERROR;
   const static Type TYPE_HUP;
@@ -52,6 +59,8 @@ public:
 public:
   /**
     Construct an FDEvent from a file descriptor and a Type.
+    @param fd the file descriptor the events occurred on
+    @param type a non-zero bitmask of the events that occurred
   */
   FDEvent(fd_t fd, Type type);
 
@@ -65,8 +74,8 @@ public:
   }
 
   /**
-    Get the Type of this FDEvent.
-    @return the Type of this FDEvent
+    Get the Type bitmask of this FDEvent.
+    @return the Type bitmask of this FDEvent
   */
   Type get_type() const {
     return type;
@@ -33,6 +33,7 @@
 #include "yield/exception.hpp"
 #include "yield/event_queue.hpp"
 #include "yield/poll/fd_event.hpp"
+#include "yield/timer_wheel.hpp"
 #include "yield/queue/blocking_concurrent_queue.hpp"
 
 #ifndef _WIN32
@@ -76,13 +77,40 @@ public:
   */
   bool dissociate(fd_t fd);
 
+public:
+  /**
+    Arm a TimerEvent, which timeddequeue will return once its timeout
+      has elapsed. The poll timeout is shortened to the next timer expiry,
+      so timers need no thread of their own.
+    Re-arming an armed TimerEvent moves it to its new deadline.
+    Unlike enqueue, must only be called from the thread that dequeues.
+    @param timer_event the TimerEvent to arm
+  */
+  void arm_timer(YO_NEW_REF TimerEvent& timer_event) {
+    timer_wheel.arm(timer_event);
+  }
+
+  /**
+    Cancel a TimerEvent armed with arm_timer.
+    Must only be called from the thread that dequeues.
+    @param timer_event the TimerEvent to cancel
+    @return true if the TimerEvent was armed
+  */
+  bool cancel_timer(TimerEvent& timer_event) {
+    return timer_wheel.cancel(timer_event);
+  }
+
 public:
   // yield::EventQueue
   bool enqueue(YO_NEW_REF Event& event);
   YO_NEW_REF Event* timeddequeue(const Time& timeout);
 
+private:
+  YO_NEW_REF Event* dequeue_fd_event(const Time& timeout);
+
 private:
   ::yield::queue::BlockingConcurrentQueue<Event> event_queue;
+  TimerWheel timer_wheel;
 #if defined(__linux__)
   int epfd, wake_fd;
 #elif defined(__MACH__) || defined(__FreeBSD__)
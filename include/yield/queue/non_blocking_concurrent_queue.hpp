@@ -30,7 +30,6 @@
 #ifndef _YIELD_QUEUE_NON_BLOCKING_CONCURRENT_QUEUE_HPP_
 #define _YIELD_QUEUE_NON_BLOCKING_CONCURRENT_QUEUE_HPP_
 
-#include "yield/debug.hpp"
 #include "yield/atomic.hpp"
 
 namespace yield {
@@ -41,20 +40,17 @@ namespace queue {
 
   Adapted from Michael, M. M. and Scott, M. L. 1996. Simple, fast, and practical
     non-blocking and blocking concurrent queue algorithms.
+
+  Each slot is an AtomicTaggedPointer whose tag is incremented on every
+    enqueue and dequeue, which protects the slots from ABA without any
+    restrictions on the element pointers.
 */
 template <class ElementType, size_t Length>
 class NonBlockingConcurrentQueue {
 public:
-  NonBlockingConcurrentQueue() {
-    debug_assert_eq(sizeof(ElementType*), sizeof(atomic_t));
-
-    elements[0] = 1; // Sentinel element
-    for (size_t element_i = 1; element_i < Length + 2; element_i++) {
-      elements[element_i] = 0;
-    }
-
-    head_element_i = 0;
-    tail_element_i = 1;
+  NonBlockingConcurrentQueue()
+    : head_element_i(0), tail_element_i(1) {
+    // All slots, including the sentinel elements[0], start out empty.
   }
 
   /**
@@ -63,65 +59,64 @@ public:
     @return true if the enqueue was successful, false if the queue was full
   */
   bool enqueue(ElementType& element) {
-    atomic_t new_element = reinterpret_cast<atomic_t>(&element);
-    debug_assert_false(new_element & 1);
-    new_element >>= 1;
-    debug_assert_false(new_element & POINTER_HIGH_BIT);
-
     for (;;) {
-      atomic_t tail_element_i_copy = tail_element_i; // te
+      atomic_t tail_element_i_copy
+      = tail_element_i.load(MEMORY_ORDER_ACQUIRE); // te
       atomic_t last_try_element_i = tail_element_i_copy; // ate
-      atomic_t try_element = elements[last_try_element_i];
+      Element try_element = elements[last_try_element_i].load();
       atomic_t try_element_i
       = (last_try_element_i + 1) % (Length + 2);     // temp
 
-      while (try_element != 0 && try_element != 1) {
-        if (tail_element_i_copy != tail_element_i) {
+      while (try_element.pointer != NULL) {
+        if (tail_element_i_copy != tail_element_i.load(MEMORY_ORDER_ACQUIRE)) {
           break;
         }
-        if (try_element_i == head_element_i) {
+        if (try_element_i == head_element_i.load(MEMORY_ORDER_ACQUIRE)) {
           break;
         }
-        try_element = elements[try_element_i];
+        try_element = elements[try_element_i].load();
         last_try_element_i = try_element_i;
         try_element_i = (try_element_i + 1) % (Length + 2);
       }
 
-      if (tail_element_i_copy != tail_element_i) {
+      if (tail_element_i_copy != tail_element_i.load(MEMORY_ORDER_ACQUIRE)) {
         continue;
       }
 
-      if (try_element_i == head_element_i) {
+      if (try_element_i == head_element_i.load(MEMORY_ORDER_ACQUIRE)) {
         last_try_element_i = try_element_i;
         try_element_i = (try_element_i + 1) % (Length + 2);
-        try_element = elements[try_element_i];
+        try_element = elements[try_element_i].load();
 
-        if (try_element != 0 && try_element != 1) {
+        if (try_element.pointer != NULL) {
           return false;  // Queue is full
         }
 
-        atomic_cas(&head_element_i, try_element_i, last_try_element_i);
+        head_element_i.compare_exchange(
+          last_try_element_i,
+          try_element_i,
+          MEMORY_ORDER_ACQ_REL
+        );
 
         continue;
       }
 
-      if (tail_element_i_copy != tail_element_i) {
+      if (tail_element_i_copy != tail_element_i.load(MEMORY_ORDER_ACQUIRE)) {
         continue;
       }
 
+      Element new_element;
+      new_element.pointer = &element;
+      new_element.tag = try_element.tag + 1;
       if (
-        atomic_cas(
-          &elements[last_try_element_i],
-          try_element == 1
-          ? (new_element | POINTER_HIGH_BIT)
-          : new_element,
-          try_element
-        )
-        ==
-        try_element
+        elements[last_try_element_i].compare_exchange(try_element, new_element)
       ) {
         if (try_element_i % 2 == 0) {
-          atomic_cas(&tail_element_i, try_element_i, tail_element_i_copy);
+          tail_element_i.compare_exchange(
+            tail_element_i_copy,
+            try_element_i,
+            MEMORY_ORDER_ACQ_REL
+          );
         }
 
         return true;
@@ -135,68 +130,64 @@ public:
   */
   ElementType* trydequeue() {
     for (;;) {
-      atomic_t head_element_i_copy = head_element_i;
+      atomic_t head_element_i_copy
+      = head_element_i.load(MEMORY_ORDER_ACQUIRE);
       atomic_t try_element_i = (head_element_i_copy + 1) % (Length + 2);
-      atomic_t try_element = elements[try_element_i];
+      Element try_element = elements[try_element_i].load();
 
-      while (try_element == 0 || try_element == 1) {
-        if (head_element_i_copy != head_element_i) {
+      while (try_element.pointer == NULL) {
+        if (head_element_i_copy != head_element_i.load(MEMORY_ORDER_ACQUIRE)) {
           break;
         }
-        if (try_element_i == tail_element_i) {
-          return 0;
+        if (try_element_i == tail_element_i.load(MEMORY_ORDER_ACQUIRE)) {
+          return NULL;
         }
         try_element_i = (try_element_i + 1) % (Length + 2);
-        try_element = elements[try_element_i];
+        try_element = elements[try_element_i].load();
       }
 
-      if (head_element_i_copy != head_element_i) {
+      if (head_element_i_copy != head_element_i.load(MEMORY_ORDER_ACQUIRE)) {
         continue;
       }
 
-      if (try_element_i == tail_element_i) {
-        atomic_cas(
-          &tail_element_i,
+      if (try_element_i == tail_element_i.load(MEMORY_ORDER_ACQUIRE)) {
+        atomic_t expected_tail_element_i = try_element_i;
+        tail_element_i.compare_exchange(
+          expected_tail_element_i,
           (try_element_i + 1) % (Length + 2),
-          try_element_i
+          MEMORY_ORDER_ACQ_REL
         );
 
         continue;
       }
 
-      if (head_element_i_copy != head_element_i) {
+      if (head_element_i_copy != head_element_i.load(MEMORY_ORDER_ACQUIRE)) {
         continue;
       }
 
-      if (
-        atomic_cas(
-          &elements[try_element_i],
-          (try_element & POINTER_HIGH_BIT) ? 1 : 0,
-          try_element
-        )
-        ==
-        try_element
-      ) {
+      Element empty_element;
+      empty_element.pointer = NULL;
+      empty_element.tag = try_element.tag + 1;
+      if (elements[try_element_i].compare_exchange(try_element, empty_element)) {
         if (try_element_i % 2 == 0) {
-          atomic_cas(&head_element_i, try_element_i, head_element_i_copy);
+          head_element_i.compare_exchange(
+            head_element_i_copy,
+            try_element_i,
+            MEMORY_ORDER_ACQ_REL
+          );
         }
 
-        atomic_t return_element = try_element;
-        return_element &= POINTER_LOW_BITS;
-        return_element <<= 1;
-        return reinterpret_cast<ElementType*>(return_element);
+        return try_element.pointer;
       }
     }
   }
 
 private:
-  const static atomic_t POINTER_HIGH_BIT
-  = static_cast<intptr_t>(1) << ((sizeof(intptr_t) * 8) - 1);
-  const static atomic_t POINTER_LOW_BITS = ~POINTER_HIGH_BIT;
+  typedef TaggedPointer<ElementType> Element;
 
 private:
-  volatile atomic_t elements[Length + 2];
-  volatile atomic_t head_element_i, tail_element_i;
+  AtomicTaggedPointer<ElementType> elements[Length + 2];
+  Atomic<atomic_t> head_element_i, tail_element_i;
 };
 }
 }
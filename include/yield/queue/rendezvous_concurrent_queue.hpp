@@ -41,9 +41,9 @@ namespace queue {
 template <class ElementType>
 class RendezvousConcurrentQueue {
 public:
-  RendezvousConcurrentQueue() {
-    element = 0;
-  }
+  RendezvousConcurrentQueue()
+    : element(NULL)
+  { }
 
   /**
     Enqueue a new element.
@@ -51,8 +51,12 @@ public:
     @return true if the enqueue was successful.
   */
   bool enqueue(ElementType& element) {
-    atomic_t atomic_element = reinterpret_cast<atomic_t>(&element);
-    return atomic_cas(&this->element, atomic_element, 0) == 0;
+    ElementType* expected_element = NULL;
+    return this->element.compare_exchange(
+             expected_element,
+             &element,
+             MEMORY_ORDER_RELEASE
+           );
   }
 
   /**
@@ -61,20 +65,16 @@ public:
     @return the dequeued element or NULL if the queue was empty
   */
   ElementType* trydequeue() {
-    atomic_t element = static_cast<atomic_t>(this->element);
-    while (element != 0) {
-      if (atomic_cas(&this->element, 0, element) == element) {
-        return reinterpret_cast<ElementType*>(element);
-      } else {
-        element = static_cast<atomic_t>(this->element);
-      }
+    // Poll with a plain load so that an empty queue costs no atomic RMW.
+    if (element.load(MEMORY_ORDER_RELAXED) != NULL) {
+      return element.exchange(NULL, MEMORY_ORDER_ACQUIRE);
+    } else {
+      return NULL;
     }
-
-    return NULL;
   }
 
 private:
-  volatile atomic_t element;
+  Atomic<ElementType*> element;
 };
 }
 }
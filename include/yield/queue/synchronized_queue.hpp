@@ -97,7 +97,7 @@ public:
       return element;
     } else {
       for (;;) {
-        Time start_time = Time::now();
+        Time start_time = Time::monotonic_now();
 
         cond.timedwait(timeout_left);
 
@@ -107,7 +107,7 @@ public:
           cond.unlock_mutex();
           return element;
         } else {
-          Time elapsed_time(Time::now() - start_time);
+          Time elapsed_time(Time::monotonic_now() - start_time);
           if (elapsed_time < timeout_left) {
             timeout_left -= elapsed_time;
           } else {
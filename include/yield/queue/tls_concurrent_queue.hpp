@@ -30,15 +30,14 @@
 #ifndef _YIELD_QUEUE_TLS_CONCURRENT_QUEUE_HPP_
 #define _YIELD_QUEUE_TLS_CONCURRENT_QUEUE_HPP_
 
-#include "yield/exception.hpp"
 #include "yield/queue/blocking_concurrent_queue.hpp"
-#include "yield/thread/thread.hpp"
+#include "yield/thread/thread_local.hpp"
 
 #include <stack>
 
 namespace yield {
 namespace queue {
-using yield::thread::Thread;
+using yield::thread::ThreadLocal;
 
 /**
   A queue that can handle multiple concurrent enqueues and dequeues but may
@@ -81,16 +80,7 @@ private:
   };
 
 public:
-  TLSConcurrentQueue() {
-    tls_key = Thread::self()->key_create();
-    if (tls_key == static_cast<uintptr_t>(-1)) {
-      throw Exception();
-    }
-  }
-
   ~TLSConcurrentQueue() {
-    Thread::self()->key_delete(tls_key);
-
     for (
       typename vector<Stack*>::iterator stack_i = stacks.begin();
       stack_i != stacks.end();
@@ -106,7 +96,7 @@ public:
     @return true if the enqueue was successful.
   */
   bool enqueue(ElementType& element) {
-    Stack* stack = static_cast<Stack*>(Thread::self()->getspecific(tls_key));
+    Stack* stack = this->stack.get();
 
     if (stack != NULL) {
       stack->push(element);
@@ -123,13 +113,13 @@ public:
   ElementType* trydequeue() {
     ElementType* element;
 
-    Stack* stack = static_cast<Stack*>(Thread::self()->getspecific(tls_key));
+    Stack* stack = this->stack.get();
 
     if (stack != NULL) {
       element = stack->pop();
     } else {
       stack = new Stack;
-      Thread::self()->setspecific(tls_key, stack);
+      this->stack.set(stack);
       stacks.push_back(stack);
       element = stack->pop();
     }
@@ -142,7 +132,7 @@ public:
   }
 
 private:
-  uintptr_t tls_key;
+  ThreadLocal<Stack> stack;
   vector<Stack*> stacks;
 };
 }
@@ -0,0 +1,197 @@
+// yield/queue/work_stealing_deque.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_QUEUE_WORK_STEALING_DEQUE_HPP_
+#define _YIELD_QUEUE_WORK_STEALING_DEQUE_HPP_
+
+#include "yield/atomic.hpp"
+
+#include <vector>
+
+namespace yield {
+namespace queue {
+/**
+  A growable Chase-Lev work-stealing deque.
+
+  A single owner thread pushes and pops elements at the bottom of the deque
+    (LIFO), while any number of other threads steal elements from the top
+    (FIFO). Owner operations are atomic-RMW-free except when racing a thief
+    for the last element.
+
+  Arrays outgrown by push are kept until the deque is destroyed, since a
+    thief may still be reading from them.
+*/
+template <class ElementType>
+class WorkStealingDeque {
+public:
+  /**
+    Construct an empty deque.
+    @param capacity initial capacity, rounded up to a power of two
+  */
+  WorkStealingDeque(size_t capacity = 64)
+    : bottom(0), top(0) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    arrays.push_back(new Array(size));
+    array.store(arrays.back(), MEMORY_ORDER_RELAXED);
+  }
+
+  ~WorkStealingDeque() {
+    for (
+      typename std::vector<Array*>::iterator array_i = arrays.begin();
+      array_i != arrays.end();
+      ++array_i
+    ) {
+      delete *array_i;
+    }
+  }
+
+public:
+  /**
+    Check whether the deque appears empty.
+    May be called from any thread; the result is a snapshot.
+    @return true if the deque appears empty
+  */
+  bool empty() const {
+    return bottom.load(MEMORY_ORDER_ACQUIRE) <= top.load(MEMORY_ORDER_ACQUIRE);
+  }
+
+public:
+  /**
+    Pop the element most recently pushed.
+    Must only be called by the owner thread.
+    @return the popped element or NULL if the deque was empty
+  */
+  ElementType* pop() {
+    intptr_t bottom = this->bottom.load(MEMORY_ORDER_RELAXED) - 1;
+    Array* array = this->array.load(MEMORY_ORDER_RELAXED);
+    this->bottom.store(bottom, MEMORY_ORDER_RELAXED);
+    atomic_fence(MEMORY_ORDER_SEQ_CST);
+    intptr_t top = this->top.load(MEMORY_ORDER_RELAXED);
+
+    if (top <= bottom) {
+      ElementType* element = array->get(bottom);
+      if (top == bottom) {
+        // Last element: race the thieves for it.
+        if (!this->top.compare_exchange(top, top + 1, MEMORY_ORDER_SEQ_CST)) {
+          element = NULL;
+        }
+        this->bottom.store(bottom + 1, MEMORY_ORDER_RELAXED);
+      }
+      return element;
+    } else {
+      this->bottom.store(bottom + 1, MEMORY_ORDER_RELAXED);
+      return NULL;
+    }
+  }
+
+  /**
+    Push an element onto the bottom of the deque, growing it if necessary.
+    Must only be called by the owner thread.
+    @param element the element to push
+  */
+  void push(ElementType& element) {
+    intptr_t bottom = this->bottom.load(MEMORY_ORDER_RELAXED);
+    intptr_t top = this->top.load(MEMORY_ORDER_ACQUIRE);
+    Array* array = this->array.load(MEMORY_ORDER_RELAXED);
+
+    if (bottom - top > static_cast<intptr_t>(array->mask)) {
+      Array* new_array = new Array((array->mask + 1) << 1);
+      for (intptr_t i = top; i < bottom; i++) {
+        new_array->put(i, array->get(i));
+      }
+      arrays.push_back(new_array);
+      this->array.store(new_array, MEMORY_ORDER_RELEASE);
+      array = new_array;
+    }
+
+    array->put(bottom, &element);
+    atomic_fence(MEMORY_ORDER_RELEASE);
+    this->bottom.store(bottom + 1, MEMORY_ORDER_RELAXED);
+  }
+
+  /**
+    Steal the least recently pushed element.
+    May be called from any thread.
+    @return the stolen element or NULL if the deque was empty or another
+      thread won the race for the element
+  */
+  ElementType* steal() {
+    intptr_t top = this->top.load(MEMORY_ORDER_ACQUIRE);
+    atomic_fence(MEMORY_ORDER_SEQ_CST);
+    intptr_t bottom = this->bottom.load(MEMORY_ORDER_ACQUIRE);
+
+    if (top < bottom) {
+      Array* array = this->array.load(MEMORY_ORDER_ACQUIRE);
+      ElementType* element = array->get(top);
+      if (this->top.compare_exchange(top, top + 1, MEMORY_ORDER_SEQ_CST)) {
+        return element;
+      }
+    }
+
+    return NULL;
+  }
+
+private:
+  struct Array {
+    Array(size_t size)
+      : elements(new Atomic<ElementType*>[size]), mask(size - 1)
+    { }
+
+    ~Array() {
+      delete [] elements;
+    }
+
+    ElementType* get(intptr_t i) const {
+      return elements[static_cast<size_t>(i) & mask].load(MEMORY_ORDER_RELAXED);
+    }
+
+    void put(intptr_t i, ElementType* element) {
+      elements[static_cast<size_t>(i) & mask].store(
+        element,
+        MEMORY_ORDER_RELAXED
+      );
+    }
+
+    Atomic<ElementType*>* elements;
+    size_t mask;
+  };
+
+private:
+  Atomic<Array*> array;
+  std::vector<Array*> arrays;
+  Atomic<intptr_t> bottom, top;
+};
+}
+}
+
+#endif
@@ -30,6 +30,7 @@
 #ifndef _YIELD_SOCKETS_AIO_ACCEPT_AIOCB_HPP_
 #define _YIELD_SOCKETS_AIO_ACCEPT_AIOCB_HPP_
 
+#include "yield/auto_object.hpp"
 #include "yield/sockets/aio/aiocb.hpp"
 
 namespace yield {
@@ -63,6 +64,21 @@ public:
     YO_NEW_REF Buffer* recv_buffer = NULL
   );
 
+  /**
+    Construct an acceptAIOCB with a buffer for receiving data after a new
+      connection is accepted.
+    @param socket_ listen socket to accept on
+    @param context optional context object
+    @param recv_buffer buffer for receiving data after a new connection is
+      accepted, whose reference is moved into the control block
+  */
+  acceptAIOCB(
+    StreamSocket& socket_,
+    Object* context,
+    auto_Object<Buffer>&& recv_buffer
+  ) : acceptAIOCB(socket_, context, recv_buffer.release())
+  { }
+
   ~acceptAIOCB();
 
 public:
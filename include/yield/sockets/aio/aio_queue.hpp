@@ -32,6 +32,8 @@
 
 #ifdef _WIN32
 #include "yield/event_queue.hpp"
+#include "yield/timer_wheel.hpp"
+#include "yield/thread/lightweight_mutex.hpp"
 #else
 #include "yield/sockets/aio/nbio_queue.hpp"
 #endif
@@ -41,6 +43,10 @@ class Log;
 
 namespace sockets {
 namespace aio {
+#ifdef _WIN32
+class AIOCB;
+#endif
+
 /**
   Queue for asynchronous input/output (AIO) operations on sockets.
   The queue is similar to Win32 I/O completion ports or Linux io_submit AIO:
@@ -68,6 +74,15 @@ public:
   */
   bool associate(socket_t socket_);
 
+  /**
+    Cancel an AIO operation enqueued on this AIOQueue with CancelIoEx.
+    If the operation is still pending, its AIOCB is dequeued with
+      get_error() == AIOCB::Error::CANCELED.
+    @param aiocb the AIOCB to cancel
+    @return true if a pending operation was found and canceled
+  */
+  bool cancel(AIOCB& aiocb);
+
 public:
   // yield::Object
   const char* get_type_name() const {
@@ -83,6 +98,15 @@ public:
   bool enqueue(YO_NEW_REF Event& event);
   YO_NEW_REF Event* timeddequeue(const Time& timeout);
 
+private:
+  class DeadlineTimerEvent;
+
+private:
+  void arm_deadline(AIOCB& aiocb);
+  bool disarm_deadline(AIOCB& aiocb);
+  void expire_deadlines(const Time& now);
+  bool start(YO_NEW_REF Event& event);
+
 private:
   template <class AIOCBType> void log_completion(AIOCBType& aiocb);
   template <class AIOCBType> void log_enqueue(AIOCBType& aiocb);
@@ -91,6 +115,9 @@ private:
 private:
   fd_t hIoCompletionPort;
   Log* log;
+  // Deadlines are armed by enqueuing threads and expired by dequeuing ones.
+  TimerWheel timer_wheel;
+  ::yield::thread::LightweightMutex timer_wheel_lock;
 };
 #else
 typedef NBIOQueue AIOQueue;
@@ -31,6 +31,7 @@
 #define _YIELD_SOCKETS_AIO_AIOCB_HPP_
 
 #include "yield/event.hpp"
+#include "yield/time.hpp"
 
 #ifdef _WIN32
 struct _OVERLAPPED;
@@ -38,6 +39,8 @@ typedef struct _OVERLAPPED OVERLAPPED;
 #endif
 
 namespace yield {
+class TimerEvent;
+
 namespace sockets {
 class Socket;
 
@@ -51,6 +54,26 @@ class NBIOQueue;
   Asynchronous Input/Output Control Block (AIOCB) for sockets.
 */
 class AIOCB : public Event {
+public:
+  /**
+    Error codes, in addition to the platform's own, with which an AIO
+      operation can complete.
+  */
+  class Error {
+  public:
+    /**
+      The operation was canceled with AIOQueue::cancel
+        (ECANCELED, or ERROR_OPERATION_ABORTED on Win32).
+    */
+    const static uint32_t CANCELED;
+
+    /**
+      The operation did not complete within its timeout
+        (ETIMEDOUT, or WSAETIMEDOUT on Win32).
+    */
+    const static uint32_t TIMED_OUT;
+  };
+
 public:
   virtual ~AIOCB();
 
@@ -105,6 +128,27 @@ public:
     return socket_;
   }
 
+  /**
+    Get the timeout of the AIO operation associated with this control block.
+    @return the timeout, or Time::FOREVER if the operation has none
+  */
+  const Time& get_timeout() const {
+    return timeout;
+  }
+
+  /**
+    Set a timeout for the AIO operation associated with this control block,
+      measured from when the AIO queue starts the operation.
+    An operation that has not completed by then is abandoned, releasing the
+      AIO queue's resources for it, and completes with
+      get_error() == Error::TIMED_OUT.
+    Must be set before the control block is enqueued.
+    @param timeout the timeout, or Time::FOREVER (the default) for none
+  */
+  void set_timeout(const Time& timeout) {
+    this->timeout = timeout;
+  }
+
 public:
 #ifdef _WIN32
   /**
@@ -162,9 +206,12 @@ private:
 #endif
 
   Object* context;
+  // Armed by the AIO queue while the operation is pending with a timeout.
+  TimerEvent* deadline_timer_event;
   uint32_t error;
   ssize_t return_;
   Socket& socket_;
+  Time timeout;
 };
 }
 }
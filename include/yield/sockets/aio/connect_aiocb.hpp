@@ -30,6 +30,7 @@
 #ifndef _YIELD_SOCKETS_AIO_CONNECT_AIOCB_HPP_
 #define _YIELD_SOCKETS_AIO_CONNECT_AIOCB_HPP_
 
+#include "yield/auto_object.hpp"
 #include "yield/sockets/aio/aiocb.hpp"
 
 namespace yield {
@@ -63,6 +64,23 @@ public:
     YO_NEW_REF Buffer* send_buffer = NULL
   );
 
+  /**
+    Construct a connectAIOCB with a buffer for sending data after a
+      connection is established.
+    @param socket_ socket to connect
+    @param peername address of the peer to connect to
+    @param context optional context object
+    @param send_buffer buffer of data to send after the connection is
+      established, whose reference is moved into the control block
+  */
+  connectAIOCB(
+    StreamSocket& socket_,
+    SocketAddress& peername,
+    Object* context,
+    auto_Object<Buffer>&& send_buffer
+  ) : connectAIOCB(socket_, peername, context, send_buffer.release())
+  { }
+
   ~connectAIOCB();
 
 public:
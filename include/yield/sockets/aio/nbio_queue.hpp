@@ -33,7 +33,9 @@
 #include "yield/event_queue.hpp"
 #include "yield/poll/fd_event_queue.hpp"
 #include "yield/sockets/aio/aiocb.hpp"
+#include "yield/sockets/socket.hpp"
 
+#include <deque>
 #include <map>
 
 namespace yield {
@@ -46,6 +48,7 @@ class connectAIOCB;
 class recvAIOCB;
 class sendAIOCB;
 class sendfileAIOCB;
+class spliceAIOCB;
 
 /**
   Queue for asynchronous input/output (AIO) operations on sockets,
@@ -77,6 +80,18 @@ public:
     return true;
   }
 
+  /**
+    Cancel an AIO operation enqueued on this NBIOQueue.
+    If the operation is still pending when the cancellation is processed,
+      it is abandoned and its AIOCB is dequeued with
+      get_error() == AIOCB::Error::CANCELED. Otherwise the cancellation
+      has no effect.
+    Like enqueue, may be called from any thread.
+    @param aiocb the AIOCB to cancel
+    @return true if the cancellation was queued
+  */
+  bool cancel(AIOCB& aiocb);
+
 public:
   // yield::Object
   const char* get_type_name() const {
@@ -94,18 +109,31 @@ public:
 
 private:
   class AIOCBState;
+  class CancelEvent;
+  class DeadlineTimerEvent;
 
   enum RetryStatus {
     RETRY_STATUS_COMPLETE,
     RETRY_STATUS_ERROR,
     RETRY_STATUS_WANT_RECV,
-    RETRY_STATUS_WANT_SEND
+    RETRY_STATUS_WANT_SEND,
+    // A spliceAIOCB would block on its descriptor rather than its socket.
+    RETRY_STATUS_WANT_SPLICE_READ,
+    RETRY_STATUS_WANT_SPLICE_WRITE
   };
 
   class SocketState;
 
 private:
-  void associate(AIOCB& aiocb, RetryStatus retry_status);
+  YO_NEW_REF AIOCB* abandon(AIOCB& aiocb, uint32_t error);
+  void arm_deadline(AIOCB& aiocb);
+  bool borrow_pipe(AIOCBState& aiocb_state);
+  static bool can_coalesce(sendAIOCB& first, AIOCB& aiocb);
+  void complete(AIOCBState*& aiocb_state, SocketState& socket_state);
+  void defer_completion(AIOCBState& aiocb_state, SocketState& socket_state);
+  void disarm_deadline(AIOCB& aiocb);
+  void recv_zerocopy_notifications(fd_t fd, SocketState& socket_state);
+  void return_pipe(AIOCBState& aiocb_state);
 
 private:
   template <class AIOCBType> void log_completion(AIOCBType&);
@@ -116,21 +144,47 @@ private:
 
 private:
   static uint8_t get_aiocb_priority(const AIOCB& aiocb);
+  static bool is_zerocopy(const AIOCB& aiocb);
 
 private:
   RetryStatus retry(AIOCB&, size_t& partial_send_len);
+  void
+  retry(
+    std::map<fd_t, SocketState*>::iterator socket_state_i,
+    yield::poll::FDEvent::Type ready_fd_event_types
+  );
   RetryStatus retry_accept(acceptAIOCB&);
   RetryStatus retry_connect(connectAIOCB&, size_t& partial_send_len);
   RetryStatus retry_recv(recvAIOCB&);
   RetryStatus retry_send(sendAIOCB&, size_t& partial_send_len);
   template <class AIOCBType>
-  RetryStatus retry_send(AIOCBType&, const Buffer&, size_t& partial_send_len);
+  RetryStatus
+  retry_send(
+    AIOCBType&,
+    const Buffer&,
+    const Socket::MessageFlags&,
+    size_t& partial_send_len
+  );
   RetryStatus retry_sendfile(sendfileAIOCB&, size_t& partial_send_len);
+  RetryStatus retry_sendmsg(SocketState& socket_state);
+  RetryStatus retry_splice(AIOCBState& aiocb_state);
 
 private:
+  std::deque<AIOCB*> completed_aiocbs;
   yield::poll::FDEventQueue fd_event_queue;
   Log* log;
   std::map<fd_t, SocketState*> socket_state;
+  // Pipes (read end, write end) returned by spliceAIOCBs.
+  vector< std::pair<fd_t, fd_t> > spare_pipes;
+  // Receive buffer left over from a lazy recv that would have blocked.
+  Buffer* spare_recv_buffer;
+  // The descriptors of spliceAIOCBs waiting on them, mapped to the
+  // spliceAIOCBs' sockets.
+  std::map<fd_t, fd_t> splice_fds;
+  // Whether splices to a descriptor must block SIGPIPE around themselves,
+  // or -1 until the first one checks whether SIGPIPE is already blocked or
+  // ignored on the thread driving the queue.
+  int8_t splice_sigpipe_mask;
 };
 }
 }
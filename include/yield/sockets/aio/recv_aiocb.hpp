@@ -57,7 +57,47 @@ public:
     const Socket::MessageFlags& flags,
     Object* context = NULL
   ) : AIOCB(socket_, context),
-    buffer(buffer),
+    buffer(&buffer),
+    buffer_capacity(buffer.capacity()),
+    flags(flags)
+  { }
+
+  /**
+    Construct a recvAIOCB, passing the same parameters as to recv.
+    @param socket_ socket to receive data on
+    @param buffer buffer to receive data into, whose reference is moved into
+      the control block
+    @param flags flags to pass to the recv method
+    @param context optional context object
+  */
+  recvAIOCB(
+    Socket& socket_,
+    auto_Object<Buffer>&& buffer,
+    const Socket::MessageFlags& flags,
+    Object* context = NULL
+  ) : AIOCB(socket_, context),
+    buffer(buffer.release()),
+    buffer_capacity(this->buffer->capacity()),
+    flags(flags)
+  { }
+
+  /**
+    Construct a recvAIOCB whose buffer is only allocated once the socket
+      is readable, so that a pending receive on an idle socket holds no
+      buffer memory.
+    @param socket_ socket to receive data on
+    @param buffer_capacity capacity of the buffer to receive data into
+    @param flags flags to pass to the recv method
+    @param context optional context object
+  */
+  recvAIOCB(
+    Socket& socket_,
+    size_t buffer_capacity,
+    const Socket::MessageFlags& flags,
+    Object* context = NULL
+  ) : AIOCB(socket_, context),
+    buffer(NULL),
+    buffer_capacity(buffer_capacity),
     flags(flags)
   { }
 
@@ -66,10 +106,20 @@ public:
 public:
   /**
     Get the buffer in which to receive data.
+    A recvAIOCB constructed with a buffer capacity only has a buffer once
+      it has completed without error; see has_buffer.
     @return the buffer in which to receive data
   */
   Buffer& get_buffer() const {
-    return buffer;
+    return *buffer;
+  }
+
+  /**
+    Get the capacity of the buffer in which to receive data.
+    @return the capacity of the buffer in which to receive data
+  */
+  size_t get_buffer_capacity() const {
+    return buffer_capacity;
   }
 
   /**
@@ -80,6 +130,14 @@ public:
     return flags;
   }
 
+  /**
+    Check whether this recvAIOCB has a buffer yet.
+    @return true if this recvAIOCB has a buffer
+  */
+  bool has_buffer() const {
+    return buffer != NULL;
+  }
+
 public:
   // yield::Object
   uint32_t get_type_id() const {
@@ -91,7 +149,18 @@ public:
   }
 
 private:
-  Buffer& buffer;
+#ifdef _WIN32
+  friend class AIOQueue;
+#endif
+  friend class NBIOQueue;
+
+  void set_buffer(YO_NEW_REF Buffer& buffer) {
+    this->buffer = &buffer;
+  }
+
+private:
+  Buffer* buffer;
+  size_t buffer_capacity;
   Socket::MessageFlags flags;
 };
 
@@ -61,6 +61,24 @@ public:
     flags(flags) {
   }
 
+  /**
+    Construct a sendAIOCB, passing the same parameters as to send.
+    @param socket_ socket to send data on
+    @param buffer buffer to send data from, whose reference is moved into
+      the control block
+    @param flags flags to pass to the send method
+    @param context optional context object
+  */
+  sendAIOCB(
+    Socket& socket_,
+    auto_Object<Buffer>&& buffer,
+    const Socket::MessageFlags& flags,
+    Object* context = NULL
+  ) : AIOCB(socket_, context),
+    buffer(*buffer.release()),
+    flags(flags) {
+  }
+
   ~sendAIOCB();
 
 public:
@@ -0,0 +1,168 @@
+// yield/sockets/aio/splice_aiocb.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_SOCKETS_AIO_SPLICE_AIOCB_HPP_
+#define _YIELD_SOCKETS_AIO_SPLICE_AIOCB_HPP_
+
+#include "yield/sockets/aio/aiocb.hpp"
+
+#include <stdio.h>
+
+namespace yield {
+namespace sockets {
+class StreamSocket;
+
+namespace aio {
+/**
+  AIO control block for splice operations, which move data between a socket
+    and another descriptor (a file, a pipe or another socket) through a pipe
+    borrowed from the NBIOQueue, without copying it into userspace.
+  The operation completes once nbytes have been moved or the source reaches
+    end-of-file, returning the number of bytes moved.
+  Only supported by the NBIOQueue on Linux. Elsewhere it fails with ENOSYS.
+*/
+class spliceAIOCB : public AIOCB {
+public:
+  const static uint32_t TYPE_ID = 3540196487UL;
+
+public:
+  /**
+    Construct a spliceAIOCB that moves data from a socket to a descriptor.
+    @param from_socket socket to receive data from
+    @param to_fd descriptor to write data to, at its current offset; it's
+      in non-blocking mode until the operation is done
+    @param nbytes maximum number of bytes to move, or SIZE_MAX to move data
+      until from_socket reaches end-of-file
+    @param context optional context object
+  */
+  spliceAIOCB(
+    StreamSocket& from_socket,
+    fd_t to_fd,
+    size_t nbytes,
+    Object* context = NULL
+  );
+
+  /**
+    Construct a spliceAIOCB that moves data from a descriptor to a socket.
+    @param from_fd descriptor to read data from, at its current offset; it's
+      in non-blocking mode until the operation is done
+    @param to_socket socket to send data on
+    @param nbytes maximum number of bytes to move, or SIZE_MAX to move data
+      until from_fd reaches end-of-file
+    @param context optional context object
+  */
+  spliceAIOCB(
+    fd_t from_fd,
+    StreamSocket& to_socket,
+    size_t nbytes,
+    Object* context = NULL
+  );
+
+  /**
+    Construct a spliceAIOCB that moves data from one socket to another.
+    @param from_socket socket to receive data from
+    @param to_socket socket to send data on; it's in non-blocking mode
+      until the operation is done
+    @param nbytes maximum number of bytes to move, or SIZE_MAX to move data
+      until from_socket reaches end-of-file
+    @param context optional context object
+  */
+  spliceAIOCB(
+    StreamSocket& from_socket,
+    StreamSocket& to_socket,
+    size_t nbytes,
+    Object* context = NULL
+  );
+
+  ~spliceAIOCB();
+
+public:
+  /**
+    Get the descriptor at the other end of the splice from the socket.
+    @return the descriptor at the other end of the splice from the socket
+  */
+  fd_t get_fd() {
+    return fd;
+  }
+
+  /**
+    Get the maximum number of bytes to move.
+    @return the maximum number of bytes to move
+  */
+  size_t get_nbytes() const {
+    return nbytes;
+  }
+
+  /**
+    Get the socket in this splice operation.
+    @return the socket in this splice operation
+  */
+  StreamSocket& get_socket();
+
+  /**
+    Check whether data moves from the socket to the descriptor, rather than
+      from the descriptor to the socket.
+    @return true if data moves from the socket to the descriptor
+  */
+  bool is_from_socket() const {
+    return from_socket;
+  }
+
+public:
+  // yield::Object
+  uint32_t get_type_id() const {
+    return TYPE_ID;
+  }
+
+  const char* get_type_name() const {
+    return "yield::sockets::aio::spliceAIOCB";
+  }
+
+private:
+  void init(fd_t fd);
+
+private:
+  fd_t fd;
+  bool from_socket;
+  size_t nbytes;
+};
+
+/**
+  Print a string representation of a spliceAIOCB to a std::ostream.
+  @param os std::ostream to print to
+  @param splice_aiocb spliceAIOCB to print
+  @return os
+*/
+std::ostream& operator<<(std::ostream& os, spliceAIOCB& splice_aiocb);
+}
+}
+}
+
+#endif
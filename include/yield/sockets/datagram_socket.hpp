@@ -96,6 +96,29 @@ public:
     }
   }
 
+  /**
+    Read a batch of datagrams from the socket, one datagram per Buffer,
+      also recording each sender's address.
+    Blocks at most until the first datagram arrives, then returns as many
+      datagrams as are already queued, up to buffers_len.
+    Equivalent to a single recvmmsg on Linux. Elsewhere reads one datagram.
+    Updates the size of each filled buffer.
+    @param[in, out] buffers array of buffers to read datagrams into
+    @param buffers_len length of the buffers array
+    @param flags flags altering the behavior of the underlying system call
+    @param[out] peernames array of buffers_len sender addresses, or NULL
+    @return the number of datagrams read on success, -1+errno on failure
+  */
+  virtual ssize_t
+  recvmmsg(
+    Buffer* const* buffers,
+    size_t buffers_len,
+    const MessageFlags& flags,
+    SocketAddress* peernames
+  ) {
+    return recvmmsg(buffers, buffers_len, flags, peernames, NULL);
+  }
+
   /**
     Read from the socket into a single buffer, also recording the sender's address.
     @param[in, out] buf pointer to the buffer
@@ -130,6 +153,26 @@ public:
   );
 
 public:
+  /**
+    Write a batch of datagrams to the socket, one datagram per Buffer.
+    Equivalent to a single sendmmsg on Linux. Elsewhere sends the datagrams
+      one at a time.
+    @param buffers array of buffers to write datagrams from
+    @param buffers_len length of the buffers array
+    @param flags flags altering the behavior of the underlying system call
+    @param peernames array of buffers_len receiver addresses, or NULL if
+      the socket is connected
+    @return the number of datagrams written on success, which may be fewer
+      than buffers_len, -1+errno on failure
+  */
+  virtual ssize_t
+  sendmmsg(
+    const Buffer* const* buffers,
+    size_t buffers_len,
+    const MessageFlags& flags,
+    const SocketAddress* peernames
+  );
+
   /**
     Write to the socket and a specific peer from multiple buffers (gather I/O).
     @param iov array of I/O vectors describing the buffers
@@ -194,6 +237,23 @@ public:
     return Object::inc_ref(*this);
   }
 
+protected:
+  /**
+    Read a batch of datagrams as recvmmsg(Buffer* const*, size_t,
+      const MessageFlags&, SocketAddress*) does, also recording the
+      segment size of each datagram that the kernel coalesced (UDP GRO).
+    @param[out] segment_sizes array of buffers_len segment sizes, or NULL;
+      a datagram that was not coalesced has its own length as segment size
+  */
+  ssize_t
+  recvmmsg(
+    Buffer* const* buffers,
+    size_t buffers_len,
+    const MessageFlags& flags,
+    SocketAddress* peernames,
+    uint16_t* segment_sizes
+  );
+
 private:
   friend class DatagramSocketPair;
 
@@ -72,6 +72,23 @@ public:
     */
     const static int PEEK = 4;
 
+    /**
+      More data will follow the message, so a partial segment may be held
+        back until it does. Equivalent to MSG_MORE where it's available;
+        ignored elsewhere.
+    */
+    const static int MORE = 8;
+
+    /**
+      Send the message from the caller's pages instead of copying them into
+        the kernel, if the socket has Option::ZEROCOPY set. The pages must
+        not be modified or freed until the kernel posts a notification
+        on the socket's error queue; NBIOQueue waits for it before
+        completing a sendAIOCB. Equivalent to MSG_ZEROCOPY where it's
+        available; ignored elsewhere.
+    */
+    const static int ZEROCOPY = 16;
+
   public:
     /**
       Construct a MessageFlags from a platform-specific integer constant.
@@ -97,7 +114,23 @@ public:
   public:
     const static int RCVBUF;
     const static int REUSEADDR;
+
+    /**
+      Allow several sockets to bind the same address and port, with the
+        kernel spreading incoming connections or datagrams between them.
+      Equivalent to SO_REUSEPORT where it's available. Elsewhere setsockopt
+        fails.
+    */
+    const static int REUSEPORT;
+
     const static int SNDBUF;
+
+    /**
+      Allow sends with MessageFlags::ZEROCOPY to skip the copy into the
+        kernel. Equivalent to SO_ZEROCOPY where it's available. Elsewhere
+        setsockopt fails.
+    */
+    const static int ZEROCOPY;
   };
 
 public:
@@ -108,7 +141,9 @@ public:
   Socket(int domain, int type, int protocol)
     : domain(domain),
       type(type),
-      protocol(protocol) {
+      protocol(protocol),
+      zerocopy(false),
+      zerocopy_send_count(0) {
     socket_ = create(domain, type, protocol);
     if (socket_ == static_cast<socket_t>(-1)) {
       throw Exception();
@@ -229,6 +264,18 @@ public:
     return type;
   }
 
+public:
+  /**
+    Get the number of zero-copy sends made on this socket, which is also
+      the ID the kernel will give the next one in its error queue
+      notifications. Only sends with MessageFlags::ZEROCOPY that sent
+      something on a socket with Option::ZEROCOPY set are counted.
+    @return the number of zero-copy sends made on this socket, modulo 2^32
+  */
+  uint32_t get_zerocopy_send_count() const {
+    return zerocopy_send_count;
+  }
+
 public:
   /**
     Get the underlying socket descriptor.
@@ -425,14 +472,22 @@ protected:
     : domain(domain),
       type(type),
       protocol(protocol),
-      socket_(socket_)
+      socket_(socket_),
+      zerocopy(false),
+      zerocopy_send_count(0)
   { }
 
   static socket_t create(int domain, int type, int protocol);
 
+  // Count a send toward get_zerocopy_send_count if it was zero-copy.
+  void count_zerocopy_send(ssize_t send_ret, const MessageFlags& flags);
+
 private:
   int domain, type, protocol;
   socket_t socket_;
+  // Whether Option::ZEROCOPY has been set through setsockopt.
+  bool zerocopy;
+  uint32_t zerocopy_send_count;
 };
 
 /**
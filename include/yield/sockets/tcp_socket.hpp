@@ -57,6 +57,14 @@ public:
   */
   class Option : public StreamSocket::Option {
   public:
+    /**
+      Only complete accepts of connections once data has arrived on them,
+        or the option value in seconds has passed.
+      Equivalent to TCP_DEFER_ACCEPT on Linux. Elsewhere setsockopt fails
+        with ENOPROTOOPT.
+    */
+    const static int DEFER_ACCEPT;
+
     /**
       Disable the Nagle algorithm for coalescing small writes before
         transmission.
@@ -51,6 +51,33 @@ public:
   */
   const static int PROTOCOL;
 
+public:
+  /**
+    UDP-specific options for setsockopt.
+  */
+  class Option : public DatagramSocket::Option {
+  public:
+    /**
+      Let the kernel coalesce consecutive datagrams from the same flow into
+        one large datagram on receive (generic receive offload).
+      Read coalesced datagrams with
+        recvmmsg(Buffer* const*, size_t, const MessageFlags&,
+        SocketAddress*, uint16_t*) to learn where to split them.
+      Equivalent to UDP_GRO on Linux. Elsewhere setsockopt fails
+        with ENOPROTOOPT.
+    */
+    const static int GRO;
+
+    /**
+      Have the kernel split each datagram written to the socket into
+        datagrams of the option value's size in bytes, the last possibly
+        shorter (generic segmentation offload). 0 disables splitting.
+      Equivalent to UDP_SEGMENT on Linux. Elsewhere setsockopt fails
+        with ENOPROTOOPT.
+    */
+    const static int SEGMENT;
+  };
+
 public:
   /**
     Construct a UDPSocket with the given domain.
@@ -70,6 +97,14 @@ public:
   UDPSocket& inc_ref() {
     return Object::inc_ref(*this);
   }
+
+public:
+  // yield::sockets::Socket
+  virtual bool setsockopt(int option_name, int option_value);
+
+public:
+  // yield::sockets::DatagramSocket
+  using DatagramSocket::recvmmsg;
 };
 }
 }
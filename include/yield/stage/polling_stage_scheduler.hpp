@@ -42,7 +42,8 @@ public:
   virtual ~PollingStageScheduler();
 
   // StageScheduler
-  void schedule(Stage&, ConcurrencyLevel);
+  using StageScheduler::schedule;
+  void schedule(Stage&, ConcurrencyLevel, const Placement&);
 
 protected:
   class StagePoller : public ::yield::thread::Runnable {
@@ -50,6 +51,7 @@ protected:
     virtual ~StagePoller();
 
     void schedule(Stage&);
+    void set_processor_set(YO_NEW_REF ::yield::thread::ProcessorSet*);
     void stop() {
       _should_run = false;
     }
@@ -57,6 +59,8 @@ protected:
   protected:
     StagePoller(Stage&);
 
+    // Bind the calling poller thread to its processor set, if any
+    void bind();
     vector<Stage*>& get_stages();
     inline bool should_run() const {
       return _should_run;
@@ -64,6 +68,7 @@ protected:
 
   private:
     ::yield::queue::RendezvousConcurrentQueue<Stage> new_stage;
+    ::yield::thread::ProcessorSet* processor_set;
     bool _should_run;
     vector<Stage*> stages;
   };
@@ -40,7 +40,8 @@ public:
   ~SEDAStageScheduler();
 
   // StageScheduler
-  void schedule(Stage&, ConcurrencyLevel);
+  using StageScheduler::schedule;
+  void schedule(Stage&, ConcurrencyLevel, const Placement&);
 
 private:
   class SEDAStage;
@@ -32,8 +32,14 @@
 
 #include "yield/object.hpp"
 
+#include <map>
 
 namespace yield {
+namespace thread {
+class ProcessorSet;
+class ProcessorTopology;
+}
+
 namespace stage {
 class Stage;
 
@@ -57,12 +63,128 @@ public:
     uint16_t concurrency_level;
   };
 
+  /**
+    Where to run the threads a stage is scheduled on.
+  */
+  class Placement {
+  public:
+    /**
+      Let the operating system place the threads.
+    */
+    const static Placement DEFAULT;
+
+    /**
+      Bind each thread to a different physical core (to all of the core's
+        SMT siblings), continuing round-robin from the last core used
+        by this scheduler.
+    */
+    const static Placement SPREAD;
+
+    /**
+      Keep the threads on the physical cores of one NUMA node.
+      @param numa_node_i index into ProcessorTopology::get_numa_nodes
+      @return the placement
+    */
+    static Placement pack(uint16_t numa_node_i = 0) {
+      return Placement(POLICY_PACK, numa_node_i, NULL, NULL);
+    }
+
+    /**
+      Bind the threads to an explicit set of processors.
+      @param processor_set the set of processors, which must outlive
+        the schedule call
+      @return the placement
+    */
+    static Placement pin(const yield::thread::ProcessorSet& processor_set) {
+      return Placement(POLICY_PIN, 0, &processor_set, NULL);
+    }
+
+    /**
+      Bind the threads to the last-level cache domain (or, failing that,
+        the package) of a stage already scheduled with a placement on this
+        scheduler, so that cooperating stages share a cache.
+      @param stage the stage to run next to
+      @return the placement
+    */
+    static Placement colocate(const Stage& stage) {
+      return Placement(POLICY_COLOCATE, 0, NULL, &stage);
+    }
+
+  private:
+    friend class StageScheduler;
+
+    enum Policy {
+      POLICY_DEFAULT,
+      POLICY_SPREAD,
+      POLICY_PACK,
+      POLICY_PIN,
+      POLICY_COLOCATE
+    };
+
+    Placement(
+      Policy policy,
+      uint16_t numa_node_i,
+      const yield::thread::ProcessorSet* processor_set,
+      const Stage* stage
+    )
+      : numa_node_i(numa_node_i),
+        policy(policy),
+        processor_set(processor_set),
+        stage(stage)
+    { }
+
+  private:
+    uint16_t numa_node_i;
+    Policy policy;
+    const yield::thread::ProcessorSet* processor_set;
+    const Stage* stage;
+  };
+
+public:
+  virtual ~StageScheduler();
+
 public:
   virtual void schedule(Stage& stage) {
     return schedule(stage, ConcurrencyLevel::DEFAULT);
   }
 
-  virtual void schedule(Stage&, ConcurrencyLevel) = 0;
+  virtual void schedule(Stage& stage, ConcurrencyLevel concurrency_level) {
+    return schedule(stage, concurrency_level, Placement::DEFAULT);
+  }
+
+  virtual void schedule(Stage&, ConcurrencyLevel, const Placement&) = 0;
+
+protected:
+  StageScheduler();
+
+  /**
+    Bind the caller's thread to a set of processors and make it prefer the
+      memory of the NUMA node it is then running on, so that the Events,
+      Buffers and queue storage it allocates stay local.
+    Called by a stage thread itself, before it starts visiting stages.
+    @param processor_set the processors returned by place
+    @return true if the thread was bound
+  */
+  static bool bind(const yield::thread::ProcessorSet& processor_set);
+
+  /**
+    Choose the processors for a new thread that runs stage and remember
+      them, for later Placement::colocate requests.
+    @param stage the stage the thread is created for
+    @param placement the placement requested for stage
+    @return a new set of processors for the thread to bind to, or NULL
+      if the placement is DEFAULT or could not be satisfied
+  */
+  YO_NEW_REF yield::thread::ProcessorSet*
+  place(const Stage& stage, const Placement& placement);
+
+private:
+  yield::thread::ProcessorTopology& get_processor_topology();
+
+private:
+  uint16_t next_core_i;
+  std::map<const Stage*, yield::thread::ProcessorSet*> placements;
+  yield::thread::ProcessorTopology* processor_topology;
 };
 }
 }
@@ -41,6 +41,8 @@
 #endif
 
 namespace yield {
+class Time;
+
 namespace thread {
 /**
   Condition variable synchronization primitive.
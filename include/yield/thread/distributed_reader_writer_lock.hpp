@@ -0,0 +1,166 @@
+// yield/thread/distributed_reader_writer_lock.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_THREAD_DISTRIBUTED_READER_WRITER_LOCK_HPP_
+#define _YIELD_THREAD_DISTRIBUTED_READER_WRITER_LOCK_HPP_
+
+#include "yield/atomic.hpp"
+#include "yield/time.hpp"
+#include "yield/thread/condition_variable.hpp"
+
+namespace yield {
+namespace thread {
+/**
+  Reader-writer lock for read-mostly data that scales with the number of
+    concurrent readers.
+  While the lock is reader-biased, a reader announces itself by claiming
+    a slot in a table of cache-line-sized reader indicators, one per thread
+    up to a few per processor, so concurrent readers touch no shared cache
+    line. A writer revokes the bias and waits for the indicators to drain;
+    readers then fall back to a central writer-preferring lock until the
+    bias is restored. The bias is not restored for a period proportional to
+    the last revocation's cost, which bounds the overhead that revocations
+    can add to write-heavy phases.
+  Based on:
+    Dave Dice and Alex Kogan. 2019. BRAVO: Biased Locking for Reader-Writer
+      Locks. In Proceedings of the 2019 USENIX Annual Technical Conference
+      (ATC '19). USENIX Association, Berkeley, CA, USA, 315-328.
+  The lock is not recursive for writers. A thread may hold more than one
+    reader lock on the same DistributedReaderWriterLock.
+*/
+class DistributedReaderWriterLock {
+public:
+  DistributedReaderWriterLock();
+  ~DistributedReaderWriterLock();
+
+public:
+  /**
+    Wait indefinitely to acquire a reader (shared) lock.
+    @return true if the caller now holds a reader lock
+  */
+  bool rdlock() {
+    return (reader_biased.load(MEMORY_ORDER_RELAXED) && rdlock_fast())
+           ||
+           rdlock_slow(true);
+  }
+
+  /**
+    Release a reader (shared) lock.
+  */
+  void rdunlock() {
+    ReaderSlot& reader_slot = get_reader_slot();
+    if (reader_slot.reader.load(MEMORY_ORDER_RELAXED) == get_reader_id()) {
+      reader_slot.reader.store(NULL, MEMORY_ORDER_RELEASE);
+    } else {
+      rdunlock_slow();
+    }
+  }
+
+  /**
+    Try to acquire a reader (shared) lock without blocking.
+    @return true if the caller now holds a reader lock
+  */
+  bool tryrdlock() {
+    return (reader_biased.load(MEMORY_ORDER_RELAXED) && rdlock_fast())
+           ||
+           rdlock_slow(false);
+  }
+
+  /**
+    Try to acquire a writer (exclusive) lock without blocking.
+    @return true if the caller now holds a writer lock
+  */
+  bool trywrlock();
+
+  /**
+    Wait indefinitely to acquire a writer (exclusive) lock.
+    @return true if the caller now holds a writer lock
+  */
+  bool wrlock();
+
+  /**
+    Release a writer (exclusive) lock.
+  */
+  void wrunlock();
+
+private:
+  DistributedReaderWriterLock(const DistributedReaderWriterLock&);
+  DistributedReaderWriterLock& operator=(const DistributedReaderWriterLock&);
+
+private:
+  // A reader indicator on its own cache line.
+  struct ReaderSlot {
+    Atomic<void*> reader;
+    char pad[64 - sizeof(Atomic<void*>)];
+  };
+
+private:
+  // A per-thread address that identifies the reader in its slot.
+  static void* get_reader_id() {
+    return &reader_id;
+  }
+
+  ReaderSlot& get_reader_slot() {
+    if (reader_slot_i == 0) {
+      assign_reader_slot_i();
+    }
+    return reader_slots[reader_slot_i & reader_slot_mask];
+  }
+
+  static void assign_reader_slot_i();
+  bool rdlock_fast();
+  bool rdlock_slow(bool block);
+  void rdunlock_slow();
+  bool revoke_reader_bias(bool block);
+
+private:
+#ifdef _WIN32
+  static __declspec(thread) char reader_id;
+  static __declspec(thread) uint32_t reader_slot_i;
+#else
+  static __thread char reader_id;
+  static __thread uint32_t reader_slot_i;
+#endif
+
+private:
+  Atomic<bool> reader_biased;
+  Time reader_bias_inhibited_until;
+  ReaderSlot* reader_slots;
+  uint32_t reader_slot_mask;
+
+  // Central lock state, protected by the condition variable's mutex
+  ConditionVariable central;
+  uint32_t central_reader_count;
+  bool central_writer;
+  uint32_t central_waiting_writer_count;
+};
+}
+}
+
+#endif
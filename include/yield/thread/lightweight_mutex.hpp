@@ -30,10 +30,12 @@
 #ifndef _YIELD_THREAD_LIGHTWEIGHT_MUTEX_HPP_
 #define _YIELD_THREAD_LIGHTWEIGHT_MUTEX_HPP_
 
-#ifdef _WIN32
+#if defined(_WIN32)
 struct _RTL_CRITICAL_SECTION;
 typedef struct _RTL_CRITICAL_SECTION RTL_CRITICAL_SECTION;
 typedef RTL_CRITICAL_SECTION CRITICAL_SECTION;
+#elif defined(__linux__)
+#include "yield/atomic.hpp"
 #else
 #include "yield/thread/mutex.hpp"
 #endif
@@ -70,6 +72,80 @@ public:
 private:
   CRITICAL_SECTION* critical_section;
 };
+#elif defined(__linux__)
+/**
+  Lightweight mutex synchronization primitive.
+  An uncontended lock or unlock is a single atomic operation in user space.
+  Contended lockers spin for an adaptively-sized interval before sleeping
+    on a futex.
+*/
+class LightweightMutex {
+public:
+  LightweightMutex()
+    : spin_count(0), state(STATE_UNLOCKED)
+  { }
+
+public:
+  /**
+    Lock the mutex, blocking until acquisition.
+    @return true if the caller now holds the mutex
+  */
+  bool lock() {
+    uint32_t expected_state = STATE_UNLOCKED;
+    if (
+      !state.compare_exchange(
+        expected_state,
+        STATE_LOCKED,
+        MEMORY_ORDER_ACQUIRE
+      )
+    ) {
+      lock_contended();
+    }
+    return true;
+  }
+
+  /**
+    Try to lock the mutex, not blocking on failure.
+    @return true if the caller now holds the mutex
+  */
+  bool trylock() {
+    uint32_t expected_state = STATE_UNLOCKED;
+    return state.compare_exchange(
+             expected_state,
+             STATE_LOCKED,
+             MEMORY_ORDER_ACQUIRE
+           );
+  }
+
+  /**
+    Unlock the mutex.
+  */
+  void unlock() {
+    if (state.exchange(STATE_UNLOCKED, MEMORY_ORDER_RELEASE) == STATE_CONTENDED) {
+      unlock_contended();
+    }
+  }
+
+private:
+  LightweightMutex(const LightweightMutex&);
+  LightweightMutex& operator=(const LightweightMutex&);
+
+private:
+  void lock_contended();
+  void unlock_contended();
+
+private:
+  enum {
+    STATE_UNLOCKED = 0,
+    STATE_LOCKED = 1, // Locked, no sleeping waiters
+    STATE_CONTENDED = 2 // Locked, possibly with sleeping waiters
+  };
+
+  // Running average of the spins needed to acquire the mutex.
+  Atomic<uint32_t> spin_count;
+  // Futex word
+  Atomic<uint32_t> state;
+};
 #else
 typedef Mutex LightweightMutex;
 #endif
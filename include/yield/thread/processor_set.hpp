@@ -68,13 +68,11 @@ public:
     uint16_t count = 0;
 
     for (
-      uint16_t processor_i = 0;
-      processor_i < UINT16_MAX;
-      processor_i++
+      ssize_t processor_i = find_next(0);
+      processor_i != -1;
+      processor_i = find_next(static_cast<uint16_t>(processor_i + 1))
     ) {
-      if (isset(processor_i)) {
-        count++;
-      }
+      count++;
     }
 
     return count;
@@ -85,9 +83,18 @@ public:
     @return true if the processor set is empty
   */
   bool empty() const {
-    return count() == 0;
+    return find_next(0) == -1;
   }
 
+  /**
+    Find the lowest set bit at or after an index.
+    Only the bits the platform's set can hold are examined, so iterating
+      with find_next is cheaper than probing every index with isset.
+    @param processor_i index of the bit to start at
+    @return the index of the set bit, or -1 if there is none
+  */
+  ssize_t find_next(uint16_t processor_i) const;
+
 public:
   /**
     Query the system for the number of logical processors currently online.
@@ -96,7 +103,10 @@ public:
   static uint16_t get_online_logical_processor_count();
 
   /**
-    Query the system for the number of logical processors currently online.
+    Query the system for the number of physical processors (cores)
+      currently online.
+    See ProcessorTopology for the processors that make up each core.
+    On Linux the count is taken once, on the first call.
     @return the number of physical processors currently online
   */
   static uint16_t get_online_physical_processor_count();
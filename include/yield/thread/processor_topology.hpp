@@ -0,0 +1,145 @@
+// yield/thread/processor_topology.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_THREAD_PROCESSOR_TOPOLOGY_HPP_
+#define _YIELD_THREAD_PROCESSOR_TOPOLOGY_HPP_
+
+#include "yield/types.hpp"
+
+namespace yield {
+namespace thread {
+class ProcessorSet;
+
+/**
+  The layout of the system's online logical processors: which share a
+    physical core (SMT siblings), a cache, a package (socket) or a NUMA node.
+  Each grouping is a list of disjoint ProcessorSets ordered by their lowest
+    logical processor (NUMA nodes by node id).
+  On Linux the topology is read from /sys/devices/system/cpu and
+    /sys/devices/system/node. Elsewhere every logical processor is treated
+    as its own core in a single package and NUMA node, with no shared caches.
+*/
+class ProcessorTopology {
+public:
+  /**
+    Query the system for the topology of its online logical processors.
+  */
+  ProcessorTopology();
+
+  ~ProcessorTopology();
+
+public:
+  /**
+    Get the sets of logical processors that share a cache at a given level,
+      e.g. 2 for L2 or 3 for L3.
+    @param level the cache level
+    @return one set per cache at level, or an empty list if the level
+      is unknown
+  */
+  const vector<ProcessorSet*>& get_caches(uint8_t level) const;
+
+  /**
+    Get the sets of logical processors that share a physical core.
+    @return one set of SMT siblings per physical core
+  */
+  const vector<ProcessorSet*>& get_cores() const {
+    return cores;
+  }
+
+  /**
+    Get the sets of logical processors on each NUMA node that has processors.
+    @return one set per NUMA node, parallel to get_numa_node_ids
+  */
+  const vector<ProcessorSet*>& get_numa_nodes() const {
+    return numa_nodes;
+  }
+
+  /**
+    Get the system's identifiers for the NUMA nodes returned by
+      get_numa_nodes, e.g. for passing to memory policy calls.
+    @return one NUMA node id per set in get_numa_nodes
+  */
+  const vector<uint16_t>& get_numa_node_ids() const {
+    return numa_node_ids;
+  }
+
+  /**
+    Get the set of all online logical processors.
+    @return the set of all online logical processors
+  */
+  const ProcessorSet& get_online_logical_processors() const {
+    return *online_logical_processors;
+  }
+
+  /**
+    Get the sets of logical processors that share a package (socket).
+    @return one set per package
+  */
+  const vector<ProcessorSet*>& get_packages() const {
+    return packages;
+  }
+
+public:
+  /**
+    Count the physical cores of the system's online logical processors,
+      as in get_cores, without querying the rest of the topology.
+    @return the number of online physical cores
+  */
+  static uint16_t count_cores();
+
+  /**
+    Find the set in a grouping that contains a logical processor, e.g.
+      the L3 cache or NUMA node of a processor.
+    @param sets a grouping returned by one of the get_ methods
+    @param logical_processor_i the logical processor to look for
+    @return the index of the set containing logical_processor_i in sets,
+      or -1 if no set contains it
+  */
+  static ssize_t
+  find(
+    const vector<ProcessorSet*>& sets,
+    uint16_t logical_processor_i
+  );
+
+private:
+  ProcessorTopology(const ProcessorTopology&);
+  ProcessorTopology& operator=(const ProcessorTopology&);
+
+private:
+  vector< vector<ProcessorSet*> > caches; // Indexed by level - 1
+  vector<ProcessorSet*> cores;
+  vector<uint16_t> numa_node_ids;
+  vector<ProcessorSet*> numa_nodes;
+  ProcessorSet* online_logical_processors;
+  vector<ProcessorSet*> packages;
+};
+}
+}
+
+#endif
@@ -32,7 +32,9 @@
 
 #include "yield/config.hpp"
 
-#if defined(__MACH__)
+#if defined(__linux__)
+#include "yield/atomic.hpp"
+#elif defined(__MACH__)
 #include <mach/semaphore.h>
 #elif !defined(_WIN32)
 #include <semaphore.h>
@@ -93,7 +95,11 @@ private:
   Semaphore(void* hSemaphore);
 
 private:
-#if defined(__MACH__)
+#if defined(__linux__)
+  // Futex word
+  Atomic<uint32_t> count;
+  Atomic<uint32_t> waiter_count;
+#elif defined(__MACH__)
   semaphore_t sem;
 #elif defined(_WIN32)
   void* hSemaphore;
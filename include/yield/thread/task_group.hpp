@@ -0,0 +1,144 @@
+// yield/thread/task_group.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_THREAD_TASK_GROUP_HPP_
+#define _YIELD_THREAD_TASK_GROUP_HPP_
+
+#include "yield/atomic.hpp"
+#include "yield/thread/condition_variable.hpp"
+#include "yield/thread/runnable.hpp"
+
+#include <type_traits>
+
+namespace yield {
+namespace thread {
+class ThreadPool;
+
+/**
+  A set of tasks run on a ThreadPool that can be waited on as a unit.
+  Tasks may add further tasks to their own group while they run.
+*/
+class TaskGroup {
+public:
+  /**
+    Construct an empty task group.
+    @param thread_pool the pool on which to run the group's tasks
+  */
+  TaskGroup(ThreadPool& thread_pool);
+
+  /**
+    Wait for outstanding tasks and destroy the task group.
+  */
+  ~TaskGroup();
+
+public:
+  /**
+    Run a task as part of this group.
+    @param task the task to run
+  */
+  void run(YO_NEW_REF Runnable& task);
+
+  /**
+    Run a function object as part of this group.
+    @param function a copyable function object taking no arguments
+  */
+  template <class FunctionType>
+  typename std::enable_if<!std::is_base_of<Runnable, FunctionType>::value>::type
+  run(FunctionType function) {
+    submit(*new FunctionTask<FunctionType>(*this, function));
+  }
+
+public:
+  /**
+    Wait until every task run in this group has finished.
+    The caller's thread executes pending tasks of the pool while it waits,
+      so wait may be called from within a task.
+  */
+  void wait();
+
+private:
+  class Task : public Runnable {
+  public:
+    Task(TaskGroup& task_group)
+      : task_group(task_group)
+    { }
+
+    // yield::thread::Runnable
+    void run() {
+      execute();
+      task_group.finish();
+    }
+
+  protected:
+    virtual void execute() = 0;
+
+  private:
+    TaskGroup& task_group;
+  };
+
+  template <class FunctionType>
+  class FunctionTask : public Task {
+  public:
+    FunctionTask(TaskGroup& task_group, FunctionType function)
+      : Task(task_group), function(function)
+    { }
+
+  protected:
+    // Task
+    void execute() {
+      function();
+    }
+
+  private:
+    FunctionType function;
+  };
+
+  class RunnableTask;
+
+private:
+  TaskGroup(const TaskGroup&);
+  TaskGroup& operator=(const TaskGroup&);
+
+private:
+  void finish();
+  void submit(YO_NEW_REF Task& task);
+
+private:
+  ConditionVariable finished;
+  // Tasks between decrementing pending_task_count and their last access
+  // to the group, which wait must outlast.
+  Atomic<uint32_t> finishing_task_count;
+  Atomic<uint32_t> pending_task_count;
+  ThreadPool& thread_pool;
+};
+}
+}
+
+#endif
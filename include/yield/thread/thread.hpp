@@ -118,8 +118,11 @@ public:
 
 public:
   /**
-    Wrap the caller's thread in a Thread object.
-    @return the caller's Thread
+    Get the caller's thread as a Thread object.
+    Threads started by Thread return their own Thread. Other threads get
+      a Thread that is created on the first call and cached until the
+      thread exits, so repeated calls do not allocate.
+    @return a new reference to the caller's Thread
   */
   static auto_Object<Thread> self();
 
@@ -193,6 +196,7 @@ private:
   unsigned long id;
 #else
   pthread_t pthread;
+  bool joined;
 #if defined(__linux__)
   pid_t tid;
 #elif defined(__sun)
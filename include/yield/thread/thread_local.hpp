@@ -0,0 +1,137 @@
+// yield/thread/thread_local.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_THREAD_THREAD_LOCAL_HPP_
+#define _YIELD_THREAD_THREAD_LOCAL_HPP_
+
+#include "yield/types.hpp"
+
+namespace yield {
+namespace thread {
+/**
+  An untyped thread-local storage key, the basis of ThreadLocal.
+  Unlike Thread::key_create keys, ThreadLocalKeys are not a scarce system
+    resource, and a get is a few loads from native (__thread) storage
+    rather than a library call.
+  Each thread holds an array of values indexed by key. Key indices are recycled
+    with a new generation number, so a value set under a deleted key is never
+    seen by a later key with the same index.
+*/
+class ThreadLocalKey {
+public:
+  /**
+    Allocate a new key, which has a NULL value in every thread.
+  */
+  ThreadLocalKey();
+
+  /**
+    Free the key for reuse.
+    Values set under the key are not deleted.
+  */
+  ~ThreadLocalKey();
+
+public:
+  /**
+    Get the caller's value for this key.
+    @return the caller's value for this key, or NULL if none was set
+  */
+  void* get() const {
+    if (index < slot_count && slots[index].generation == generation) {
+      return slots[index].value;
+    } else {
+      return NULL;
+    }
+  }
+
+public:
+  /**
+    Set the caller's value for this key.
+    @param value the new value
+  */
+  void set(void* value);
+
+private:
+  ThreadLocalKey(const ThreadLocalKey&);
+  ThreadLocalKey& operator=(const ThreadLocalKey&);
+
+private:
+  friend class ThreadLocalSlots;
+
+  struct Slot {
+    uint32_t generation;
+    void* value;
+  };
+
+  // Trivially-initialized so that access does not go through a TLS wrapper.
+#ifdef _WIN32
+  static __declspec(thread) Slot* slots;
+  static __declspec(thread) uint32_t slot_count;
+#else
+  static __thread Slot* slots;
+  static __thread uint32_t slot_count;
+#endif
+
+private:
+  uint32_t generation;
+  uint32_t index;
+};
+
+
+/**
+  A typed, per-instance thread-local pointer.
+  Each thread sees its own value for each ThreadLocal, initially NULL.
+  The ThreadLocal does not own its values; the caller is responsible for
+    deleting them.
+*/
+template <class ValueType>
+class ThreadLocal {
+public:
+  /**
+    Get the caller's value.
+    @return the caller's value, or NULL if none was set
+  */
+  ValueType* get() const {
+    return static_cast<ValueType*>(key.get());
+  }
+
+  /**
+    Set the caller's value.
+    @param value the new value
+  */
+  void set(ValueType* value) {
+    key.set(value);
+  }
+
+private:
+  ThreadLocalKey key;
+};
+}
+}
+
+#endif
@@ -0,0 +1,244 @@
+// yield/thread/thread_pool.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_THREAD_THREAD_POOL_HPP_
+#define _YIELD_THREAD_THREAD_POOL_HPP_
+
+#include "yield/atomic.hpp"
+#include "yield/queue/work_stealing_deque.hpp"
+#include "yield/thread/condition_variable.hpp"
+#include "yield/thread/lightweight_mutex.hpp"
+#include "yield/thread/runnable.hpp"
+#include "yield/thread/task_group.hpp"
+#include "yield/thread/thread_local.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace yield {
+namespace thread {
+class ProcessorSet;
+class Thread;
+
+/**
+  A pool of worker threads for running many small tasks.
+  Each worker owns a work-stealing deque: tasks submitted from a worker go
+    onto its own deque, tasks submitted from other threads go onto a shared
+    queue, and idle workers steal from each other before going to sleep.
+*/
+class ThreadPool : public Object {
+public:
+  /**
+    Construct and start a pool of worker threads.
+    @param thread_count number of worker threads; 0 for one per processor in
+      logical_processor_set or, if that is NULL, one per online logical
+      processor
+    @param logical_processor_set optional set of logical processors to bind
+      the workers to, one processor per worker in round-robin order
+  */
+  ThreadPool(
+    uint16_t thread_count = 0,
+    const ProcessorSet* logical_processor_set = NULL
+  );
+
+  /**
+    Stop and destroy the worker threads.
+    Tasks that have not started by then are discarded without being run.
+  */
+  ~ThreadPool();
+
+public:
+  /**
+    Get the number of worker threads in the pool.
+    @return the number of worker threads in the pool
+  */
+  uint16_t get_thread_count() const {
+    return static_cast<uint16_t>(workers.size());
+  }
+
+public:
+  /**
+    Call function(range_begin, range_end) in parallel over subranges of
+      [begin, end) no larger than grain_size, returning when all calls have
+      finished.
+    The range is split recursively so that idle workers steal large halves.
+    @param begin first index of the range
+    @param end one past the last index of the range
+    @param grain_size maximum number of indices passed to a single call
+    @param function function object taking (size_t, size_t)
+  */
+  template <class FunctionType>
+  void
+  parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    const FunctionType& function
+  ) {
+    if (begin < end) {
+      TaskGroup task_group(*this);
+      parallel_for(
+        task_group,
+        begin,
+        end,
+        grain_size > 0 ? grain_size : 1,
+        function
+      );
+      task_group.wait();
+    }
+  }
+
+  /**
+    Map subranges of [begin, end) no larger than grain_size to values in
+      parallel and reduce them to a single value.
+    Subrange values are reduced in index order, so reduce_function need only
+      be associative.
+    @param begin first index of the range
+    @param end one past the last index of the range
+    @param grain_size maximum number of indices passed to a single map call
+    @param identity the identity value of reduce_function
+    @param map_function function object taking (size_t, size_t) and
+      returning a ValueType
+    @param reduce_function function object taking two ValueTypes and
+      returning their reduction
+    @return the reduction of all subrange values, or identity if the range
+      is empty
+  */
+  template <class ValueType, class MapFunctionType, class ReduceFunctionType>
+  ValueType
+  parallel_reduce(
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    const ValueType& identity,
+    const MapFunctionType& map_function,
+    const ReduceFunctionType& reduce_function
+  ) {
+    if (grain_size == 0) {
+      grain_size = 1;
+    }
+
+    size_t chunk_count = begin < end ? (end - begin - 1) / grain_size + 1 : 0;
+    std::vector<ValueType> chunk_values(chunk_count, identity);
+
+    parallel_for(
+      0,
+      chunk_count,
+      1,
+      [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t chunk_i = chunk_begin; chunk_i < chunk_end; chunk_i++) {
+          size_t range_begin = begin + chunk_i * grain_size;
+          size_t range_end
+            = end - range_begin > grain_size ? range_begin + grain_size : end;
+          chunk_values[chunk_i] = map_function(range_begin, range_end);
+        }
+      }
+    );
+
+    ValueType value = identity;
+    for (size_t chunk_i = 0; chunk_i < chunk_count; chunk_i++) {
+      value = reduce_function(value, chunk_values[chunk_i]);
+    }
+    return value;
+  }
+
+public:
+  /**
+    Run one pending task on the caller's thread, if one can be found.
+    @return true if a task was run
+  */
+  bool run_one();
+
+public:
+  /**
+    Submit a task to be run by a worker thread.
+    @param task the task to run
+  */
+  void submit(YO_NEW_REF Runnable& task);
+
+public:
+  // yield::Object
+  ThreadPool& inc_ref() {
+    return Object::inc_ref(*this);
+  }
+
+private:
+  class Worker;
+
+private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+private:
+  template <class FunctionType>
+  static void
+  parallel_for(
+    TaskGroup& task_group,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    const FunctionType& function
+  ) {
+    // Hand off the upper half until the range fits in a grain, so that the
+    // oldest (largest) pieces are the ones left for thieves.
+    while (end - begin > grain_size) {
+      size_t middle = begin + (end - begin) / 2;
+      task_group.run(
+        [&task_group, middle, end, grain_size, &function]() {
+          parallel_for(task_group, middle, end, grain_size, function);
+        }
+      );
+      end = middle;
+    }
+
+    function(begin, end);
+  }
+
+private:
+  Worker* get_current_worker() const;
+  Runnable* get_task(Worker* worker);
+  void run_worker(Worker& worker);
+  void wake();
+
+private:
+  ThreadLocal<Worker> current_worker;
+  ConditionVariable idle;
+  std::deque<Runnable*> injected_tasks;
+  Atomic<size_t> injected_task_count;
+  LightweightMutex injected_tasks_lock;
+  Atomic<bool> running;
+  Atomic<uint16_t> sleeping_worker_count;
+  std::vector<Thread*> threads;
+  std::vector<Worker*> workers;
+};
+}
+}
+
+#endif
@@ -115,9 +115,35 @@ public:
   }
 
   /**
-    Retrieve the current time. This is not guaranteed to have a specific
-      reference time (e.g., the Unix epoch), but may be based on cycle counts
-      or or similar.
+    Retrieve the current time from a monotonic clock that is updated at
+      a coarse granularity (a few milliseconds on Linux), but is much
+      cheaper to read than monotonic_now().
+    Use for per-event bookkeeping (e.g., last activity times) where
+      millisecond precision is enough.
+    Approximately shares its reference time with monotonic_now().
+    @return the current coarse monotonic time
+  */
+  static Time coarse_monotonic_now();
+
+  /**
+    Retrieve the current time from a monotonic clock, which is not affected
+      by changes to the system's wall clock.
+    The reference time is arbitrary (e.g., system boot), so the result
+      is only meaningful relative to other monotonic times. Use it for all
+      timeout and latency arithmetic.
+    On x86-64 Linux with an invariant TSC that the kernel also uses as its
+      clocksource, the clock is read from the TSC, calibrated against
+      CLOCK_MONOTONIC on first use.
+    @return the current monotonic time
+  */
+  static Time monotonic_now();
+
+  /**
+    Retrieve the current wall clock (real) time. The reference time is
+      platform-specific, and the clock can jump when the system time is set.
+    Use only where an absolute real time is required, e.g., for
+      deadlines passed to pthread_cond_timedwait or sem_timedwait;
+      measure intervals with monotonic_now().
     @return the current time
   */
   static Time now();
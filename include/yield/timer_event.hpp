@@ -0,0 +1,139 @@
+// yield/timer_event.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_TIMER_EVENT_HPP_
+#define _YIELD_TIMER_EVENT_HPP_
+
+#include "yield/event.hpp"
+#include "yield/time.hpp"
+
+namespace yield {
+class TimerWheel;
+
+/**
+  Event subclass that is delivered when a timeout elapses.
+  A TimerEvent is armed on a TimerWheel (or on an EventQueue that embeds one,
+    such as FDEventQueue), which delivers it once its timeout has elapsed
+    and, if it has a period, again after every period thereafter.
+  Subclass TimerEvent to carry context for the timer's handler.
+*/
+class TimerEvent : public Event {
+public:
+  const static uint32_t TYPE_ID = 2909408421UL;
+
+public:
+  /**
+    Construct a TimerEvent.
+    @param timeout time from arming until the first delivery
+    @param period time between subsequent deliveries, or 0 for a
+      one-shot timer
+  */
+  TimerEvent(
+    const Time& timeout,
+    const Time& period = static_cast<uint64_t>(0)
+  )
+    : deadline(static_cast<uint64_t>(0)),
+      expires_tick(0),
+      next(NULL),
+      period(period),
+      prev(NULL),
+      slot(NULL),
+      timeout(timeout)
+  { }
+
+  /**
+    Empty virtual destructor.
+  */
+  virtual ~TimerEvent() { }
+
+public:
+  /**
+    Get the Time::monotonic_now() time at which this TimerEvent is or
+      was next due.
+    Only meaningful once the TimerEvent has been armed.
+    @return the deadline of this TimerEvent
+  */
+  const Time& get_deadline() const {
+    return deadline;
+  }
+
+  /**
+    Get the time between deliveries of a periodic TimerEvent.
+    @return the period of this TimerEvent, or 0 if it is a one-shot timer
+  */
+  const Time& get_period() const {
+    return period;
+  }
+
+  /**
+    Get the time from arming until the first delivery of this TimerEvent.
+    @return the timeout of this TimerEvent
+  */
+  const Time& get_timeout() const {
+    return timeout;
+  }
+
+  /**
+    Check whether this TimerEvent is armed, i.e. held by a TimerWheel
+      that has yet to deliver it.
+    @return true if this TimerEvent is armed
+  */
+  bool is_armed() const {
+    return slot != NULL;
+  }
+
+public:
+  // yield::Object
+  virtual uint32_t get_type_id() const {
+    return TYPE_ID;
+  }
+
+  virtual const char* get_type_name() const {
+    return "yield::TimerEvent";
+  }
+
+  TimerEvent& inc_ref() {
+    return Object::inc_ref(*this);
+  }
+
+private:
+  friend class TimerWheel;
+
+  Time deadline;
+  uint64_t expires_tick;
+  // Intrusive links in a TimerWheel slot, so arm and cancel are O(1).
+  TimerEvent* next;
+  Time period;
+  TimerEvent* prev;
+  TimerEvent** slot;
+  Time timeout;
+};
+}
+
+#endif
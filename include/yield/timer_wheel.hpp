@@ -0,0 +1,169 @@
+// yield/timer_wheel.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _YIELD_TIMER_WHEEL_HPP_
+#define _YIELD_TIMER_WHEEL_HPP_
+
+#include "yield/timer_event.hpp"
+
+namespace yield {
+class EventHandler;
+
+/**
+  Hierarchical timing wheel for TimerEvents.
+  Time is divided into ticks of a fixed resolution. Timers due within
+    SLOT_COUNT ticks sit in the innermost wheel; timers further out sit in
+    coarser outer wheels and cascade inwards as time advances. Arming and
+    canceling a timer are O(1), as is finding the next tick with work.
+  A TimerWheel is not thread-safe: it should be owned and driven by a single
+    event loop thread, which arms and cancels timers and periodically calls
+    expire with the current Time::monotonic_now().
+  Timers are never delivered early, and late by at most one tick plus
+    however long the owning thread takes to call expire.
+*/
+class TimerWheel {
+public:
+  /**
+    Construct a TimerWheel.
+    @param resolution the length of a tick
+  */
+  TimerWheel(const Time& resolution = Time(Time::NS_IN_MS));
+
+  /**
+    Destroy a TimerWheel, releasing its references to any armed TimerEvents.
+  */
+  ~TimerWheel();
+
+public:
+  /**
+    Arm a TimerEvent to be due its timeout from now.
+    If the TimerEvent is already armed on this TimerWheel it is moved to its
+      new deadline, and the reference held for its previous arming is
+      released.
+    A TimerEvent may only be armed on one TimerWheel at a time.
+    @param timer_event the TimerEvent to arm
+  */
+  void arm(YO_NEW_REF TimerEvent& timer_event);
+
+  /**
+    Cancel an armed TimerEvent, releasing the TimerWheel's reference to it.
+    @param timer_event the TimerEvent to cancel
+    @return true if the TimerEvent was armed on this TimerWheel
+  */
+  bool cancel(TimerEvent& timer_event);
+
+  /**
+    Check whether no TimerEvents are armed on this TimerWheel.
+    @return true if no TimerEvents are armed
+  */
+  bool empty() const {
+    return armed_timer_count == 0;
+  }
+
+  /**
+    Dequeue the next TimerEvent that is due as of now.
+    Periodic TimerEvents are re-armed for their next deadline before being
+      returned, and keep their place on the TimerWheel.
+    @param now the current Time::monotonic_now()
+    @return a new reference to a due TimerEvent, or NULL if none are due
+  */
+  YO_NEW_REF TimerEvent* expire(const Time& now);
+
+  /**
+    Deliver every TimerEvent that is due as of now to an EventHandler,
+      such as a Stage.
+    @param now the current Time::monotonic_now()
+    @param event_handler the EventHandler to deliver due TimerEvents to
+    @return the number of TimerEvents delivered
+  */
+  size_t expire(const Time& now, EventHandler& event_handler);
+
+  /**
+    Get the number of TimerEvents armed on this TimerWheel.
+    @return the number of armed TimerEvents
+  */
+  size_t get_armed_timer_count() const {
+    return armed_timer_count;
+  }
+
+  /**
+    Get the time from now until the TimerWheel next has work to do,
+      suitable as a poll() timeout.
+    This may be the deadline of the next due TimerEvent or the earlier
+      cascade of an outer wheel, in which case expire returns nothing.
+    @param now the current Time::monotonic_now()
+    @return the time until the next call to expire is needed,
+      or Time::FOREVER if no TimerEvents are armed
+  */
+  Time get_next_timeout(const Time& now) const;
+
+public:
+  /**
+    Constant: number of bits of the tick consumed by each wheel.
+  */
+  const static uint8_t SLOT_BITS = 6;
+
+  /**
+    Constant: number of slots in each wheel.
+  */
+  const static size_t SLOT_COUNT = 1 << SLOT_BITS;
+
+  /**
+    Constant: number of wheels. Timers further than
+      SLOT_COUNT ^ WHEEL_COUNT ticks out wait in the outermost wheel
+      until they come into range.
+  */
+  const static uint8_t WHEEL_COUNT = 6;
+
+private:
+  TimerWheel(const TimerWheel&);
+  TimerWheel& operator=(const TimerWheel&);
+
+private:
+  void advance(uint64_t now_tick);
+  void cascade(uint8_t wheel_i, size_t slot_i);
+  uint64_t get_next_tick() const;
+  uint64_t get_tick(const Time& time) const;
+  void link(TimerEvent& timer_event);
+  void link(TimerEvent& timer_event, TimerEvent** slot);
+  void unlink(TimerEvent& timer_event);
+
+private:
+  size_t armed_timer_count;
+  Time base_time;
+  // Next tick to process: every tick before it has been expired.
+  uint64_t current_tick;
+  TimerEvent* expired_timers;
+  uint64_t occupied_slots[WHEEL_COUNT];
+  Time resolution;
+  TimerEvent* slots[WHEEL_COUNT][SLOT_COUNT];
+};
+}
+
+#endif
@@ -28,12 +28,14 @@
 // THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "yield/buffer.hpp"
+#include "yield/numa_allocator.hpp"
 
 #ifdef _WIN32
 #include <Windows.h>
 #else
 #include <ostream>
 #include <stdlib.h>
+#include <unistd.h> // For getpagesize
 #endif
 
 namespace yield {
@@ -58,21 +60,35 @@ Buffer::Buffer(size_t alignment, size_t capacity) {
 Buffer::Buffer(size_t capacity, void* data, size_t size)
   : capacity_(capacity),
     data_(data),
+    numa_local(false),
     size_(size) {
   next_buffer = NULL;
 }
 
 Buffer::~Buffer() {
+  if (numa_local) {
+    NUMAAllocator::deallocate(data_);
+  } else {
 #ifdef _WIN32
-  _aligned_free(data_);
+    _aligned_free(data_);
 #else
-  free(data_);
+    free(data_);
 #endif
+  }
   Buffer::dec_ref(next_buffer);
 }
 
 void Buffer::alloc(size_t alignment, size_t capacity) {
   capacity_ = capacity;
+
+  // Single-node systems keep the plain heap; there is nothing to gain
+  // from the NUMAAllocator's block header there.
+  numa_local = NUMAAllocator::get_numa_node_count() > 1;
+  if (numa_local) {
+    data_ = NUMAAllocator::allocate(capacity_, alignment);
+    return;
+  }
+
 #ifdef _WIN32
   if ((data_ = _aligned_malloc(capacity_, alignment)) == NULL)
 #else
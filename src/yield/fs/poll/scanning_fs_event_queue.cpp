@@ -95,7 +95,7 @@ YO_NEW_REF Event* ScanningFSEventQueue::timeddequeue(const Time& timeout) {
         watch_i != watches->end();
         ++watch_i
       ) {
-        Time start_time = Time::now();
+        Time start_time = Time::monotonic_now();
 
         watch_i->second->scan(event_queue);
         event = event_queue.trydequeue();
@@ -103,7 +103,7 @@ YO_NEW_REF Event* ScanningFSEventQueue::timeddequeue(const Time& timeout) {
           return event;
         }
 
-        Time elapsed_time = Time::now() - start_time;
+        Time elapsed_time = Time::monotonic_now() - start_time;
         if (elapsed_time < timeout_remaining) {
           timeout_remaining -= elapsed_time;
         } else {
@@ -51,7 +51,7 @@ HTTPMessage<HTTPMessageType>::HTTPMessage(
   YO_NEW_REF Object* body,
   uint8_t http_version
 ) : body(body),
-  header(*new Buffer(Buffer::getpagesize(), Buffer::getpagesize())),
+  header(new Buffer(Buffer::getpagesize(), Buffer::getpagesize())),
   http_version(http_version) {
   fields_offset = 0;
 }
@@ -65,7 +65,7 @@ HTTPMessage(
   uint8_t http_version
 ) : body(body),
   fields_offset(fields_offset),
-  header(header.inc_ref()),
+  header(&header.inc_ref()),
   http_version(http_version) {
 }
 
@@ -77,15 +77,15 @@ HTTPMessage<HTTPMessageType>::~HTTPMessage() {
 
 template <class HTTPMessageType>
 void HTTPMessage<HTTPMessageType>::finalize() {
-  header.put("\r\n", 2);
+  header->put("\r\n", 2);
 }
 
 template <class HTTPMessageType>
 size_t HTTPMessage<HTTPMessageType>::get_content_length() const {
   size_t content_length = 0;
   HTTPMessageParser::parse_content_length_field(
-    static_cast<const char*>(header) + fields_offset,
-    static_cast<const char*>(header) + header.size(),
+    static_cast<const char*>(*header) + fields_offset,
+    static_cast<const char*>(*header) + header->size(),
     content_length
   );
   return content_length;
@@ -112,8 +112,8 @@ HTTPMessage<HTTPMessageType>::get_field(
   name_iov.iov_base = const_cast<char*>(name);
   name_iov.iov_len = name_len;
   return HTTPMessageParser::parse_field(
-           static_cast<const char*>(header) + fields_offset,
-           static_cast<const char*>(header) + header.size(),
+           static_cast<const char*>(*header) + fields_offset,
+           static_cast<const char*>(*header) + header->size(),
            name_iov,
            value
          );
@@ -125,8 +125,8 @@ HTTPMessage<HTTPMessageType>::get_fields(
   vector< std::pair<iovec, iovec> >& fields
 ) const {
   return HTTPMessageParser::parse_fields(
-           static_cast<const char*>(header) + fields_offset,
-           static_cast<const char*>(header) + header.size(),
+           static_cast<const char*>(*header) + fields_offset,
+           static_cast<const char*>(*header) + header->size(),
            fields
          );
 }
@@ -228,10 +228,10 @@ set_field(
   debug_assert_gt(name_len, 0);
   debug_assert_gt(value_len, 0);
 
-  header.put(name, name_len);
-  header.put(": ", 2);
-  header.put(value, value_len);
-  header.put("\r\n");
+  header->put(name, name_len);
+  header->put(": ", 2);
+  header->put(value, value_len);
+  header->put("\r\n");
 
   return static_cast<HTTPMessageType&>(*this);
 }
@@ -37,6 +37,7 @@ namespace yield {
 namespace http {
 namespace server {
 using yield::fs::File;
+using yield::sockets::Socket;
 using yield::sockets::SocketAddress;
 using yield::sockets::TCPSocket;
 using yield::sockets::aio::acceptAIOCB;
@@ -44,6 +45,43 @@ using yield::sockets::aio::recvAIOCB;
 using yield::sockets::aio::sendAIOCB;
 using yield::sockets::aio::sendfileAIOCB;
 
+// Bounds on the adaptive capacity of a connection's recv buffers.
+const static size_t RECV_BUFFER_CAPACITY_MAX = 64 * 1024;
+const static size_t RECV_BUFFER_CAPACITY_MIN = 1024;
+
+// The AIO queue driven by the current thread, if any.
+#ifdef _WIN32
+static __declspec(thread) EventQueue* current_aio_queue = NULL;
+#else
+static __thread EventQueue* current_aio_queue = NULL;
+#endif
+
+HTTPConnection::RespondEvent::RespondEvent(
+  HTTPConnection& connection,
+  uint32_t request_sequence_number,
+  YO_NEW_REF ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk
+) : connection(connection.inc_ref()),
+  http_message_body_chunk(&http_message_body_chunk),
+  http_response(NULL),
+  request_sequence_number(request_sequence_number) {
+}
+
+HTTPConnection::RespondEvent::RespondEvent(
+  HTTPConnection& connection,
+  uint32_t request_sequence_number,
+  YO_NEW_REF ::yield::http::HTTPResponse& http_response
+) : connection(connection.inc_ref()),
+  http_message_body_chunk(NULL),
+  http_response(&http_response),
+  request_sequence_number(request_sequence_number) {
+}
+
+HTTPConnection::RespondEvent::~RespondEvent() {
+  HTTPConnection::dec_ref(connection);
+  HTTPMessageBodyChunk::dec_ref(http_message_body_chunk);
+  HTTPResponse::dec_ref(http_response);
+}
+
 HTTPConnection::HTTPConnection(
   EventQueue& aio_queue,
   EventHandler& http_request_handler,
@@ -52,19 +90,48 @@ HTTPConnection::HTTPConnection(
   Log* log
 ) : aio_queue(aio_queue.inc_ref()),
   http_request_handler(http_request_handler.inc_ref()),
+  last_activity_time(Time::coarse_monotonic_now()),
   log(Object::inc_ref(log)),
+  next_request_sequence_number(0),
+  next_connection(NULL),
   peername(peername.inc_ref()),
+  prev_connection(NULL),
+  recv_buffer_capacity(Buffer::getpagesize()),
+  recv_buffer_lazy(false),
+  response_sequence_number(0),
   socket_(static_cast<TCPSocket&>(socket_.inc_ref())) {
   state = STATE_CONNECTED;
 }
 
 HTTPConnection::~HTTPConnection() {
+  for (
+    vector<HeldResponse>::iterator held_response_i = held_responses.begin();
+    held_response_i != held_responses.end();
+    ++held_response_i
+  ) {
+    HTTPMessageBodyChunk::dec_ref(held_response_i->http_message_body_chunk);
+    HTTPResponse::dec_ref(held_response_i->http_response);
+  }
+
   EventQueue::dec_ref(aio_queue);
   EventHandler::dec_ref(http_request_handler);
   Log::dec_ref(log);
   TCPSocket::dec_ref(socket_);
 }
 
+void HTTPConnection::adapt_recv_buffer_capacity(const Buffer& recv_buffer) {
+  if (recv_buffer.size() == recv_buffer.capacity()) {
+    // A full read: more is probably waiting, e.g., a large request body.
+    if (recv_buffer_capacity < RECV_BUFFER_CAPACITY_MAX) {
+      recv_buffer_capacity *= 2;
+    }
+  } else if (recv_buffer.size() <= recv_buffer.capacity() / 4) {
+    if (recv_buffer_capacity > RECV_BUFFER_CAPACITY_MIN) {
+      recv_buffer_capacity /= 2;
+    }
+  }
+}
+
 void HTTPConnection::handle(YO_NEW_REF acceptAIOCB& accept_aiocb) {
   if (
     accept_aiocb.get_recv_buffer() != NULL
@@ -73,13 +140,7 @@ void HTTPConnection::handle(YO_NEW_REF acceptAIOCB& accept_aiocb) {
   ) {
     parse(*accept_aiocb.get_recv_buffer());
   } else {
-    Buffer* recv_buffer
-    = new Buffer(Buffer::getpagesize(), Buffer::getpagesize());
-    recvAIOCB* recv_aiocb = new recvAIOCB(socket_, *recv_buffer, 0, this);
-    if (!aio_queue.enqueue(*recv_aiocb)) {
-      recvAIOCB::dec_ref(*recv_aiocb);
-      state = STATE_ERROR;
-    }
+    recv();
   }
 
   acceptAIOCB::dec_ref(accept_aiocb);
@@ -94,6 +155,7 @@ HTTPConnection::handle(
     send_buffer = &http_message_body_chunk.data()->inc_ref();
   } else {
     send_buffer = &Buffer::copy("0\r\n\r\n", 5);
+    send_buffer->set_thread_confined(true);
   }
   HTTPMessageBodyChunk::dec_ref(http_message_body_chunk);
 
@@ -114,44 +176,64 @@ HTTPConnection::handle(
   }
 
   http_response.finalize();
-  Buffer& http_response_header = http_response.get_header().inc_ref();
-  Object* http_response_body = Object::inc_ref(http_response.get_body());
+  Buffer* http_response_header;
+  Object* http_response_body;
+  if (http_response.has_single_reference()) {
+    // Nothing else can see the response, so move its header and body out
+    // rather than referencing them.
+    http_response_header = &http_response.release_header();
+    http_response_body = http_response.release_body();
+  } else {
+    // The handler kept a reference, e.g. to log the response afterwards.
+    http_response_header = &http_response.get_header().inc_ref();
+    http_response_body = Object::inc_ref(http_response.get_body());
+  }
   HTTPResponse::dec_ref(http_response);
 
   if (http_response_body != NULL) {
     switch (http_response_body->get_type_id()) {
     case Buffer::TYPE_ID: {
-      http_response_header.set_next_buffer(
+      http_response_header->set_next_buffer(
         static_cast<Buffer*>(http_response_body)
       );
     }
     break;
 
     case File::TYPE_ID: {
+      File& file = *static_cast<File*>(http_response_body);
+      // The sendfileAIOCB sends from a duplicate of the file's descriptor.
+      sendfileAIOCB* sendfile_aiocb = new sendfileAIOCB(socket_, file, this);
+      File::dec_ref(file);
+
+      // Hold the header back until the file follows it, so that the header
+      // and a small file go out in the same segment.
       sendAIOCB* send_aiocb
-        = new sendAIOCB(socket_, http_response_header, 0, this);
+      = new sendAIOCB(
+          socket_,
+          *http_response_header,
+          sendfile_aiocb->get_nbytes() > 0 ? Socket::MessageFlags::MORE : 0,
+          this
+        );
       if (aio_queue.enqueue(*send_aiocb)) {
-        sendfileAIOCB* sendfile_aiocb
-        = new sendfileAIOCB(socket_, *static_cast<File*>(http_response_body), this);
-        if (aio_queue.enqueue(*sendfile_aiocb)) {
-          return;
-        } else {
+        if (!aio_queue.enqueue(*sendfile_aiocb)) {
           sendfileAIOCB::dec_ref(*sendfile_aiocb);
           state = STATE_ERROR;
         }
       } else {
         sendAIOCB::dec_ref(*send_aiocb);
+        sendfileAIOCB::dec_ref(*sendfile_aiocb);
         state = STATE_ERROR;
       }
     }
-    break;
+    return;
 
     default:
       debug_break();
     }
   }
 
-  sendAIOCB* send_aiocb = new sendAIOCB(socket_, http_response_header, 0, this);
+  sendAIOCB* send_aiocb
+  = new sendAIOCB(socket_, *http_response_header, 0, this);
   if (!aio_queue.enqueue(*send_aiocb)) {
     sendAIOCB::dec_ref(*send_aiocb);
     state = STATE_ERROR;
@@ -163,7 +245,20 @@ HTTPConnection::handle(
   YO_NEW_REF ::yield::sockets::aio::recvAIOCB& recv_aiocb
 ) {
   if (recv_aiocb.get_return() > 0) {
-    parse(recv_aiocb.get_buffer());
+    Buffer& recv_buffer = recv_aiocb.get_buffer();
+    // Continuation buffers from the parser are sized by the request and may
+    // be prefilled, so only the lazily-allocated buffers say how much the
+    // peer sends at once.
+    if (recv_buffer_lazy) {
+      adapt_recv_buffer_capacity(recv_buffer);
+    }
+    // recv_aiocb holds recv_buffer's only reference, and on this thread,
+    // so the count can be made atomic before parse shares the buffer.
+    recv_buffer.set_thread_confined(false);
+    parse(recv_buffer);
+  } else {
+    // The peer closed the connection, or the socket was shut down.
+    state = STATE_ERROR;
   }
 
   ::yield::sockets::aio::recvAIOCB::dec_ref(recv_aiocb);
@@ -183,8 +278,29 @@ HTTPConnection::handle(
   ::yield::sockets::aio::sendfileAIOCB::dec_ref(sendfile_aiocb);
 }
 
+void HTTPConnection::handle(YO_NEW_REF RespondEvent& respond_event) {
+  send(
+    respond_event.request_sequence_number,
+    respond_event.http_message_body_chunk,
+    respond_event.http_response
+  );
+  respond_event.http_message_body_chunk = NULL;
+  respond_event.http_response = NULL;
+
+  RespondEvent::dec_ref(respond_event);
+}
+
+void HTTPConnection::marshal(YO_NEW_REF RespondEvent& respond_event) {
+  // state belongs to the queue's thread, so a failure can't be recorded.
+  if (!aio_queue.enqueue(respond_event)) {
+    RespondEvent::dec_ref(respond_event);
+  }
+}
+
 void HTTPConnection::parse(Buffer& recv_buffer) {
   debug_assert_false(recv_buffer.empty());
+  // Parsed HTTPRequests share recv_buffer and may be handled on other threads.
+  debug_assert_false(recv_buffer.is_thread_confined());
 
   HTTPRequestParser http_request_parser(*this, recv_buffer);
 
@@ -194,10 +310,19 @@ void HTTPConnection::parse(Buffer& recv_buffer) {
     switch (object.get_type_id()) {
     case Buffer::TYPE_ID: {
       Buffer& next_recv_buffer = static_cast<Buffer&>(object);
-      recvAIOCB* recv_aiocb = new recvAIOCB(socket_, next_recv_buffer, 0, this);
-      if (!aio_queue.enqueue(*recv_aiocb)) {
-        recvAIOCB::dec_ref(*recv_aiocb);
-        state = STATE_ERROR;
+      if (next_recv_buffer.empty()) {
+        // Nothing left over: wait for the next request without a buffer.
+        Buffer::dec_ref(next_recv_buffer);
+        recv();
+      } else {
+        next_recv_buffer.set_thread_confined(true);
+        recv_buffer_lazy = false;
+        recvAIOCB* recv_aiocb
+        = new recvAIOCB(socket_, next_recv_buffer, 0, this);
+        if (!aio_queue.enqueue(*recv_aiocb)) {
+          recvAIOCB::dec_ref(*recv_aiocb);
+          state = STATE_ERROR;
+        }
       }
     }
     return;
@@ -210,6 +335,7 @@ void HTTPConnection::parse(Buffer& recv_buffer) {
                                            << ": parsed " << http_request;
       }
 
+      http_request.sequence_number = next_request_sequence_number++;
       http_request_handler.handle(http_request);
     }
     break;
@@ -223,7 +349,7 @@ void HTTPConnection::parse(Buffer& recv_buffer) {
                                            << ": parsed " << http_response;
       }
 
-      handle(http_response);
+      send(next_request_sequence_number++, NULL, &http_response);
       return;
     }
     break;
@@ -234,6 +360,115 @@ void HTTPConnection::parse(Buffer& recv_buffer) {
     }
   }
 }
+
+void HTTPConnection::recv() {
+  // The buffer is only allocated once a request arrives, so that idle
+  // keep-alive connections hold no receive memory.
+  recv_buffer_lazy = true;
+  recvAIOCB* recv_aiocb
+  = new recvAIOCB(socket_, recv_buffer_capacity, 0, this);
+  if (!aio_queue.enqueue(*recv_aiocb)) {
+    recvAIOCB::dec_ref(*recv_aiocb);
+    state = STATE_ERROR;
+  }
+}
+
+void
+HTTPConnection::respond(
+  const HTTPRequest& http_request,
+  YO_NEW_REF ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk
+) {
+  if (current_aio_queue == &aio_queue) {
+    send(http_request.sequence_number, &http_message_body_chunk, NULL);
+  } else {
+    marshal(
+      *new RespondEvent(
+        *this,
+        http_request.sequence_number,
+        http_message_body_chunk
+      )
+    );
+  }
+}
+
+void
+HTTPConnection::respond(
+  const HTTPRequest& http_request,
+  YO_NEW_REF ::yield::http::HTTPResponse& http_response
+) {
+  if (current_aio_queue == &aio_queue) {
+    send(http_request.sequence_number, NULL, &http_response);
+  } else {
+    marshal(
+      *new RespondEvent(*this, http_request.sequence_number, http_response)
+    );
+  }
+}
+
+void
+HTTPConnection::send(
+  uint32_t request_sequence_number,
+  YO_NEW_REF ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk,
+  YO_NEW_REF ::yield::http::HTTPResponse* http_response
+) {
+  if (request_sequence_number != response_sequence_number) {
+    // Pipelined requests may be handled out of order, but HTTP/1.1 requires
+    // their responses in order.
+    HeldResponse held_response;
+    held_response.request_sequence_number = request_sequence_number;
+    held_response.http_message_body_chunk = http_message_body_chunk;
+    held_response.http_response = http_response;
+    held_responses.push_back(held_response);
+    return;
+  }
+
+  if (!send(http_message_body_chunk, http_response)) {
+    return;
+  }
+
+  // The response is complete: send what's been held for the next requests.
+  ++response_sequence_number;
+  for (size_t held_response_i = 0; held_response_i < held_responses.size();) {
+    HeldResponse held_response = held_responses[held_response_i];
+    if (held_response.request_sequence_number == response_sequence_number) {
+      held_responses.erase(held_responses.begin() + held_response_i);
+      if (
+        send(
+          held_response.http_message_body_chunk,
+          held_response.http_response
+        )
+      ) {
+        ++response_sequence_number;
+        held_response_i = 0;
+      }
+    } else {
+      ++held_response_i;
+    }
+  }
+}
+
+bool
+HTTPConnection::send(
+  YO_NEW_REF ::yield::http::HTTPMessageBodyChunk* http_message_body_chunk,
+  YO_NEW_REF ::yield::http::HTTPResponse* http_response
+) {
+  if (http_response != NULL) {
+    // A chunked response continues until its last, empty chunk.
+    bool chunked
+    = http_response->get_content_length()
+      == HTTPResponse::CONTENT_LENGTH_CHUNKED;
+    handle(*http_response);
+    return !chunked;
+  } else {
+    bool last = http_message_body_chunk->data() == NULL;
+    handle(*http_message_body_chunk);
+    return last;
+  }
+}
+
+void HTTPConnection::set_current_aio_queue(EventQueue& aio_queue) {
+  current_aio_queue = &aio_queue;
+}
 }
 }
 }
@@ -43,7 +43,8 @@ HTTPRequest::HTTPRequest(
   uint8_t http_version
 ) : yield::http::HTTPRequest(method, uri, body, http_version),
     connection(connection.inc_ref()),
-    creation_date_time(DateTime::now()) {
+    creation_date_time(DateTime::now()),
+    sequence_number(0) {
 }
 
 HTTPRequest::HTTPRequest(
@@ -64,7 +65,8 @@ HTTPRequest::HTTPRequest(
     uri
   ),
   connection(connection.inc_ref()),
-  creation_date_time(DateTime::now()) {
+  creation_date_time(DateTime::now()),
+  sequence_number(0) {
 }
 
 HTTPRequest::~HTTPRequest() {
@@ -75,14 +77,21 @@ void
 HTTPRequest::respond(
   YO_NEW_REF ::yield::http::HTTPResponse& http_response
 ) {
-  connection.handle(http_response);
+  connection.respond(*this, http_response);
+}
+
+void
+HTTPRequest::respond(
+  auto_Object< ::yield::http::HTTPResponse >&& http_response
+) {
+  connection.respond(*this, *http_response.release());
 }
 
 void
 HTTPRequest::respond(
   ::yield::http::HTTPMessageBodyChunk& http_message_body_chunk
 ) {
-  connection.handle(http_message_body_chunk);
+  connection.respond(*this, http_message_body_chunk);
 }
 
 void HTTPRequest::respond(uint16_t status_code) {
@@ -105,6 +114,14 @@ void HTTPRequest::respond(uint16_t status_code, YO_NEW_REF Buffer& body) {
   respond(*http_response);
 }
 
+void
+HTTPRequest::respond(
+  uint16_t status_code,
+  auto_Object<Buffer>&& body
+) {
+  respond(status_code, body.release());
+}
+
 void HTTPRequest::respond(uint16_t status_code, const char* body) {
   respond(status_code, Buffer::copy(body));
 }
@@ -47,11 +47,18 @@ using yield::sockets::aio::recvAIOCB;
 using yield::sockets::aio::sendAIOCB;
 using yield::sockets::aio::sendfileAIOCB;
 
+// The number of acceptAIOCBs kept enqueued on the listen socket.
+const static uint8_t ACCEPT_AIOCB_COUNT = 16;
+
 template <class AIOQueueType>
 HTTPRequestQueue<AIOQueueType>::HTTPRequestQueue(
   const SocketAddress& sockname,
-  YO_NEW_REF Log* log
+  YO_NEW_REF Log* log,
+  const Time& idle_timeout
 ) throw(Exception) : aio_queue(*new AIOQueueType(log)),
+  connections_head(NULL),
+  connections_tail(NULL),
+  idle_timeout(idle_timeout),
   log(Object::inc_ref(log)),
   socket_(*new TCPSocket(sockname.get_family())) {
   init(sockname);
@@ -61,8 +68,12 @@ template <class AIOQueueType>
 HTTPRequestQueue<AIOQueueType>::HTTPRequestQueue(
   YO_NEW_REF TCPSocket& socket_,
   const SocketAddress& sockname,
-  YO_NEW_REF Log* log
+  YO_NEW_REF Log* log,
+  const Time& idle_timeout
 ) throw(Exception) : aio_queue(*new AIOQueueType(log)),
+  connections_head(NULL),
+  connections_tail(NULL),
+  idle_timeout(idle_timeout),
   log(Object::inc_ref(log)),
   socket_(socket_) {
   init(sockname);
@@ -70,12 +81,9 @@ HTTPRequestQueue<AIOQueueType>::HTTPRequestQueue(
 
 template <class AIOQueueType>
 HTTPRequestQueue<AIOQueueType>::~HTTPRequestQueue() {
-  for (
-    vector<HTTPConnection*>::iterator connection_i = connections.begin();
-    connection_i != connections.end();
-    ++connection_i
-  ) {
-    HTTPConnection* connection = *connection_i;
+  while (connections_head != NULL) {
+    HTTPConnection* connection = connections_head;
+    unlink(*connection);
     TCPSocket& socket_ = connection->get_socket();
     socket_.set_blocking_mode(true);
     socket_.setsockopt(TCPSocket::Option::LINGER, 30);
@@ -115,7 +123,7 @@ void HTTPRequestQueue<AIOQueueType>::handle(YO_NEW_REF acceptAIOCB& accept_aiocb
       connection->handle(accept_aiocb);
 
       if (connection->get_state() == HTTPConnection::STATE_CONNECTED) {
-        connections.push_back(connection);
+        link(*connection);
       } else {
         HTTPConnection::dec_ref(*connection);
       }
@@ -128,36 +136,33 @@ void HTTPRequestQueue<AIOQueueType>::handle(YO_NEW_REF acceptAIOCB& accept_aiocb
     acceptAIOCB::dec_ref(accept_aiocb);
   }
 
-  Buffer* recv_buffer
-  = new Buffer(Buffer::getpagesize(), Buffer::getpagesize());
-  acceptAIOCB* next_accept_aiocb = new acceptAIOCB(socket_, recv_buffer);
+  // No recv buffer: the connection's first recv allocates one lazily, so
+  // outstanding accepts hold no buffer memory.
+  acceptAIOCB* next_accept_aiocb = new acceptAIOCB(socket_);
   if (!aio_queue.enqueue(*next_accept_aiocb)) {
     acceptAIOCB::dec_ref(next_accept_aiocb);
   }
 }
 
 template <class AIOQueueType>
-template <class AIOCBType>
-void HTTPRequestQueue<AIOQueueType>::handle(YO_NEW_REF AIOCBType& aiocb) {
-  HTTPConnection& connection = *static_cast<HTTPConnection*>(aiocb.get_context());
+template <class EventType>
+void
+HTTPRequestQueue<AIOQueueType>::handle(
+  YO_NEW_REF EventType& event,
+  HTTPConnection& connection
+) {
   if (connection.get_state() == HTTPConnection::STATE_CONNECTED) {
-    connection.handle(aiocb);
-
-    if (connection.get_state() == HTTPConnection::STATE_ERROR) {
-      for (
-        vector<HTTPConnection*>::iterator connection_i = connections.begin();
-        connection_i != connections.end();
-        ++connection_i
-      ) {
-        if (*connection_i == &connection) {
-          connections.erase(connection_i);
-          connection.get_socket().close();
-          HTTPConnection::dec_ref(connection);
-        }
-      }
+    connection.handle(event);
+
+    if (connection.get_state() == HTTPConnection::STATE_CONNECTED) {
+      touch(connection);
+    } else {
+      unlink(connection);
+      connection.get_socket().close();
+      HTTPConnection::dec_ref(connection);
     }
   } else {
-    AIOCBType::dec_ref(aiocb);
+    EventType::dec_ref(event);
   }
 }
 
@@ -171,11 +176,24 @@ HTTPRequestQueue<AIOQueueType>::init(
     if (socket_.setsockopt(Socket::Option::REUSEADDR, true)) {
 #endif
       if (socket_.bind(sockname)) {
+        // Hold connections in the kernel until their request arrives, so
+        // the connection's first recv finds it. Best-effort: not all
+        // platforms can.
+        socket_.setsockopt(TCPSocket::Option::DEFER_ACCEPT, 1);
+
         if (socket_.listen()) {
-          Buffer* recv_buffer
-          = new Buffer(Buffer::getpagesize(), Buffer::getpagesize());
-          acceptAIOCB* accept_aiocb = new acceptAIOCB(socket_, recv_buffer);
-          if (aio_queue.enqueue(*accept_aiocb)) {
+          // Keep several accepts outstanding, so that a burst of
+          // connections is accepted in one pass instead of one per wakeup.
+          uint8_t accept_aiocb_i = 0;
+          for (; accept_aiocb_i < ACCEPT_AIOCB_COUNT; ++accept_aiocb_i) {
+            acceptAIOCB* accept_aiocb = new acceptAIOCB(socket_);
+            if (!aio_queue.enqueue(*accept_aiocb)) {
+              acceptAIOCB::dec_ref(*accept_aiocb);
+              break;
+            }
+          }
+
+          if (accept_aiocb_i > 0) {
             return;
           }
         }
@@ -188,14 +206,101 @@ HTTPRequestQueue<AIOQueueType>::init(
   throw Exception();
 }
 
+template <class AIOQueueType>
+void HTTPRequestQueue<AIOQueueType>::link(HTTPConnection& connection) {
+  connection.last_activity_time = Time::coarse_monotonic_now();
+  connection.next_connection = NULL;
+  connection.prev_connection = connections_tail;
+  if (connections_tail != NULL) {
+    connections_tail->next_connection = &connection;
+  } else {
+    connections_head = &connection;
+  }
+  connections_tail = &connection;
+}
+
+template <class AIOQueueType>
+Time HTTPRequestQueue<AIOQueueType>::reap_idle_connections() {
+  if (idle_timeout == Time::FOREVER || connections_head == NULL) {
+    return Time::FOREVER;
+  }
+
+  Time now = Time::coarse_monotonic_now();
+
+  while (connections_head != NULL) {
+    HTTPConnection& connection = *connections_head;
+    Time idle_time = now - connection.get_last_activity_time();
+    if (idle_time < idle_timeout) {
+      return idle_timeout - idle_time;
+    }
+
+    // A connection waiting on a slow handler isn't idle: closing it would
+    // lose the response.
+    if (connection.has_outstanding_responses()) {
+      touch(connection);
+      continue;
+    }
+
+    if (log != NULL) {
+      log->get_stream(Log::Level::DEBUG)
+          << "yield::http::server::HTTPRequestQueue: closing idle connection "
+          << "from " << connection.get_peername();
+    }
+
+    // Shutting the socket down completes the connection's outstanding recv,
+    // which then removes the connection like any other closed one. Until
+    // then it goes to the back of the list, as if it had just been active.
+    connection.get_socket().shutdown();
+    touch(connection);
+  }
+
+  return idle_timeout;
+}
+
+template <class AIOQueueType>
+void HTTPRequestQueue<AIOQueueType>::touch(HTTPConnection& connection) {
+  if (connections_tail != &connection) {
+    unlink(connection);
+    link(connection);
+  } else {
+    connection.last_activity_time = Time::coarse_monotonic_now();
+  }
+}
+
+template <class AIOQueueType>
+void HTTPRequestQueue<AIOQueueType>::unlink(HTTPConnection& connection) {
+  if (connection.prev_connection != NULL) {
+    connection.prev_connection->next_connection = connection.next_connection;
+  } else {
+    connections_head = connection.next_connection;
+  }
+
+  if (connection.next_connection != NULL) {
+    connection.next_connection->prev_connection = connection.prev_connection;
+  } else {
+    connections_tail = connection.prev_connection;
+  }
+
+  connection.next_connection = connection.prev_connection = NULL;
+}
+
 template <class AIOQueueType>
 YO_NEW_REF Event* HTTPRequestQueue<AIOQueueType>::timeddequeue(const Time& timeout) {
   Time timeout_remaining(timeout);
 
+  // Responses from this thread can then be sent without marshalling.
+  HTTPConnection::set_current_aio_queue(aio_queue);
+
   for (;;) {
-    Time start_time = Time::now();
+    Time start_time = Time::monotonic_now();
+
+    // Wake up in time to close the next connection to go idle.
+    Time reap_timeout = reap_idle_connections();
 
-    Event* event = aio_queue.timeddequeue(timeout_remaining);
+    Event* event
+    = aio_queue.timeddequeue(
+        reap_timeout < timeout_remaining ? reap_timeout : timeout_remaining
+      );
 
     if (event != NULL) {
       switch (event->get_type_id()) {
@@ -205,17 +310,27 @@ YO_NEW_REF Event* HTTPRequestQueue<AIOQueueType>::timeddequeue(const Time& timeo
       break;
 
       case recvAIOCB::TYPE_ID: {
-        handle<recvAIOCB>(static_cast<recvAIOCB&>(*event));
+        recvAIOCB& aiocb = static_cast<recvAIOCB&>(*event);
+        handle(aiocb, *static_cast<HTTPConnection*>(aiocb.get_context()));
       }
       break;
 
       case sendAIOCB::TYPE_ID: {
-        handle<sendAIOCB>(static_cast<sendAIOCB&>(*event));
+        sendAIOCB& aiocb = static_cast<sendAIOCB&>(*event);
+        handle(aiocb, *static_cast<HTTPConnection*>(aiocb.get_context()));
       }
       break;
 
       case sendfileAIOCB::TYPE_ID: {
-        handle<sendfileAIOCB>(static_cast<sendfileAIOCB&>(*event));
+        sendfileAIOCB& aiocb = static_cast<sendfileAIOCB&>(*event);
+        handle(aiocb, *static_cast<HTTPConnection*>(aiocb.get_context()));
+      }
+      break;
+
+      case HTTPConnection::RespondEvent::TYPE_ID: {
+        HTTPConnection::RespondEvent& respond_event
+        = static_cast<HTTPConnection::RespondEvent&>(*event);
+        handle(respond_event, respond_event.get_connection());
       }
       break;
 
@@ -223,7 +338,7 @@ YO_NEW_REF Event* HTTPRequestQueue<AIOQueueType>::timeddequeue(const Time& timeo
         return event;
       }
     } else if (timeout_remaining > static_cast<uint64_t>(0)) {
-      Time elapsed_time = Time::now() - start_time;
+      Time elapsed_time = Time::monotonic_now() - start_time;
       if (timeout_remaining > elapsed_time) {
         timeout_remaining -= elapsed_time;
       } else {
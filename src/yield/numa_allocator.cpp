@@ -0,0 +1,737 @@
+// yield/numa_allocator.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/atomic.hpp"
+#include "yield/numa_allocator.hpp"
+
+#include <cstdlib>
+
+#ifdef __linux__
+#include <cstdio>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace yield {
+#ifndef _WIN32
+const size_t NUMAAllocator::ALIGNMENT_DEFAULT;
+const int16_t NUMAAllocator::NUMA_NODE_LOCAL;
+#endif
+
+/**
+  Bookkeeping stored immediately before every heap or mapped block returned
+    by allocate. Arena blocks have no header; see NUMAChunkMap.
+*/
+struct NUMABlockHeader {
+  enum { TYPE_HEAP, TYPE_MAPPED };
+
+  uint32_t offset; // From the underlying block to the caller's pointer
+  int16_t numa_node_id;
+  uint8_t type;
+  size_t mapped_length;
+};
+
+static inline NUMABlockHeader* get_numa_block_header(const void* ptr) {
+  return reinterpret_cast<NUMABlockHeader*>(
+           const_cast<char*>(static_cast<const char*>(ptr))
+           - sizeof(NUMABlockHeader)
+         );
+}
+
+// Place the caller's pointer after a header in block, aligned to alignment.
+static inline void*
+init_numa_block(
+  void* block,
+  size_t alignment,
+  int16_t numa_node_id,
+  uint8_t type,
+  size_t mapped_length = 0
+) {
+  uintptr_t ptr
+  = reinterpret_cast<uintptr_t>(block) + sizeof(NUMABlockHeader);
+  ptr = (ptr + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+  NUMABlockHeader* header
+  = get_numa_block_header(reinterpret_cast<void*>(ptr));
+  header->offset
+  = static_cast<uint32_t>(ptr - reinterpret_cast<uintptr_t>(block));
+  header->numa_node_id = numa_node_id;
+  header->type = type;
+  header->mapped_length = mapped_length;
+
+  return reinterpret_cast<void*>(ptr);
+}
+
+
+#ifdef __linux__
+// Node ids are limited by the size of the mbind/set_mempolicy node mask.
+const static uint16_t NUMA_NODE_ID_MAX = 1023;
+
+// Size classes are powers of two from 32 bytes to 256 KB, enough for
+// page-aligned Buffers up to the largest HTTP recv buffers.
+const static uint8_t SIZE_CLASS_SHIFT_MIN = 5;
+const static uint8_t SIZE_CLASS_COUNT = 14;
+const static size_t SIZE_CLASS_MAX
+= static_cast<size_t>(1) << (SIZE_CLASS_SHIFT_MIN + SIZE_CLASS_COUNT - 1);
+
+// Chunks are aligned to their size and hold blocks of a single size class,
+// so every block is aligned to its own size.
+const static uint8_t CHUNK_SHIFT = 20;
+const static size_t CHUNK_SIZE = static_cast<size_t>(1) << CHUNK_SHIFT;
+
+// A thread caches at most this many bytes (and 64 blocks) per size class.
+const static size_t THREAD_CACHE_SIZE_MAX = 256 * 1024;
+
+const static size_t NODEMASK_WORD_BITS = sizeof(unsigned long) * 8;
+
+static inline size_t get_block_size(uint8_t size_class) {
+  return static_cast<size_t>(1) << (SIZE_CLASS_SHIFT_MIN + size_class);
+}
+
+/**
+  A node mask for mbind and set_mempolicy with a single node set.
+*/
+struct NUMANodeMask {
+  NUMANodeMask(uint16_t numa_node_id) {
+    for (size_t word_i = 0; word_i < WORD_COUNT; word_i++) {
+      words[word_i] = 0;
+    }
+    words[numa_node_id / NODEMASK_WORD_BITS]
+    |= 1UL << (numa_node_id % NODEMASK_WORD_BITS);
+  }
+
+  const static size_t WORD_COUNT = (NUMA_NODE_ID_MAX + 1) / NODEMASK_WORD_BITS;
+  unsigned long words[WORD_COUNT];
+};
+
+static bool bind_numa_memory(void* addr, size_t len, uint16_t numa_node_id) {
+  NUMANodeMask nodemask(numa_node_id);
+
+  // MPOL_PREFERRED rather than MPOL_BIND: a full node should spill
+  // to another node instead of failing the allocation.
+  return syscall(
+           SYS_mbind,
+           addr,
+           len,
+           MPOL_PREFERRED,
+           nodemask.words,
+           NUMA_NODE_ID_MAX + 1,
+           0
+         ) == 0;
+}
+
+static void* map_numa_memory(size_t len, uint16_t numa_node_id) {
+  void* addr
+  = mmap(
+      NULL,
+      len,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0
+    );
+  if (addr == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+
+  // The memory is still usable if the binding fails, e.g. in a container
+  // that forbids mbind; it just isn't guaranteed to be node-local.
+  bind_numa_memory(addr, len, numa_node_id);
+
+  return addr;
+}
+
+
+/**
+  The set of arena chunks, recording each chunk's node and size class so
+    that arena blocks need no header.
+  An open-addressed table of chunk addresses, with the node id and size
+    class packed into the low bits below CHUNK_SHIFT. Arenas keep their
+    chunks, so entries are never removed.
+*/
+class NUMAChunkMap {
+public:
+  bool insert(const void* chunk, uint16_t numa_node_id, uint8_t size_class) {
+    uintptr_t entry
+    = reinterpret_cast<uintptr_t>(chunk)
+      | static_cast<uintptr_t>(numa_node_id) << 4
+      | size_class;
+
+    size_t entry_i = hash(reinterpret_cast<uintptr_t>(chunk));
+    for (size_t probe_i = 0; probe_i < ENTRY_COUNT; probe_i++) {
+      uintptr_t empty_entry = 0;
+      if (
+        entries[entry_i].compare_exchange(
+          empty_entry,
+          entry,
+          MEMORY_ORDER_RELEASE
+        )
+      ) {
+        return true;
+      }
+      entry_i = (entry_i + 1) & (ENTRY_COUNT - 1);
+    }
+    return false;
+  }
+
+  // Find the chunk containing ptr, if it is an arena block.
+  bool
+  find(
+    const void* ptr,
+    uint16_t& numa_node_id,
+    uint8_t& size_class
+  ) const {
+    uintptr_t chunk
+    = reinterpret_cast<uintptr_t>(ptr) & ~(CHUNK_SIZE - 1);
+
+    size_t entry_i = hash(chunk);
+    for (size_t probe_i = 0; probe_i < ENTRY_COUNT; probe_i++) {
+      uintptr_t entry = entries[entry_i].load(MEMORY_ORDER_ACQUIRE);
+      if (entry == 0) {
+        return false;
+      } else if ((entry & ~(CHUNK_SIZE - 1)) == chunk) {
+        numa_node_id
+        = static_cast<uint16_t>((entry & (CHUNK_SIZE - 1)) >> 4);
+        size_class = static_cast<uint8_t>(entry & 0xf);
+        return true;
+      }
+      entry_i = (entry_i + 1) & (ENTRY_COUNT - 1);
+    }
+    return false;
+  }
+
+  // Return the map, creating it if create is true, or NULL if there is none.
+  static NUMAChunkMap* get(bool create = false) {
+    // Created with the first chunk, so that processes that only use the
+    // heap never pay for the map, and never destroyed.
+    static Atomic<NUMAChunkMap*> numa_chunk_map;
+
+    NUMAChunkMap* map = numa_chunk_map.load(MEMORY_ORDER_ACQUIRE);
+    if (map == NULL && create) {
+      NUMAChunkMap* new_map = new NUMAChunkMap;
+      if (
+        numa_chunk_map.compare_exchange(map, new_map, MEMORY_ORDER_ACQ_REL)
+      ) {
+        map = new_map;
+      } else {
+        delete new_map;
+      }
+    }
+    return map;
+  }
+
+private:
+  static size_t hash(uintptr_t chunk) {
+    return static_cast<size_t>((chunk >> CHUNK_SHIFT) * 2654435761UL)
+           & (ENTRY_COUNT - 1);
+  }
+
+private:
+  // Room for 64 GB of chunks.
+  const static size_t ENTRY_COUNT = 65536;
+  Atomic<uintptr_t> entries[ENTRY_COUNT];
+};
+
+
+/**
+  A NUMA node's pool of size-classed blocks.
+*/
+class NUMAArena {
+public:
+  NUMAArena(uint16_t numa_node_id)
+    : locked(false),
+      numa_node_id(numa_node_id) {
+    for (
+      uint8_t size_class = 0;
+      size_class < SIZE_CLASS_COUNT;
+      size_class++
+    ) {
+      chunks[size_class] = NULL;
+      chunk_lefts[size_class] = 0;
+      free_blocks[size_class] = NULL;
+    }
+  }
+
+public:
+  // Return NULL if no more chunks can be added.
+  void* allocate(uint8_t size_class) {
+    size_t block_size = get_block_size(size_class);
+
+    lock();
+
+    void* block = free_blocks[size_class];
+    if (block != NULL) {
+      free_blocks[size_class] = *static_cast<void**>(block);
+    } else {
+      if (chunk_lefts[size_class] == 0) {
+        try {
+          chunks[size_class] = map_chunk(size_class);
+        } catch (std::bad_alloc&) {
+          unlock();
+          throw;
+        }
+
+        if (chunks[size_class] == NULL) {
+          unlock();
+          return NULL;
+        }
+        chunk_lefts[size_class] = CHUNK_SIZE;
+      }
+
+      block = chunks[size_class];
+      chunks[size_class] += block_size;
+      chunk_lefts[size_class] -= block_size;
+    }
+
+    unlock();
+
+    return block;
+  }
+
+  void deallocate(void* block, uint8_t size_class) {
+    lock();
+    *static_cast<void**>(block) = free_blocks[size_class];
+    free_blocks[size_class] = block;
+    unlock();
+  }
+
+  static NUMAArena& get(uint16_t numa_node_id) {
+    // Arenas are created on first use and never destroyed, since blocks may
+    // be freed by any thread at any time.
+    static Atomic<NUMAArena*> numa_arenas[NUMA_NODE_ID_MAX + 1];
+
+    NUMAArena* numa_arena
+    = numa_arenas[numa_node_id].load(MEMORY_ORDER_ACQUIRE);
+    if (numa_arena == NULL) {
+      NUMAArena* new_numa_arena = new NUMAArena(numa_node_id);
+      if (
+        numa_arenas[numa_node_id].compare_exchange(
+          numa_arena,
+          new_numa_arena,
+          MEMORY_ORDER_ACQ_REL
+        )
+      ) {
+        numa_arena = new_numa_arena;
+      } else {
+        delete new_numa_arena;
+      }
+    }
+    return *numa_arena;
+  }
+
+private:
+  void lock() {
+    while (locked.exchange(true, MEMORY_ORDER_ACQUIRE)) {
+      while (locked.load(MEMORY_ORDER_RELAXED)) {
+        sched_yield();
+      }
+    }
+  }
+
+  // Map a CHUNK_SIZE-aligned chunk by trimming an oversized mapping.
+  char* map_chunk(uint8_t size_class) {
+    char* mapping
+    = static_cast<char*>(map_numa_memory(CHUNK_SIZE * 2, numa_node_id));
+    char* chunk
+    = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(mapping) + CHUNK_SIZE - 1)
+        & ~(CHUNK_SIZE - 1)
+      );
+    if (chunk > mapping) {
+      munmap(mapping, static_cast<size_t>(chunk - mapping));
+    }
+    munmap(
+      chunk + CHUNK_SIZE,
+      static_cast<size_t>(mapping + CHUNK_SIZE - chunk)
+    );
+
+    if (!NUMAChunkMap::get(true)->insert(chunk, numa_node_id, size_class)) {
+      munmap(chunk, CHUNK_SIZE);
+      return NULL;
+    }
+
+    return chunk;
+  }
+
+  void unlock() {
+    locked.store(false, MEMORY_ORDER_RELEASE);
+  }
+
+private:
+  char* chunks[SIZE_CLASS_COUNT];
+  size_t chunk_lefts[SIZE_CLASS_COUNT];
+  void* free_blocks[SIZE_CLASS_COUNT];
+  Atomic<bool> locked;
+  uint16_t numa_node_id;
+};
+
+
+/**
+  A thread's cache of free arena blocks from one NUMA node, in front of the
+    node's arena, so that most allocations and deallocations take no lock.
+  Blocks are returned to the arena when the cache is full, when the thread
+    allocates on another node, and when the thread exits.
+*/
+class NUMAThreadCache {
+public:
+  void* allocate(uint16_t numa_node_id, uint8_t size_class) {
+    if (numa_node_id != this->numa_node_id) {
+      flush();
+      this->numa_node_id = numa_node_id;
+    }
+
+    void* block = free_blocks[size_class];
+    if (block != NULL) {
+      free_blocks[size_class] = *static_cast<void**>(block);
+      free_block_counts[size_class]--;
+    }
+    return block;
+  }
+
+  bool deallocate(void* block, uint16_t numa_node_id, uint8_t size_class) {
+    if (
+      numa_node_id != this->numa_node_id
+      ||
+      free_block_counts[size_class] >= get_free_block_count_max(size_class)
+    ) {
+      return false;
+    }
+
+    *static_cast<void**>(block) = free_blocks[size_class];
+    free_blocks[size_class] = block;
+    free_block_counts[size_class]++;
+    return true;
+  }
+
+  // Return the caller's cache, or NULL once the caller is exiting.
+  static NUMAThreadCache* get() {
+    NUMAThreadCache* numa_thread_cache = &NUMAThreadCache::numa_thread_cache;
+    switch (numa_thread_cache->state) {
+    case STATE_ACTIVE:
+      return numa_thread_cache;
+
+    case STATE_EXITED:
+      return NULL;
+
+    default: {
+      // Register the cache to be flushed when the thread exits.
+      pthread_once(&key_once, create_key);
+      if (pthread_setspecific(key, numa_thread_cache) != 0) {
+        return NULL;
+      }
+      numa_thread_cache->state = STATE_ACTIVE;
+      return numa_thread_cache;
+    }
+    }
+  }
+
+private:
+  enum State { STATE_NEW, STATE_ACTIVE, STATE_EXITED };
+
+private:
+  static void create_key() {
+    pthread_key_create(&key, destroy);
+  }
+
+  static void destroy(void* numa_thread_cache) {
+    static_cast<NUMAThreadCache*>(numa_thread_cache)->flush();
+    static_cast<NUMAThreadCache*>(numa_thread_cache)->state = STATE_EXITED;
+  }
+
+  void flush() {
+    for (
+      uint8_t size_class = 0;
+      size_class < SIZE_CLASS_COUNT;
+      size_class++
+    ) {
+      while (free_blocks[size_class] != NULL) {
+        void* block = free_blocks[size_class];
+        free_blocks[size_class] = *static_cast<void**>(block);
+        NUMAArena::get(numa_node_id).deallocate(block, size_class);
+      }
+      free_block_counts[size_class] = 0;
+    }
+  }
+
+  static uint16_t get_free_block_count_max(uint8_t size_class) {
+    size_t free_block_count_max
+    = THREAD_CACHE_SIZE_MAX / get_block_size(size_class);
+    return static_cast<uint16_t>(
+             free_block_count_max < 64 ? free_block_count_max : 64
+           );
+  }
+
+private:
+  // Zero-initialized, hence no constructor.
+  void* free_blocks[SIZE_CLASS_COUNT];
+  uint16_t free_block_counts[SIZE_CLASS_COUNT];
+  uint16_t numa_node_id;
+  State state;
+
+  static pthread_key_t key;
+  static pthread_once_t key_once;
+  static __thread NUMAThreadCache numa_thread_cache;
+};
+
+pthread_key_t NUMAThreadCache::key;
+pthread_once_t NUMAThreadCache::key_once = PTHREAD_ONCE_INIT;
+__thread NUMAThreadCache NUMAThreadCache::numa_thread_cache;
+
+static void* allocate_numa_block(uint16_t numa_node_id, uint8_t size_class) {
+  NUMAThreadCache* numa_thread_cache = NUMAThreadCache::get();
+  if (numa_thread_cache != NULL) {
+    void* block = numa_thread_cache->allocate(numa_node_id, size_class);
+    if (block != NULL) {
+      return block;
+    }
+  }
+
+  return NUMAArena::get(numa_node_id).allocate(size_class);
+}
+
+static void
+deallocate_numa_block(
+  void* block,
+  uint16_t numa_node_id,
+  uint8_t size_class
+) {
+  NUMAThreadCache* numa_thread_cache = NUMAThreadCache::get();
+  if (
+    numa_thread_cache == NULL
+    ||
+    !numa_thread_cache->deallocate(block, numa_node_id, size_class)
+  ) {
+    NUMAArena::get(numa_node_id).deallocate(block, size_class);
+  }
+}
+
+static uint16_t read_numa_node_count() {
+  // Count the ids in a list such as "0-1,3".
+  std::FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+  if (file == NULL) {
+    return 1;
+  }
+
+  uint16_t numa_node_count = 0;
+  unsigned int first, last;
+  while (std::fscanf(file, "%u", &first) == 1) {
+    last = first;
+    int separator = std::fgetc(file);
+    if (separator == '-') {
+      if (std::fscanf(file, "%u", &last) != 1) {
+        break;
+      }
+      separator = std::fgetc(file);
+    }
+    if (last >= first) {
+      numa_node_count
+      = static_cast<uint16_t>(numa_node_count + last - first + 1);
+    }
+    if (separator != ',') {
+      break;
+    }
+  }
+
+  std::fclose(file);
+
+  return numa_node_count > 0 ? numa_node_count : 1;
+}
+#endif
+
+
+void*
+NUMAAllocator::allocate(
+  size_t size,
+  size_t alignment,
+  int16_t numa_node_id
+) {
+#ifdef __linux__
+  if (numa_node_id == NUMA_NODE_LOCAL && get_numa_node_count() > 1) {
+    numa_node_id = static_cast<int16_t>(get_current_numa_node_id());
+  }
+
+  if (
+    numa_node_id >= 0 && numa_node_id <= NUMA_NODE_ID_MAX
+    &&
+    size <= SIZE_CLASS_MAX && alignment <= SIZE_CLASS_MAX
+  ) {
+    // Arena blocks are aligned to their size, so alignment only raises
+    // the size class instead of padding the block.
+    uint8_t size_class = 0;
+    while (
+      get_block_size(size_class) < size
+      ||
+      get_block_size(size_class) < alignment
+    ) {
+      size_class++;
+    }
+
+    void* block
+    = allocate_numa_block(static_cast<uint16_t>(numa_node_id), size_class);
+    if (block != NULL) {
+      return block;
+    }
+  }
+#endif
+
+  if (alignment < sizeof(NUMABlockHeader)) {
+    alignment = sizeof(NUMABlockHeader);
+  }
+  // Enough room to align the caller's pointer after the header.
+  size_t block_size = size + alignment;
+  if (block_size < size) {
+    throw std::bad_alloc();
+  }
+
+#ifdef __linux__
+  if (numa_node_id >= 0 && numa_node_id <= NUMA_NODE_ID_MAX) {
+    size_t pagesize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mapped_length = (block_size + pagesize - 1) & ~(pagesize - 1);
+    void* block
+    = map_numa_memory(mapped_length, static_cast<uint16_t>(numa_node_id));
+    return init_numa_block(
+             block,
+             alignment,
+             numa_node_id,
+             NUMABlockHeader::TYPE_MAPPED,
+             mapped_length
+           );
+  }
+#endif
+
+  void* block = std::malloc(block_size);
+  if (block == NULL) {
+    throw std::bad_alloc();
+  }
+  return init_numa_block(
+           block,
+           alignment,
+           NUMA_NODE_LOCAL,
+           NUMABlockHeader::TYPE_HEAP
+         );
+}
+
+void NUMAAllocator::deallocate(void* ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+
+#ifdef __linux__
+  NUMAChunkMap* numa_chunk_map = NUMAChunkMap::get();
+  uint16_t numa_node_id;
+  uint8_t size_class;
+  if (
+    numa_chunk_map != NULL
+    &&
+    numa_chunk_map->find(ptr, numa_node_id, size_class)
+  ) {
+    deallocate_numa_block(ptr, numa_node_id, size_class);
+    return;
+  }
+#endif
+
+  NUMABlockHeader* header = get_numa_block_header(ptr);
+  void* block = static_cast<char*>(ptr) - header->offset;
+
+  switch (header->type) {
+#ifdef __linux__
+  case NUMABlockHeader::TYPE_MAPPED: {
+    munmap(block, header->mapped_length);
+  }
+  break;
+#endif
+
+  default: {
+    std::free(block);
+  }
+  break;
+  }
+}
+
+uint16_t NUMAAllocator::get_current_numa_node_id() {
+#ifdef __linux__
+  unsigned int cpu, numa_node_id;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 29)
+  // glibc's getcpu goes through the vDSO instead of a system call.
+  if (getcpu(&cpu, &numa_node_id) == 0) {
+#else
+  if (syscall(SYS_getcpu, &cpu, &numa_node_id, NULL) == 0) {
+#endif
+    return static_cast<uint16_t>(numa_node_id);
+  }
+#endif
+  return 0;
+}
+
+int16_t NUMAAllocator::get_numa_node_id(const void* ptr) {
+#ifdef __linux__
+  NUMAChunkMap* numa_chunk_map = NUMAChunkMap::get();
+  uint16_t numa_node_id;
+  uint8_t size_class;
+  if (
+    numa_chunk_map != NULL
+    &&
+    numa_chunk_map->find(ptr, numa_node_id, size_class)
+  ) {
+    return static_cast<int16_t>(numa_node_id);
+  }
+#endif
+  return get_numa_block_header(ptr)->numa_node_id;
+}
+
+uint16_t NUMAAllocator::get_numa_node_count() {
+#ifdef __linux__
+  static uint16_t numa_node_count = read_numa_node_count();
+  return numa_node_count;
+#else
+  return 1;
+#endif
+}
+
+bool NUMAAllocator::set_preferred_numa_node(int16_t numa_node_id) {
+#ifdef __linux__
+  if (numa_node_id == NUMA_NODE_LOCAL) {
+    return syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0) == 0;
+  } else if (numa_node_id >= 0 && numa_node_id <= NUMA_NODE_ID_MAX) {
+    NUMANodeMask nodemask(static_cast<uint16_t>(numa_node_id));
+    return syscall(
+             SYS_set_mempolicy,
+             MPOL_PREFERRED,
+             nodemask.words,
+             NUMA_NODE_ID_MAX + 1
+           ) == 0;
+  }
+#endif
+  return false;
+}
+}
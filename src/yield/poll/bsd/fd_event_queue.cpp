@@ -117,7 +117,7 @@ bool FDEventQueue::enqueue(Event& event) {
   }
 }
 
-YO_NEW_REF Event* FDEventQueue::timeddequeue(const Time& timeout) {
+YO_NEW_REF Event* FDEventQueue::dequeue_fd_event(const Time& timeout) {
   Event* event = event_queue.trydequeue();
   if (event != NULL) {
     return event;
@@ -50,15 +50,9 @@ const FDEvent::Type FDEvent::TYPE_WRITE_READY = POLLOUT;
 #endif
 
 FDEvent::FDEvent(fd_t fd, Type type) : fd(fd), type(type) {
-  debug_assert(
-    type == TYPE_ERROR
-    ||
-    type == TYPE_HUP
-    ||
-    type == TYPE_READ_READY
-    ||
-    type == TYPE_WRITE_READY
-  );
+  // Pollers report every event that occurred at once, and may add bits
+  // (e.g., POLLPRI, POLLNVAL) beyond the TYPE_* constants.
+  debug_assert_ne(type, 0);
 }
 }
 }
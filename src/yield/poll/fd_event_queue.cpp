@@ -0,0 +1,67 @@
+// yield/poll/fd_event_queue.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/poll/fd_event_queue.hpp"
+
+namespace yield {
+namespace poll {
+YO_NEW_REF Event* FDEventQueue::timeddequeue(const Time& timeout) {
+  if (timer_wheel.empty()) {
+    return dequeue_fd_event(timeout);
+  }
+
+  Time now = Time::monotonic_now();
+  Time deadline = (timeout == Time::FOREVER) ? timeout : now + timeout;
+
+  for (;;) {
+    TimerEvent* timer_event = timer_wheel.expire(now);
+    if (timer_event != NULL) {
+      return timer_event;
+    }
+
+    // Sleep until the caller's timeout or the timer wheel's next expiry,
+    // whichever is sooner.
+    Time poll_timeout = timer_wheel.get_next_timeout(now);
+    if (deadline != Time::FOREVER && deadline - now < poll_timeout) {
+      poll_timeout = deadline - now;
+    }
+
+    Event* event = dequeue_fd_event(poll_timeout);
+    if (event != NULL) {
+      return event;
+    }
+
+    now = Time::monotonic_now();
+    if (now >= deadline) {
+      return timer_wheel.expire(now);
+    }
+  }
+}
+}
+}
@@ -35,6 +35,7 @@
 #include <poll.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace yield {
 namespace poll {
@@ -112,14 +113,19 @@ bool FDEventQueue::enqueue(Event& event) {
   }
 }
 
-YO_NEW_REF Event* FDEventQueue::timeddequeue(const Time& timeout) {
+YO_NEW_REF Event* FDEventQueue::dequeue_fd_event(const Time& timeout) {
   Event* event = event_queue.trydequeue();
   if (event != NULL) {
     return event;
   } else {
     epoll_event epoll_event_;
     int timeout_ms
-    = (timeout == Time::FOREVER) ? -1 : static_cast<int>(timeout.ms());
+    = (timeout == Time::FOREVER)
+      ? -1
+      // Round up, so a wait for a timer never wakes just before it is due.
+      : static_cast<int>(
+          (timeout.ns() + Time::NS_IN_MS - 1) / Time::NS_IN_MS
+        );
     int ret = epoll_wait(epfd, &epoll_event_, 1, timeout_ms);
     if (ret > 0) {
       debug_assert_eq(ret, 1);
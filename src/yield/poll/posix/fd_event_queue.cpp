@@ -109,9 +109,14 @@ bool FDEventQueue::enqueue(YO_NEW_REF Event& event) {
   }
 }
 
-YO_NEW_REF Event* FDEventQueue::timeddequeue(const Time& timeout) {
+YO_NEW_REF Event* FDEventQueue::dequeue_fd_event(const Time& timeout) {
   int timeout_ms
-  = (timeout == Time::FOREVER) ? -1 : static_cast<int>(timeout.ms());
+  = (timeout == Time::FOREVER)
+    ? -1
+    // Round up, so a wait for a timer never wakes just before it is due.
+    : static_cast<int>(
+        (timeout.ns() + Time::NS_IN_MS - 1) / Time::NS_IN_MS
+      );
   int ret = ::poll(&pollfds[0], pollfds.size(), timeout_ms);
   if (ret > 0) {
     vector<pollfd>::const_iterator pollfd_i = pollfds.begin();
@@ -564,7 +564,7 @@ bool FDEventQueue::enqueue(Event& event) {
   return pimpl->enqueue(event);
 }
 
-YO_NEW_REF Event* FDEventQueue::timeddequeue(const Time& timeout) {
+YO_NEW_REF Event* FDEventQueue::dequeue_fd_event(const Time& timeout) {
   return pimpl->timeddequeue(timeout);
 }
 }
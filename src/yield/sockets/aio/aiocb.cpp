@@ -30,20 +30,31 @@
 #include "yield/sockets/socket.hpp"
 #include "yield/sockets/aio/aiocb.hpp"
 
+#ifndef _WIN32
+#include <errno.h>
+#endif
+
 namespace yield {
 namespace sockets {
 namespace aio {
 #ifndef _WIN32
+const uint32_t AIOCB::Error::CANCELED = ECANCELED;
+const uint32_t AIOCB::Error::TIMED_OUT = ETIMEDOUT;
+
 AIOCB::AIOCB(Socket& socket_, Object* context)
   : context(Object::inc_ref(context)),
-    socket_(socket_.inc_ref()) {
+    deadline_timer_event(NULL),
+    socket_(socket_.inc_ref()),
+    timeout(Time::FOREVER) {
   error = 0;
   return_ = -1;
 }
 
 AIOCB::AIOCB(Socket& socket_, off_t offset, Object* context)
   : context(Object::inc_ref(context)),
-    socket_(socket_.inc_ref()) {
+    deadline_timer_event(NULL),
+    socket_(socket_.inc_ref()),
+    timeout(Time::FOREVER) {
   error = 0;
   return_ = -1;
 }
@@ -29,9 +29,11 @@
 
 #include "yield/debug.hpp"
 #include "yield/buffer.hpp"
+#include "yield/buffers.hpp"
 #include "yield/exception.hpp"
 #include "yield/log.hpp"
 #include "yield/time.hpp"
+#include "yield/timer_event.hpp"
 #include "yield/sockets/stream_socket.hpp"
 #include "yield/sockets/aio/accept_aiocb.hpp"
 #include "yield/sockets/aio/nbio_queue.hpp"
@@ -39,42 +41,277 @@
 #include "yield/sockets/aio/recv_aiocb.hpp"
 #include "yield/sockets/aio/send_aiocb.hpp"
 #include "yield/sockets/aio/sendfile_aiocb.hpp"
+#include "yield/sockets/aio/splice_aiocb.hpp"
+
+#include <limits.h> // For IOV_MAX
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#include <errno.h>
+#endif
 
 namespace yield {
 namespace sockets {
 namespace aio {
+using std::deque;
 using std::map;
 using yield::poll::FDEvent;
 
+// The most buffers retry_sendmsg gathers into a single sendmsg.
+#ifdef IOV_MAX
+const static size_t SENDMSG_IOV_MAX = IOV_MAX;
+#else
+const static size_t SENDMSG_IOV_MAX = 1024;
+#endif
+
+// The most idle pipes kept for spliceAIOCBs.
+const static size_t SPARE_PIPES_MAX = 16;
+
+// The most a spliceAIOCB asks to fill its pipe with at once: more than a
+// pipe holds, but not so much that the kernel refuses the length.
+const static size_t SPLICE_LEN_MAX = 1024 * 1024;
+
+#ifdef __linux__
+// Whether a SIGPIPE raised on the calling thread would be handled, that is,
+// it's neither blocked on the thread nor ignored by the process.
+static bool is_sigpipe_handled() {
+  sigset_t blocked_set;
+  if (
+    pthread_sigmask(SIG_BLOCK, NULL, &blocked_set) == 0
+    &&
+    sigismember(&blocked_set, SIGPIPE) == 1
+  ) {
+    return false;
+  }
+
+  struct sigaction sigpipe_action;
+  if (
+    sigaction(SIGPIPE, NULL, &sigpipe_action) == 0
+    &&
+    (sigpipe_action.sa_flags & SA_SIGINFO) == 0
+    &&
+    sigpipe_action.sa_handler == SIG_IGN
+  ) {
+    return false;
+  }
+
+  return true;
+}
+
+// Splice from a pipe to a descriptor. Like a send with MSG_NOSIGNAL, a
+// broken connection or pipe fails with EPIPE instead of raising SIGPIPE,
+// which is blocked around the splice if mask_sigpipe is set.
+static ssize_t
+splice_nosignal(fd_t pipe_fd, fd_t to_fd, size_t len, bool mask_sigpipe) {
+  sigset_t sigpipe_set, old_sigset;
+  bool sigpipe_pending = false;
+  if (mask_sigpipe) {
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, &old_sigset);
+
+    // A SIGPIPE that's already pending isn't the splice's to discard.
+    sigset_t pending_set;
+    sigpipe_pending
+    = sigpending(&pending_set) == 0 && sigismember(&pending_set, SIGPIPE) == 1;
+  }
+
+  ssize_t splice_ret
+  = splice(
+      pipe_fd,
+      NULL,
+      to_fd,
+      NULL,
+      len,
+      SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+    );
+
+  if (mask_sigpipe) {
+    if (splice_ret == -1 && errno == EPIPE && !sigpipe_pending) {
+      // Discard the SIGPIPE before it's unblocked.
+      timespec timeout = { 0, 0 };
+      sigtimedwait(&sigpipe_set, NULL, &timeout);
+      errno = EPIPE;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_sigset, NULL);
+  }
+
+  return splice_ret;
+}
+#endif
+
 class NBIOQueue::AIOCBState {
 public:
-  AIOCBState(YO_NEW_REF AIOCB& aiocb, ssize_t partial_send_len)
+  AIOCBState(
+    YO_NEW_REF AIOCB& aiocb,
+    ssize_t partial_send_len,
+    FDEvent::Type want_fd_event_types = 0
+  )
     : aiocb(&aiocb),
-      partial_send_len(partial_send_len) {
+      partial_send_len(partial_send_len),
+      want_fd_event_types(want_fd_event_types) {
     next_aiocb_state = NULL;
+    pipe_fds[0] = pipe_fds[1] = INVALID_FD;
+    pipe_len = 0;
+    splice_eof = false;
+    splice_fd_flags = -1;
+    want_splice_fd = false;
+    zerocopy_first_id = 0;
+    zerocopy_ids = zerocopy_ids_done = 0;
   }
 
   ~AIOCBState() {
+#ifdef __linux__
+    restore_splice_fd_flags();
+#endif
     AIOCB::dec_ref(aiocb);
     delete next_aiocb_state;
+#ifdef __linux__
+    // A pipe that wasn't returned to the NBIOQueue may still hold data.
+    if (pipe_fds[0] != INVALID_FD) {
+      close(pipe_fds[0]);
+      close(pipe_fds[1]);
+    }
+#endif
+  }
+
+public:
+  void add_zerocopy_id(uint32_t id) {
+    if (zerocopy_ids == 0) {
+      zerocopy_first_id = id;
+    }
+    ++zerocopy_ids;
+  }
+
+  // Count the IDs in [lo, hi] among the zero-copy sends of aiocb's buffer.
+  // IDs wrap, so they're compared by their distance from zerocopy_first_id.
+  void add_zerocopy_ids_done(uint32_t lo, uint32_t hi) {
+    int32_t done_first = static_cast<int32_t>(lo - zerocopy_first_id);
+    int32_t done_last = static_cast<int32_t>(hi - zerocopy_first_id);
+    if (done_first < 0) {
+      done_first = 0;
+    }
+    if (done_last >= static_cast<int32_t>(zerocopy_ids)) {
+      done_last = static_cast<int32_t>(zerocopy_ids) - 1;
+    }
+    if (done_last >= done_first) {
+      zerocopy_ids_done += static_cast<uint32_t>(done_last - done_first + 1);
+    }
+  }
+
+#ifdef __linux__
+  // Undo the spliceAIOCB descriptor's switch to non-blocking mode, if any.
+  void restore_splice_fd_flags() {
+    if (splice_fd_flags != -1) {
+      fcntl(
+        static_cast<spliceAIOCB*>(aiocb)->get_fd(),
+        F_SETFL,
+        splice_fd_flags
+      );
+      splice_fd_flags = -1;
+    }
+  }
+#endif
+
+  // Whether the kernel may still be reading from aiocb's buffer.
+  bool zerocopy_pending() const {
+    return zerocopy_ids_done < zerocopy_ids;
   }
 
 public:
   AIOCB* aiocb;
   AIOCBState* next_aiocb_state;
   size_t partial_send_len;
+  // The readiness the last retry would block on, or 0 if not yet retried.
+  FDEvent::Type want_fd_event_types;
+  // The pipe a spliceAIOCB moves data through, the number of bytes in it and
+  // whether the source has reached end-of-file. Moved bytes are counted in
+  // partial_send_len.
+  fd_t pipe_fds[2];
+  size_t pipe_len;
+  bool splice_eof;
+  // The file status flags of a spliceAIOCB's descriptor before the splice
+  // put it in non-blocking mode, or -1 if it didn't. The descriptor is a
+  // duplicate that shares them with the caller's, such as another Socket
+  // that may be used in blocking mode, so they're restored afterwards.
+  int splice_fd_flags;
+  // Whether the last retry of a spliceAIOCB would block on its descriptor
+  // rather than its socket.
+  bool want_splice_fd;
+  // The zero-copy sends that carried some of aiocb's buffer have the
+  // zerocopy_ids consecutive IDs from zerocopy_first_id, of which the kernel
+  // has reported zerocopy_ids_done done with the pages.
+  uint32_t zerocopy_first_id, zerocopy_ids, zerocopy_ids_done;
+};
+
+class NBIOQueue::CancelEvent : public Event {
+public:
+  const static uint32_t TYPE_ID = 1128204365UL;
+
+public:
+  CancelEvent(AIOCB& aiocb)
+    : aiocb(aiocb.inc_ref()) {
+  }
+
+  ~CancelEvent() {
+    AIOCB::dec_ref(aiocb);
+  }
+
+public:
+  AIOCB& get_aiocb() const {
+    return aiocb;
+  }
+
+public:
+  // yield::Object
+  uint32_t get_type_id() const {
+    return TYPE_ID;
+  }
+
+  const char* get_type_name() const {
+    return "yield::sockets::aio::NBIOQueue::CancelEvent";
+  }
+
+private:
+  AIOCB& aiocb;
+};
+
+// Only armed while aiocb is pending, so it needn't hold a reference to it.
+class NBIOQueue::DeadlineTimerEvent : public TimerEvent {
+public:
+  DeadlineTimerEvent(AIOCB& aiocb)
+    : TimerEvent(aiocb.get_timeout()), aiocb(aiocb) {
+  }
+
+public:
+  AIOCB& get_aiocb() const {
+    return aiocb;
+  }
+
+private:
+  AIOCB& aiocb;
 };
 
 class NBIOQueue::SocketState {
 public:
   SocketState() {
     memset(aiocb_state, 0, sizeof(aiocb_state));
+    associated_fd_event_types = 0;
+    zerocopy_aiocb_state = NULL;
   }
 
   ~SocketState() {
     for (uint8_t i = 0; i < 4; ++i) {
       delete aiocb_state[i];
     }
+    delete zerocopy_aiocb_state;
   }
 
 public:
@@ -84,46 +321,179 @@ public:
         return false;
       }
     }
-    return true;
+    return zerocopy_aiocb_state == NULL;
   }
 
 public:
   AIOCBState* aiocb_state[4]; // accept, connect, send, recv
+  FDEvent::Type associated_fd_event_types;
+  // Finished sends whose buffers the kernel may still be reading from,
+  // in the order they finished.
+  AIOCBState* zerocopy_aiocb_state;
 };
 
 NBIOQueue::NBIOQueue(YO_NEW_REF Log* log)
-  : fd_event_queue(true), log(log) {
+  : fd_event_queue(true),
+    log(log),
+    spare_recv_buffer(NULL),
+    splice_sigpipe_mask(-1) {
 }
 
 NBIOQueue::~NBIOQueue() {
+  for (
+    deque<AIOCB*>::iterator aiocb_i = completed_aiocbs.begin();
+    aiocb_i != completed_aiocbs.end();
+    ++aiocb_i
+  ) {
+    AIOCB::dec_ref(**aiocb_i);
+  }
+
   Log::dec_ref(log);
+  Buffer::dec_ref(spare_recv_buffer);
+
+#ifdef __linux__
+  for (
+    vector< std::pair<fd_t, fd_t> >::iterator spare_pipe_i
+    = spare_pipes.begin();
+    spare_pipe_i != spare_pipes.end();
+    ++spare_pipe_i
+  ) {
+    close(spare_pipe_i->first);
+    close(spare_pipe_i->second);
+  }
+#endif
 }
 
-void NBIOQueue::associate(AIOCB& aiocb, RetryStatus retry_status) {
-  switch (retry_status) {
-  case RETRY_STATUS_WANT_RECV: {
-    bool associate_ret =
-      fd_event_queue.associate(
-        aiocb.get_socket(),
-        FDEvent::TYPE_READ_READY
-      );
-    debug_assert_true(associate_ret);
+YO_NEW_REF AIOCB* NBIOQueue::abandon(AIOCB& aiocb, uint32_t error) {
+  map<fd_t, SocketState*>::iterator socket_state_i
+  = this->socket_state.find(aiocb.get_socket());
+  if (socket_state_i == this->socket_state.end()) {
+    return NULL;
+  }
+  SocketState* socket_state = socket_state_i->second;
+
+  uint8_t aiocb_priority = get_aiocb_priority(aiocb);
+  AIOCBState* prev_aiocb_state = NULL;
+  AIOCBState* aiocb_state = socket_state->aiocb_state[aiocb_priority];
+  while (aiocb_state != NULL && aiocb_state->aiocb != &aiocb) {
+    prev_aiocb_state = aiocb_state;
+    aiocb_state = aiocb_state->next_aiocb_state;
+  }
+  if (aiocb_state == NULL) {
+    return NULL; // Already completed
   }
-  break;
 
-  case RETRY_STATUS_WANT_SEND: {
-    bool associate_ret =
-      fd_event_queue.associate(
-        aiocb.get_socket(),
-        FDEvent::TYPE_WRITE_READY
-      );
-    debug_assert_true(associate_ret);
+  if (prev_aiocb_state != NULL) {
+    prev_aiocb_state->next_aiocb_state = aiocb_state->next_aiocb_state;
+  } else {
+    socket_state->aiocb_state[aiocb_priority]
+    = aiocb_state->next_aiocb_state;
   }
-  break;
+  aiocb_state->next_aiocb_state = NULL;
 
-  default:
-    debug_break();
-    break;
+  if (aiocb_state->want_splice_fd) {
+    fd_t splice_fd = static_cast<spliceAIOCB&>(aiocb).get_fd();
+    fd_event_queue.dissociate(splice_fd);
+    splice_fds.erase(splice_fd);
+  }
+
+  disarm_deadline(aiocb);
+  aiocb.set_error(error);
+  aiocb.set_return(-1);
+
+  // An abandoned zero-copy send still can't give up its buffer until the
+  // kernel is done with it.
+  bool zerocopy_pending = aiocb_state->zerocopy_pending();
+  if (zerocopy_pending) {
+    defer_completion(*aiocb_state, *socket_state);
+  } else {
+    aiocb_state->aiocb = NULL;
+    delete aiocb_state;
+  }
+
+  // Retry any AIOCB that was queued behind the abandoned one and recompute
+  // the socket's association.
+  retry(socket_state_i, 0);
+
+  return zerocopy_pending ? NULL : &aiocb;
+}
+
+void NBIOQueue::arm_deadline(AIOCB& aiocb) {
+  if (
+    aiocb.get_timeout() != Time::FOREVER
+    &&
+    aiocb.deadline_timer_event == NULL
+  ) {
+    aiocb.deadline_timer_event = new DeadlineTimerEvent(aiocb);
+    fd_event_queue.arm_timer(aiocb.deadline_timer_event->inc_ref());
+  }
+}
+
+bool NBIOQueue::borrow_pipe(AIOCBState& aiocb_state) {
+  if (!spare_pipes.empty()) {
+    aiocb_state.pipe_fds[0] = spare_pipes.back().first;
+    aiocb_state.pipe_fds[1] = spare_pipes.back().second;
+    spare_pipes.pop_back();
+    return true;
+  }
+
+#ifdef __linux__
+  return pipe2(aiocb_state.pipe_fds, O_CLOEXEC) == 0;
+#else
+  return false;
+#endif
+}
+
+bool NBIOQueue::cancel(AIOCB& aiocb) {
+  return fd_event_queue.enqueue(*new CancelEvent(aiocb));
+}
+
+bool NBIOQueue::can_coalesce(sendAIOCB& first, AIOCB& aiocb) {
+  return aiocb.get_type_id() == sendAIOCB::TYPE_ID
+         &&
+         &aiocb.get_socket() == &first.get_socket()
+         &&
+         static_cast<int>(static_cast<sendAIOCB&>(aiocb).get_flags())
+         ==
+         static_cast<int>(first.get_flags());
+}
+
+void
+NBIOQueue::complete(
+  AIOCBState*& aiocb_state,
+  SocketState& socket_state
+) {
+  AIOCBState* completed_aiocb_state = aiocb_state;
+  AIOCB& aiocb = *completed_aiocb_state->aiocb;
+  disarm_deadline(aiocb);
+  aiocb_state = completed_aiocb_state->next_aiocb_state;
+  completed_aiocb_state->next_aiocb_state = NULL;
+  if (completed_aiocb_state->zerocopy_pending()) {
+    defer_completion(*completed_aiocb_state, socket_state);
+  } else {
+    completed_aiocb_state->aiocb = NULL;
+    delete completed_aiocb_state;
+    completed_aiocbs.push_back(&aiocb);
+  }
+}
+
+void
+NBIOQueue::defer_completion(
+  AIOCBState& aiocb_state,
+  SocketState& socket_state
+) {
+  AIOCBState** zerocopy_aiocb_state = &socket_state.zerocopy_aiocb_state;
+  while (*zerocopy_aiocb_state != NULL) {
+    zerocopy_aiocb_state = &(*zerocopy_aiocb_state)->next_aiocb_state;
+  }
+  *zerocopy_aiocb_state = &aiocb_state;
+}
+
+void NBIOQueue::disarm_deadline(AIOCB& aiocb) {
+  if (aiocb.deadline_timer_event != NULL) {
+    fd_event_queue.cancel_timer(*aiocb.deadline_timer_event);
+    TimerEvent::dec_ref(*aiocb.deadline_timer_event);
+    aiocb.deadline_timer_event = NULL;
   }
 }
 
@@ -143,38 +513,54 @@ uint8_t NBIOQueue::get_aiocb_priority(const AIOCB& aiocb) {
     return 2;
   case sendfileAIOCB::TYPE_ID:
     return 2;
+  case spliceAIOCB::TYPE_ID:
+    return static_cast<const spliceAIOCB&>(aiocb).is_from_socket() ? 3 : 2;
   default:
     debug_break();
     return 0;
   }
 }
 
+bool NBIOQueue::is_zerocopy(const AIOCB& aiocb) {
+#ifdef MSG_ZEROCOPY
+  return aiocb.get_type_id() == sendAIOCB::TYPE_ID
+         &&
+         (
+           static_cast<const sendAIOCB&>(aiocb).get_flags()
+           &
+           MSG_ZEROCOPY
+         ) == MSG_ZEROCOPY;
+#else
+  return false;
+#endif
+}
+
 template <class AIOCBType> void NBIOQueue::log_completion(AIOCBType& aiocb) {
   if (log != NULL) {
-    log->get_stream(Log::Level::DEBUG) <<
-                                       get_type_name() << ": completed " << aiocb;
+    Log::Stream log_stream = log->get_stream(Log::Level::DEBUG);
+    log_stream << get_type_name() << ": completed " << aiocb;
   }
 }
 
 template <class AIOCBType> void NBIOQueue::log_error(AIOCBType& aiocb) {
   if (log != NULL) {
-    log->get_stream(Log::Level::DEBUG) <<
-                                       get_type_name() << ": error on " << aiocb;
+    Log::Stream log_stream = log->get_stream(Log::Level::DEBUG);
+    log_stream << get_type_name() << ": error on " << aiocb;
   }
 }
 
 template <class AIOCBType>
 void NBIOQueue::log_partial_send(AIOCBType& aiocb, size_t partial_send_len) {
   if (log != NULL) {
-    log->get_stream(Log::Level::DEBUG) <<
-                                       get_type_name() << ": partial send (" << partial_send_len << ") on " << aiocb;
+    Log::Stream log_stream = log->get_stream(Log::Level::DEBUG);
+    log_stream << get_type_name() << ": partial send (" << partial_send_len << ") on " << aiocb;
   }
 }
 
 template <class AIOCBType> void NBIOQueue::log_retry(AIOCBType& aiocb) {
   if (log != NULL) {
-    log->get_stream(Log::Level::DEBUG) <<
-                                       get_type_name() << ": retrying " << aiocb;
+    Log::Stream log_stream = log->get_stream(Log::Level::DEBUG);
+    log_stream << get_type_name() << ": retrying " << aiocb;
   }
 }
 
@@ -189,17 +575,93 @@ void NBIOQueue::log_wouldblock(AIOCBType& aiocb, RetryStatus retry_status) {
     case RETRY_STATUS_WANT_SEND:
       retry_status_str = "write";
       break;
+    case RETRY_STATUS_WANT_SPLICE_READ:
+      retry_status_str = "splice read";
+      break;
+    case RETRY_STATUS_WANT_SPLICE_WRITE:
+      retry_status_str = "splice write";
+      break;
     default:
       debug_break();
       retry_status_str = "";
       break;
     }
 
-    log->get_stream(Log::Level::DEBUG) <<
-                                       get_type_name() << ": " <<
-                                       aiocb << " would block on " << retry_status_str;
+    Log::Stream log_stream = log->get_stream(Log::Level::DEBUG);
+    log_stream << get_type_name() << ": " <<
+               aiocb << " would block on " << retry_status_str;
+  }
+}
+
+#ifdef __linux__
+void
+NBIOQueue::recv_zerocopy_notifications(
+  fd_t fd,
+  SocketState& socket_state
+) {
+  for (;;) {
+    char
+    control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+    msghdr msghdr_;
+    memset(&msghdr_, 0, sizeof(msghdr_));
+    msghdr_.msg_control = control;
+    msghdr_.msg_controllen = sizeof(control);
+    if (::recvmsg(fd, &msghdr_, MSG_ERRQUEUE) == -1) {
+      break; // Empty
+    }
+
+    for (
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&msghdr_);
+      cmsg != NULL;
+      cmsg = CMSG_NXTHDR(&msghdr_, cmsg)
+    ) {
+      if (
+        !(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+        &&
+        !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)
+      ) {
+        continue;
+      }
+
+      const sock_extended_err* ee
+      = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+
+      // The kernel is done with the pages of sends [ee_info, ee_data].
+      for (
+        AIOCBState* aiocb_state = socket_state.aiocb_state[2];
+        aiocb_state != NULL;
+        aiocb_state = aiocb_state->next_aiocb_state
+      ) {
+        aiocb_state->add_zerocopy_ids_done(ee->ee_info, ee->ee_data);
+      }
+      for (
+        AIOCBState* aiocb_state = socket_state.zerocopy_aiocb_state;
+        aiocb_state != NULL;
+        aiocb_state = aiocb_state->next_aiocb_state
+      ) {
+        aiocb_state->add_zerocopy_ids_done(ee->ee_info, ee->ee_data);
+      }
+    }
+  }
+
+  AIOCBState** aiocb_state = &socket_state.zerocopy_aiocb_state;
+  while (*aiocb_state != NULL) {
+    if ((*aiocb_state)->zerocopy_pending()) {
+      aiocb_state = &(*aiocb_state)->next_aiocb_state;
+    } else {
+      AIOCBState* completed_aiocb_state = *aiocb_state;
+      *aiocb_state = completed_aiocb_state->next_aiocb_state;
+      completed_aiocbs.push_back(completed_aiocb_state->aiocb);
+      completed_aiocb_state->aiocb = NULL;
+      completed_aiocb_state->next_aiocb_state = NULL;
+      delete completed_aiocb_state;
+    }
   }
 }
+#endif
 
 NBIOQueue::RetryStatus NBIOQueue::retry(AIOCB& aiocb, size_t& partial_send_len) {
   switch (aiocb.get_type_id()) {
@@ -261,6 +723,148 @@ NBIOQueue::RetryStatus NBIOQueue::retry_accept(acceptAIOCB& accept_aiocb) {
   return RETRY_STATUS_ERROR;
 }
 
+void
+NBIOQueue::retry(
+  map<fd_t, SocketState*>::iterator socket_state_i,
+  FDEvent::Type ready_fd_event_types
+) {
+  fd_t fd = socket_state_i->first;
+  SocketState* socket_state = socket_state_i->second;
+
+#ifdef __linux__
+  // The kernel's zero-copy send notifications wait in the error queue.
+  if ((ready_fd_event_types & FDEvent::TYPE_ERROR) != 0) {
+    recv_zerocopy_notifications(fd, *socket_state);
+  }
+#endif
+
+  // Errors and hangups are reported to whichever operation retries first.
+  if (
+    (ready_fd_event_types & (FDEvent::TYPE_ERROR | FDEvent::TYPE_HUP))
+    != 0
+  ) {
+    ready_fd_event_types |= FDEvent::TYPE_READ_READY;
+    ready_fd_event_types |= FDEvent::TYPE_WRITE_READY;
+  }
+
+  FDEvent::Type want_fd_event_types = 0;
+
+  for (uint8_t aiocb_priority = 0; aiocb_priority < 4; ++aiocb_priority) {
+    // Sends and recvs wait on a pending accept or connect, but otherwise
+    // proceed independently of each other.
+    if (
+      aiocb_priority == 2
+      &&
+      (
+        socket_state->aiocb_state[0] != NULL
+        ||
+        socket_state->aiocb_state[1] != NULL
+      )
+    ) {
+      break;
+    }
+
+    // Retry the AIOCBs in order until one would block.
+    for (;;) {
+      AIOCBState* aiocb_state = socket_state->aiocb_state[aiocb_priority];
+      if (aiocb_state == NULL) {
+        break;
+      }
+
+      // A splice waiting on its descriptor is retried when that's ready.
+      if (aiocb_state->want_splice_fd) {
+        break;
+      }
+
+      if (
+        aiocb_state->want_fd_event_types != 0
+        &&
+        (aiocb_state->want_fd_event_types & ready_fd_event_types) == 0
+      ) {
+        want_fd_event_types |= aiocb_state->want_fd_event_types;
+        break;
+      }
+
+      RetryStatus retry_status;
+      if (aiocb_state->aiocb->get_type_id() == spliceAIOCB::TYPE_ID) {
+        retry_status = retry_splice(*aiocb_state);
+      } else if (
+        is_zerocopy(*aiocb_state->aiocb)
+        ||
+        (
+          aiocb_state->next_aiocb_state != NULL
+          &&
+          aiocb_state->aiocb->get_type_id() == sendAIOCB::TYPE_ID
+          &&
+          can_coalesce(
+            static_cast<sendAIOCB&>(*aiocb_state->aiocb),
+            *aiocb_state->next_aiocb_state->aiocb
+          )
+        )
+      ) {
+        retry_status = retry_sendmsg(*socket_state);
+        aiocb_state = socket_state->aiocb_state[aiocb_priority];
+      } else {
+        retry_status
+        = retry(*aiocb_state->aiocb, aiocb_state->partial_send_len);
+      }
+
+      if (retry_status == RETRY_STATUS_WANT_RECV) {
+        aiocb_state->want_fd_event_types = FDEvent::TYPE_READ_READY;
+      } else if (retry_status == RETRY_STATUS_WANT_SEND) {
+        aiocb_state->want_fd_event_types = FDEvent::TYPE_WRITE_READY;
+      } else if (
+        retry_status == RETRY_STATUS_WANT_SPLICE_READ
+        ||
+        retry_status == RETRY_STATUS_WANT_SPLICE_WRITE
+      ) {
+        fd_t splice_fd
+        = static_cast<spliceAIOCB*>(aiocb_state->aiocb)->get_fd();
+        bool associate_ret
+        = fd_event_queue.associate(
+            splice_fd,
+            retry_status == RETRY_STATUS_WANT_SPLICE_READ
+            ? FDEvent::TYPE_READ_READY
+            : FDEvent::TYPE_WRITE_READY
+          );
+        debug_assert_true(associate_ret);
+        splice_fds[splice_fd] = fd;
+        aiocb_state->want_fd_event_types = 0;
+        aiocb_state->want_splice_fd = true;
+        arm_deadline(*aiocb_state->aiocb);
+        break;
+      } else {
+        complete(socket_state->aiocb_state[aiocb_priority], *socket_state);
+        continue;
+      }
+
+      // The AIOCB has been started, so its timeout runs from now on.
+      arm_deadline(*aiocb_state->aiocb);
+      want_fd_event_types |= aiocb_state->want_fd_event_types;
+      break;
+    }
+  }
+
+  if (socket_state->zerocopy_aiocb_state != NULL) {
+    want_fd_event_types |= FDEvent::TYPE_ERROR;
+  }
+
+  if (socket_state->empty()) {
+    delete socket_state;
+    this->socket_state.erase(socket_state_i);
+    fd_event_queue.dissociate(fd);
+  } else if (want_fd_event_types != socket_state->associated_fd_event_types) {
+    if (want_fd_event_types != 0) {
+      bool associate_ret = fd_event_queue.associate(fd, want_fd_event_types);
+      debug_assert_true(associate_ret);
+    } else {
+      // Only waiting on splice descriptors.
+      fd_event_queue.dissociate(fd);
+    }
+    socket_state->associated_fd_event_types = want_fd_event_types;
+  }
+}
+
 NBIOQueue::RetryStatus
 NBIOQueue::retry_connect(
   connectAIOCB& connect_aiocb,
@@ -274,6 +878,7 @@ NBIOQueue::retry_connect(
         return retry_send(
                  connect_aiocb,
                  *connect_aiocb.get_send_buffer(),
+                 0,
                  partial_send_len
                );
       } else {
@@ -296,17 +901,47 @@ NBIOQueue::RetryStatus NBIOQueue::retry_recv(recvAIOCB& recv_aiocb) {
   log_retry(recv_aiocb);
 
   if (recv_aiocb.get_socket().set_blocking_mode(false)) {
+    Buffer* recv_buffer;
+    if (recv_aiocb.has_buffer()) {
+      recv_buffer = &recv_aiocb.get_buffer();
+    } else {
+      // Lend the buffer for this attempt only; it's given to the recvAIOCB
+      // if the recv completes, otherwise it's kept for the next attempt.
+      size_t buffer_capacity = recv_aiocb.get_buffer_capacity();
+      if (
+        spare_recv_buffer != NULL
+        &&
+        spare_recv_buffer->capacity() == buffer_capacity
+      ) {
+        recv_buffer = spare_recv_buffer;
+      } else {
+        Buffer::dec_ref(spare_recv_buffer);
+        if (buffer_capacity % Buffer::getpagesize() == 0) {
+          recv_buffer = new Buffer(Buffer::getpagesize(), buffer_capacity);
+        } else {
+          recv_buffer = new Buffer(buffer_capacity);
+        }
+      }
+      spare_recv_buffer = NULL;
+    }
+
     ssize_t recv_ret
-    = recv_aiocb.get_socket().recv(
-        recv_aiocb.get_buffer(),
-        recv_aiocb.get_flags()
-      );
+    = recv_aiocb.get_socket().recv(*recv_buffer, recv_aiocb.get_flags());
 
     if (recv_ret >= 0) {
+      if (!recv_aiocb.has_buffer()) {
+        recv_aiocb.set_buffer(*recv_buffer);
+      }
       recv_aiocb.set_return(recv_ret);
       log_completion(recv_aiocb);
       return RETRY_STATUS_COMPLETE;
-    } else if (recv_aiocb.get_socket().want_recv()) {
+    }
+
+    if (!recv_aiocb.has_buffer()) {
+      spare_recv_buffer = recv_buffer;
+    }
+
+    if (recv_aiocb.get_socket().want_recv()) {
       log_wouldblock(recv_aiocb, RETRY_STATUS_WANT_RECV);
       return RETRY_STATUS_WANT_RECV;
     } else if (recv_aiocb.get_socket().want_send()) {
@@ -328,7 +963,12 @@ NBIOQueue::retry_send(
   log_retry(send_aiocb);
 
   if (send_aiocb.get_socket().set_blocking_mode(false)) {
-    return retry_send(send_aiocb, send_aiocb.get_buffer(), partial_send_len);
+    return retry_send(
+             send_aiocb,
+             send_aiocb.get_buffer(),
+             send_aiocb.get_flags(),
+             partial_send_len
+           );
   } else {
     send_aiocb.set_error(Exception::get_last_error_code());
     log_error(send_aiocb);
@@ -341,6 +981,7 @@ NBIOQueue::RetryStatus
 NBIOQueue::retry_send(
   AIOCBType& aiocb,
   const Buffer& buffer,
+  const Socket::MessageFlags& flags,
   size_t& partial_send_len
 ) {
   ssize_t complete_send_ret, send_ret;
@@ -350,13 +991,13 @@ NBIOQueue::retry_send(
     = aiocb.get_socket().send(
         static_cast<const char*>(buffer) + partial_send_len,
         buffer.size() - partial_send_len,
-        0
+        flags
       );
   } else {
     vector<iovec> iov;
     complete_send_ret
     = Buffers::as_write_iovecs(buffer, partial_send_len, iov);
-    send_ret = aiocb.get_socket().sendmsg(&iov[0], iov.size(), 0);
+    send_ret = aiocb.get_socket().sendmsg(&iov[0], iov.size(), flags);
   }
 
   if (send_ret >= 0) {
@@ -383,6 +1024,244 @@ NBIOQueue::retry_send(
   }
 }
 
+NBIOQueue::RetryStatus NBIOQueue::retry_sendmsg(SocketState& socket_state) {
+  AIOCBState*& aiocb_state = socket_state.aiocb_state[2];
+  sendAIOCB& send_aiocb = static_cast<sendAIOCB&>(*aiocb_state->aiocb);
+  log_retry(send_aiocb);
+
+  if (!send_aiocb.get_socket().set_blocking_mode(false)) {
+    send_aiocb.set_error(Exception::get_last_error_code());
+    log_error(send_aiocb);
+    return RETRY_STATUS_ERROR;
+  }
+
+  // Gather the unsent buffers of the sendAIOCBs at the head of the queue.
+  // An AIOCB whose buffers don't all fit in SENDMSG_IOV_MAX iovecs is sent
+  // in part and can't complete this time around.
+  vector<iovec> iov;
+  vector<size_t> unsent_lens;
+  for (
+    AIOCBState* next_aiocb_state = aiocb_state;
+    next_aiocb_state != NULL
+    &&
+    iov.size() < SENDMSG_IOV_MAX
+    &&
+    can_coalesce(send_aiocb, *next_aiocb_state->aiocb);
+    next_aiocb_state = next_aiocb_state->next_aiocb_state
+  ) {
+    unsent_lens.push_back(
+      Buffers::as_write_iovecs(
+        static_cast<sendAIOCB*>(next_aiocb_state->aiocb)->get_buffer(),
+        next_aiocb_state->partial_send_len,
+        iov
+      )
+    );
+  }
+  if (iov.size() > SENDMSG_IOV_MAX) {
+    iov.resize(SENDMSG_IOV_MAX);
+  }
+
+  Socket& socket_ = send_aiocb.get_socket();
+  uint32_t zerocopy_id = socket_.get_zerocopy_send_count();
+  ssize_t sendmsg_ret
+  = iov.empty()
+    ? 0
+    : socket_.sendmsg(
+        &iov[0],
+        static_cast<int>(iov.size()),
+        send_aiocb.get_flags()
+      );
+
+#ifdef __linux__
+  // The kernel refuses zero-copy sends when it's short of memory for
+  // their notifications. Fall back to copying on this socket.
+  if (
+    sendmsg_ret < 0
+    &&
+    Exception::get_last_error_code() == ENOBUFS
+    &&
+    is_zerocopy(send_aiocb)
+    &&
+    socket_.setsockopt(Socket::Option::ZEROCOPY, false)
+  ) {
+    sendmsg_ret
+    = socket_.sendmsg(
+        &iov[0],
+        static_cast<int>(iov.size()),
+        send_aiocb.get_flags()
+      );
+  }
+#endif
+
+  bool zerocopy = socket_.get_zerocopy_send_count() != zerocopy_id;
+
+  if (sendmsg_ret < 0) {
+    if (send_aiocb.get_socket().want_send()) {
+      log_wouldblock(send_aiocb, RETRY_STATUS_WANT_SEND);
+      return RETRY_STATUS_WANT_SEND;
+    } else if (send_aiocb.get_socket().want_recv()) {
+      log_wouldblock(send_aiocb, RETRY_STATUS_WANT_RECV);
+      return RETRY_STATUS_WANT_RECV;
+    } else {
+      send_aiocb.set_error(Exception::get_last_error_code());
+      log_error(send_aiocb);
+      return RETRY_STATUS_ERROR;
+    }
+  }
+
+  // Apportion the sent bytes to the AIOCBs in order, completing all but
+  // the last fully-sent AIOCB, which is left for the caller.
+  size_t sent_len = static_cast<size_t>(sendmsg_ret);
+  for (size_t unsent_len_i = 0; ; ++unsent_len_i) {
+    sendAIOCB& next_send_aiocb
+    = static_cast<sendAIOCB&>(*aiocb_state->aiocb);
+    size_t unsent_len = unsent_lens[unsent_len_i];
+
+    if (zerocopy && sent_len > 0 && unsent_len > 0) {
+      aiocb_state->add_zerocopy_id(zerocopy_id);
+    }
+
+    if (sent_len < unsent_len) {
+      aiocb_state->partial_send_len += sent_len;
+      log_partial_send(next_send_aiocb, aiocb_state->partial_send_len);
+      return RETRY_STATUS_WANT_SEND;
+    }
+
+    sent_len -= unsent_len;
+    aiocb_state->partial_send_len += unsent_len;
+    next_send_aiocb.set_return(aiocb_state->partial_send_len);
+    log_completion(next_send_aiocb);
+
+    if (unsent_len_i + 1 == unsent_lens.size()) {
+      return RETRY_STATUS_COMPLETE;
+    }
+
+    complete(aiocb_state, socket_state);
+  }
+}
+
+NBIOQueue::RetryStatus NBIOQueue::retry_splice(AIOCBState& aiocb_state) {
+  spliceAIOCB& splice_aiocb = static_cast<spliceAIOCB&>(*aiocb_state.aiocb);
+  log_retry(splice_aiocb);
+
+#ifdef __linux__
+  if (!splice_aiocb.get_socket().set_blocking_mode(false)) {
+    splice_aiocb.set_error(Exception::get_last_error_code());
+    log_error(splice_aiocb);
+    return RETRY_STATUS_ERROR;
+  }
+
+  if (aiocb_state.pipe_fds[0] == INVALID_FD) {
+    int fl = fcntl(splice_aiocb.get_fd(), F_GETFL);
+    if (fl != -1 && (fl & O_NONBLOCK) == 0) {
+      if (fcntl(splice_aiocb.get_fd(), F_SETFL, fl | O_NONBLOCK) == 0) {
+        aiocb_state.splice_fd_flags = fl;
+      } else {
+        fl = -1;
+      }
+    }
+
+    if (fl == -1 || !borrow_pipe(aiocb_state)) {
+      splice_aiocb.set_error(Exception::get_last_error_code());
+      aiocb_state.restore_splice_fd_flags();
+      log_error(splice_aiocb);
+      return RETRY_STATUS_ERROR;
+    }
+  }
+
+  if (splice_sigpipe_mask == -1) {
+    splice_sigpipe_mask = is_sigpipe_handled() ? 1 : 0;
+  }
+
+  fd_t from_fd, to_fd;
+  if (splice_aiocb.is_from_socket()) {
+    from_fd = splice_aiocb.get_socket();
+    to_fd = splice_aiocb.get_fd();
+  } else {
+    from_fd = splice_aiocb.get_fd();
+    to_fd = splice_aiocb.get_socket();
+  }
+  size_t& moved_len = aiocb_state.partial_send_len;
+
+  for (;;) {
+    // Fill the pipe from the source.
+    bool want_from_fd = false;
+    size_t unfilled_len
+    = splice_aiocb.get_nbytes() - moved_len - aiocb_state.pipe_len;
+    if (!aiocb_state.splice_eof && unfilled_len > 0) {
+      ssize_t splice_ret
+      = splice(
+          from_fd,
+          NULL,
+          aiocb_state.pipe_fds[1],
+          NULL,
+          unfilled_len < SPLICE_LEN_MAX ? unfilled_len : SPLICE_LEN_MAX,
+          SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+        );
+      if (splice_ret > 0) {
+        aiocb_state.pipe_len += static_cast<size_t>(splice_ret);
+      } else if (splice_ret == 0) {
+        aiocb_state.splice_eof = true;
+      } else if (errno == EAGAIN) {
+        // The source is empty or the pipe is full.
+        want_from_fd = true;
+      } else {
+        break;
+      }
+    }
+
+    // Drain the pipe to the sink.
+    if (aiocb_state.pipe_len > 0) {
+      ssize_t splice_ret
+      = splice_nosignal(
+          aiocb_state.pipe_fds[0],
+          to_fd,
+          aiocb_state.pipe_len,
+          splice_sigpipe_mask == 1
+        );
+
+      if (splice_ret > 0) {
+        aiocb_state.pipe_len -= static_cast<size_t>(splice_ret);
+        moved_len += static_cast<size_t>(splice_ret);
+        log_partial_send(splice_aiocb, moved_len);
+        continue;
+      } else if (splice_ret == -1 && errno == EAGAIN) {
+        RetryStatus retry_status
+        = splice_aiocb.is_from_socket()
+          ? RETRY_STATUS_WANT_SPLICE_WRITE
+          : RETRY_STATUS_WANT_SEND;
+        log_wouldblock(splice_aiocb, retry_status);
+        return retry_status;
+      } else {
+        break;
+      }
+    }
+
+    if (aiocb_state.splice_eof || moved_len == splice_aiocb.get_nbytes()) {
+      return_pipe(aiocb_state);
+      aiocb_state.restore_splice_fd_flags();
+      splice_aiocb.set_return(moved_len);
+      log_completion(splice_aiocb);
+      return RETRY_STATUS_COMPLETE;
+    } else if (want_from_fd) {
+      RetryStatus retry_status
+      = splice_aiocb.is_from_socket()
+        ? RETRY_STATUS_WANT_RECV
+        : RETRY_STATUS_WANT_SPLICE_READ;
+      log_wouldblock(splice_aiocb, retry_status);
+      return retry_status;
+    }
+  }
+
+  splice_aiocb.set_error(Exception::get_last_error_code());
+  aiocb_state.restore_splice_fd_flags();
+#else
+  splice_aiocb.set_error(ENOSYS);
+#endif
+  log_error(splice_aiocb);
+  return RETRY_STATUS_ERROR;
+}
+
 NBIOQueue::RetryStatus
 NBIOQueue::retry_sendfile(
   sendfileAIOCB& sendfile_aiocb,
@@ -423,11 +1302,26 @@ NBIOQueue::retry_sendfile(
   return RETRY_STATUS_ERROR;
 }
 
+void NBIOQueue::return_pipe(AIOCBState& aiocb_state) {
+  if (spare_pipes.size() < SPARE_PIPES_MAX) {
+    spare_pipes.push_back(
+      std::make_pair(aiocb_state.pipe_fds[0], aiocb_state.pipe_fds[1])
+    );
+    aiocb_state.pipe_fds[0] = aiocb_state.pipe_fds[1] = INVALID_FD;
+  }
+}
+
 Event* NBIOQueue::timeddequeue(const Time& timeout) {
   Time timeout_remaining = timeout;
 
   for (;;) {
-    Time start_time = Time::now();
+    if (!completed_aiocbs.empty()) {
+      AIOCB* aiocb = completed_aiocbs.front();
+      completed_aiocbs.pop_front();
+      return aiocb;
+    }
+
+    Time start_time = Time::monotonic_now();
 
     Event* event = fd_event_queue.timeddequeue(timeout_remaining);
 
@@ -436,59 +1330,44 @@ Event* NBIOQueue::timeddequeue(const Time& timeout) {
       case FDEvent::TYPE_ID: {
         FDEvent* fd_event = static_cast<FDEvent*>(event);
         fd_t fd = fd_event->get_fd();
+        FDEvent::Type fd_event_type = fd_event->get_type();
         FDEvent::dec_ref(*fd_event);
 
         map<fd_t, SocketState*>::iterator socket_state_i
         = this->socket_state.find(fd);
-        debug_assert_ne(socket_state_i, this->socket_state.end());
-        SocketState* socket_state = socket_state_i->second;
-
-        uint16_t want_fd_event_types = 0;
-
-        for (uint8_t aiocb_priority = 0; aiocb_priority < 4; ++aiocb_priority) {
-          AIOCBState* aiocb_state = socket_state->aiocb_state[aiocb_priority];
-          if (aiocb_state != NULL) {
-            AIOCB* aiocb = aiocb_state->aiocb;
-            size_t& partial_send_len = aiocb_state->partial_send_len;
-            RetryStatus retry_status = retry(*aiocb, partial_send_len);
-
-            if (
-              retry_status == RETRY_STATUS_COMPLETE
-              ||
-              retry_status == RETRY_STATUS_ERROR
+        if (socket_state_i != this->socket_state.end()) {
+          retry(socket_state_i, fd_event_type);
+          break;
+        }
+
+        // The descriptor of a spliceAIOCB: retry the spliceAIOCB's socket.
+        map<fd_t, fd_t>::iterator splice_fd_i = splice_fds.find(fd);
+        debug_assert_ne(splice_fd_i, splice_fds.end());
+        if (splice_fd_i != splice_fds.end()) {
+          fd_event_queue.dissociate(fd);
+          socket_state_i = this->socket_state.find(splice_fd_i->second);
+          splice_fds.erase(splice_fd_i);
+          if (socket_state_i != this->socket_state.end()) {
+            for (
+              uint8_t aiocb_priority = 2;
+              aiocb_priority < 4;
+              ++aiocb_priority
             ) {
-              aiocb_state->aiocb = NULL;
-
-              if (aiocb_state->next_aiocb_state == NULL) {
-                socket_state->aiocb_state[aiocb_priority] = NULL;
-
-                if (socket_state->empty()) {
-                  delete socket_state;
-                  this->socket_state.erase(socket_state_i);
-                  fd_event_queue.dissociate(fd);
-                }
-              } else {
-                socket_state->aiocb_state[aiocb_priority]
-                = aiocb_state->next_aiocb_state;
-                aiocb_state->next_aiocb_state = NULL;
-                delete aiocb_state;
+              AIOCBState* aiocb_state
+              = socket_state_i->second->aiocb_state[aiocb_priority];
+              if (
+                aiocb_state != NULL
+                &&
+                aiocb_state->want_splice_fd
+                &&
+                static_cast<spliceAIOCB*>(aiocb_state->aiocb)->get_fd() == fd
+              ) {
+                aiocb_state->want_splice_fd = false;
               }
-
-              return aiocb;
-            } else if (retry_status == RETRY_STATUS_WANT_RECV) {
-              want_fd_event_types |= FDEvent::TYPE_READ_READY;
-              break;
-            } else if (retry_status == RETRY_STATUS_WANT_SEND) {
-              want_fd_event_types |= FDEvent::TYPE_WRITE_READY;
-              break;
             }
+            retry(socket_state_i, 0);
           }
         }
-
-        debug_assert_ne(want_fd_event_types, 0);
-        bool associate_ret
-        = fd_event_queue.associate(fd, want_fd_event_types);
-        debug_assert_true(associate_ret);
       }
       break;
 
@@ -496,13 +1375,21 @@ Event* NBIOQueue::timeddequeue(const Time& timeout) {
       case connectAIOCB::TYPE_ID:
       case recvAIOCB::TYPE_ID:
       case sendAIOCB::TYPE_ID:
-      case sendfileAIOCB::TYPE_ID: {
+      case sendfileAIOCB::TYPE_ID:
+      case spliceAIOCB::TYPE_ID: {
         AIOCB* aiocb = static_cast<AIOCB*>(event);
+        uint8_t aiocb_priority = get_aiocb_priority(*aiocb);
 
         map<fd_t, SocketState*>::iterator socket_state_i
         = this->socket_state.find(aiocb->get_socket());
 
-        if (socket_state_i == this->socket_state.end()) {
+        if (
+          socket_state_i == this->socket_state.end()
+          &&
+          !is_zerocopy(*aiocb)
+          &&
+          aiocb->get_type_id() != spliceAIOCB::TYPE_ID
+        ) {
           size_t partial_send_len = 0;
           RetryStatus retry_status = retry(*aiocb, partial_send_len);
           switch (retry_status) {
@@ -510,59 +1397,74 @@ Event* NBIOQueue::timeddequeue(const Time& timeout) {
           case RETRY_STATUS_ERROR:
             return aiocb;
           default: {
-            AIOCBState* aiocb_state = new AIOCBState(*aiocb, partial_send_len);
+            FDEvent::Type want_fd_event_types
+            = retry_status == RETRY_STATUS_WANT_RECV
+              ? FDEvent::TYPE_READ_READY
+              : FDEvent::TYPE_WRITE_READY;
             SocketState* socket_state = new SocketState();
-            uint8_t aiocb_priority = get_aiocb_priority(*aiocb);
-            socket_state->aiocb_state[aiocb_priority] = aiocb_state;
+            socket_state->aiocb_state[aiocb_priority]
+            = new AIOCBState(*aiocb, partial_send_len, want_fd_event_types);
             this->socket_state[aiocb->get_socket()] = socket_state;
-            associate(*aiocb, retry_status);
+            bool associate_ret
+            = fd_event_queue.associate(
+                aiocb->get_socket(),
+                want_fd_event_types
+              );
+            debug_assert_true(associate_ret);
+            socket_state->associated_fd_event_types = want_fd_event_types;
+            arm_deadline(*aiocb);
           }
           break;
           }
         } else {
+          // Queue aiocb behind any AIOCBs of the same kind, then retry
+          // whatever hasn't been tried yet: aiocb itself if it's at the head
+          // of its queue and not waiting on an accept or connect.
+          if (socket_state_i == this->socket_state.end()) {
+            // A zero-copy send waits for the kernel to be done with its
+            // buffer even if it completes now, and a splice keeps its pipe
+            // in its AIOCBState.
+            socket_state_i
+            = this->socket_state.insert(
+                map<fd_t, SocketState*>::value_type(
+                  aiocb->get_socket(),
+                  new SocketState()
+                )
+              ).first;
+          }
           SocketState* socket_state = socket_state_i->second;
-
-          uint8_t aiocb_priority = get_aiocb_priority(*aiocb);
-
-          // Check if there's already an AIOCB with an equal or higher priority
-          // on this socket. If not, retry aiocb.
-          bool should_retry_aiocb = true;
-          for (
-            int8_t check_aiocb_priority = aiocb_priority;
-            check_aiocb_priority >= 0;
-            --check_aiocb_priority
-          ) {
-            if (socket_state->aiocb_state[check_aiocb_priority] != NULL) {
-              should_retry_aiocb = false;
-              break;
-            }
+          AIOCBState** aiocb_state
+          = &socket_state->aiocb_state[aiocb_priority];
+          while (*aiocb_state != NULL) {
+            aiocb_state = &(*aiocb_state)->next_aiocb_state;
           }
+          // The deadline is armed once retry starts aiocb.
+          *aiocb_state = new AIOCBState(*aiocb, 0);
+          retry(socket_state_i, 0);
+        }
+      }
+      break;
 
-          size_t partial_send_len = 0;
-          if (should_retry_aiocb) {
-            RetryStatus retry_status = retry(*aiocb, partial_send_len);
-            switch (retry_status) {
-            case RETRY_STATUS_COMPLETE:
-            case RETRY_STATUS_ERROR:
-              debug_assert_false(socket_state->empty());
-              return aiocb;
-            default:
-              associate(*aiocb, retry_status);
-              break;
-            }
-          }
+      case CancelEvent::TYPE_ID: {
+        CancelEvent* cancel_event = static_cast<CancelEvent*>(event);
+        AIOCB* aiocb
+        = abandon(cancel_event->get_aiocb(), AIOCB::Error::CANCELED);
+        CancelEvent::dec_ref(*cancel_event);
+        if (aiocb != NULL) {
+          return aiocb;
+        }
+      }
+      break;
 
-          AIOCBState* aiocb_state = new AIOCBState(*aiocb, partial_send_len);
-          if (socket_state->aiocb_state[aiocb_priority] == NULL) {
-            socket_state->aiocb_state[aiocb_priority] = aiocb_state;
-          } else {
-            AIOCBState* last_aiocb_state
-            = socket_state->aiocb_state[aiocb_priority];
-            while (last_aiocb_state->next_aiocb_state != NULL) {
-              last_aiocb_state = last_aiocb_state->next_aiocb_state;
-            }
-            last_aiocb_state->next_aiocb_state = aiocb_state;
-          }
+      case TimerEvent::TYPE_ID: {
+        DeadlineTimerEvent* deadline_timer_event
+        = static_cast<DeadlineTimerEvent*>(event);
+        AIOCB& aiocb = deadline_timer_event->get_aiocb();
+        // aiocb still holds a reference to the timer until it's abandoned.
+        TimerEvent::dec_ref(*deadline_timer_event);
+        AIOCB* timed_out_aiocb = abandon(aiocb, AIOCB::Error::TIMED_OUT);
+        if (timed_out_aiocb != NULL) {
+          return timed_out_aiocb;
         }
       }
       break;
@@ -571,7 +1473,7 @@ Event* NBIOQueue::timeddequeue(const Time& timeout) {
         return event;
       }
     } else if (timeout_remaining > static_cast<uint64_t>(0)) {
-      Time elapsed_time = Time::now() - start_time;
+      Time elapsed_time = Time::monotonic_now() - start_time;
       if (timeout_remaining > elapsed_time) {
         timeout_remaining -= elapsed_time;
       } else {
@@ -42,7 +42,13 @@ std::ostream& operator<<(std::ostream& os, recvAIOCB& recv_aiocb) {
   os <<
      recv_aiocb.get_type_name() <<
      "(" <<
-     "buffer=" << recv_aiocb.get_buffer() <<
+     "buffer=";
+  if (recv_aiocb.has_buffer()) {
+    os << recv_aiocb.get_buffer();
+  } else {
+    os << "NULL";
+  }
+  os <<
      ", " <<
      "error=" << recv_aiocb.get_error() <<
      ", " <<
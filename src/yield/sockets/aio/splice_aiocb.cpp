@@ -0,0 +1,136 @@
+// yield/sockets/aio/splice_aiocb.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/exception.hpp"
+#include "yield/sockets/stream_socket.hpp"
+#include "yield/sockets/aio/splice_aiocb.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace yield {
+namespace sockets {
+namespace aio {
+spliceAIOCB::spliceAIOCB(
+  StreamSocket& from_socket,
+  fd_t to_fd,
+  size_t nbytes,
+  Object* context
+) : AIOCB(from_socket, context),
+  from_socket(true),
+  nbytes(nbytes) {
+  init(to_fd);
+}
+
+spliceAIOCB::spliceAIOCB(
+  fd_t from_fd,
+  StreamSocket& to_socket,
+  size_t nbytes,
+  Object* context
+) : AIOCB(to_socket, context),
+  from_socket(false),
+  nbytes(nbytes) {
+  init(from_fd);
+}
+
+spliceAIOCB::spliceAIOCB(
+  StreamSocket& from_socket,
+  StreamSocket& to_socket,
+  size_t nbytes,
+  Object* context
+) : AIOCB(from_socket, context),
+  from_socket(true),
+  nbytes(nbytes) {
+#ifdef _WIN32
+  init(reinterpret_cast<fd_t>(static_cast<socket_t>(to_socket)));
+#else
+  init(to_socket);
+#endif
+}
+
+spliceAIOCB::~spliceAIOCB() {
+#ifdef _WIN32
+  CloseHandle(fd);
+#else
+  close(fd);
+#endif
+}
+
+StreamSocket& spliceAIOCB::get_socket() {
+  return static_cast<StreamSocket&>(AIOCB::get_socket());
+}
+
+void spliceAIOCB::init(fd_t fd) {
+#ifdef _WIN32
+  if (
+    !DuplicateHandle(
+      GetCurrentProcess(),
+      fd,
+      GetCurrentProcess(),
+      &this->fd,
+      0,
+      FALSE,
+      DUPLICATE_SAME_ACCESS
+    )
+  ) {
+    throw Exception();
+  }
+#else
+  this->fd = dup(fd);
+  if (this->fd == -1) {
+    throw Exception();
+  }
+#endif
+}
+
+std::ostream& operator<<(std::ostream& os, spliceAIOCB& splice_aiocb) {
+  os <<
+     splice_aiocb.get_type_name() <<
+     "(" <<
+     "error=" << splice_aiocb.get_error() <<
+     ", " <<
+     "fd=" << splice_aiocb.get_fd() <<
+     ", " <<
+     "from_socket=" << splice_aiocb.is_from_socket() <<
+     ", " <<
+     "nbytes=" << splice_aiocb.get_nbytes() <<
+     ", " <<
+     "return=" << splice_aiocb.get_return() <<
+     ", " <<
+     "socket=" << splice_aiocb.get_socket() <<
+     ")";
+  return os;
+}
+}
+}
+}
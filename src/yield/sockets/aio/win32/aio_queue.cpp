@@ -31,6 +31,7 @@
 #include "yield/debug.hpp"
 #include "yield/buffer.hpp"
 #include "yield/log.hpp"
+#include "yield/timer_event.hpp"
 #include "yield/sockets/stream_socket.hpp"
 #include "yield/sockets/aio/accept_aiocb.hpp"
 #include "yield/sockets/aio/connect_aiocb.hpp"
@@ -47,6 +48,38 @@ static LPFN_CONNECTEX lpfnConnectEx = NULL;
 static LPFN_GETACCEPTEXSOCKADDRS lpfnGetAcceptExSockaddrs = NULL;
 static LPFN_TRANSMITFILE lpfnTransmitFile = NULL;
 
+// Holds a reference to aiocb, since it may fire while another thread
+// dequeues aiocb's completion.
+class AIOQueue::DeadlineTimerEvent : public TimerEvent {
+public:
+  DeadlineTimerEvent(AIOCB& aiocb)
+    : TimerEvent(aiocb.get_timeout()),
+      aiocb(aiocb.inc_ref()),
+      timed_out(false) {
+  }
+
+  ~DeadlineTimerEvent() {
+    AIOCB::dec_ref(aiocb);
+  }
+
+public:
+  AIOCB& get_aiocb() const {
+    return aiocb;
+  }
+
+  bool get_timed_out() const {
+    return timed_out;
+  }
+
+  void set_timed_out() {
+    timed_out = true;
+  }
+
+private:
+  AIOCB& aiocb;
+  bool timed_out;
+};
+
 AIOQueue::AIOQueue(YO_NEW_REF Log* log) : log(log) {
   hIoCompletionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
   if (hIoCompletionPort == INVALID_HANDLE_VALUE) {
@@ -67,7 +100,84 @@ bool AIOQueue::associate(socket_t socket_) {
          ) != INVALID_HANDLE_VALUE;
 }
 
+void AIOQueue::arm_deadline(AIOCB& aiocb) {
+  if (aiocb.get_timeout() != Time::FOREVER) {
+    aiocb.deadline_timer_event = new DeadlineTimerEvent(aiocb);
+    timer_wheel_lock.lock();
+    timer_wheel.arm(aiocb.deadline_timer_event->inc_ref());
+    timer_wheel_lock.unlock();
+  }
+}
+
+bool AIOQueue::cancel(AIOCB& aiocb) {
+  return CancelIoEx(
+           reinterpret_cast<HANDLE>(static_cast<socket_t>(aiocb.get_socket())),
+           aiocb
+         ) == TRUE;
+}
+
+bool AIOQueue::disarm_deadline(AIOCB& aiocb) {
+  bool timed_out = false;
+  if (aiocb.deadline_timer_event != NULL) {
+    DeadlineTimerEvent* deadline_timer_event
+    = static_cast<DeadlineTimerEvent*>(aiocb.deadline_timer_event);
+    aiocb.deadline_timer_event = NULL;
+
+    // Wait out a concurrent expire_deadlines, which may be canceling aiocb.
+    timer_wheel_lock.lock();
+    timer_wheel.cancel(*deadline_timer_event);
+    timed_out = deadline_timer_event->get_timed_out();
+    timer_wheel_lock.unlock();
+
+    TimerEvent::dec_ref(*deadline_timer_event);
+  }
+  return timed_out;
+}
+
 bool AIOQueue::enqueue(YO_NEW_REF Event& event) {
+  switch (event.get_type_id()) {
+  case acceptAIOCB::TYPE_ID:
+  case connectAIOCB::TYPE_ID:
+  case recvAIOCB::TYPE_ID:
+  case sendAIOCB::TYPE_ID:
+  case sendfileAIOCB::TYPE_ID: {
+    // Arm before starting the operation, so its completion can't be
+    // dequeued before the deadline exists.
+    AIOCB& aiocb = static_cast<AIOCB&>(event);
+    arm_deadline(aiocb);
+    if (start(aiocb)) {
+      return true;
+    } else {
+      disarm_deadline(aiocb);
+      return false;
+    }
+  }
+
+  default:
+    return start(event);
+  }
+}
+
+void AIOQueue::expire_deadlines(const Time& now) {
+  timer_wheel_lock.lock();
+  for (;;) {
+    TimerEvent* timer_event = timer_wheel.expire(now);
+    if (timer_event != NULL) {
+      DeadlineTimerEvent* deadline_timer_event
+      = static_cast<DeadlineTimerEvent*>(timer_event);
+      deadline_timer_event->set_timed_out();
+      // Completes with ERROR_OPERATION_ABORTED, which timeddequeue
+      // translates to AIOCB::Error::TIMED_OUT.
+      cancel(deadline_timer_event->get_aiocb());
+      TimerEvent::dec_ref(*deadline_timer_event);
+    } else {
+      break;
+    }
+  }
+  timer_wheel_lock.unlock();
+}
+
+bool AIOQueue::start(YO_NEW_REF Event& event) {
   switch (event.get_type_id()) {
   case acceptAIOCB::TYPE_ID: {
     acceptAIOCB& accept_aiocb = static_cast<acceptAIOCB&>(event);
@@ -249,6 +359,11 @@ bool AIOQueue::enqueue(YO_NEW_REF Event& event) {
   case recvAIOCB::TYPE_ID: {
     recvAIOCB& recv_aiocb = static_cast<recvAIOCB&>(event);
 
+    // Overlapped receives need their buffer up front.
+    if (!recv_aiocb.has_buffer()) {
+      recv_aiocb.set_buffer(*new Buffer(recv_aiocb.get_buffer_capacity()));
+    }
+
     log_enqueue(recv_aiocb);
 
     DWORD dwFlags = static_cast<DWORD>(recv_aiocb.get_flags());
@@ -436,18 +551,47 @@ template <class AIOCBType> void AIOQueue::log_error(AIOCBType& aiocb) {
 }
 
 YO_NEW_REF Event* AIOQueue::timeddequeue(const Time& timeout) {
+  Time now = Time::monotonic_now();
+  Time deadline = (timeout == Time::FOREVER) ? timeout : now + timeout;
+
   DWORD dwBytesTransferred = 0;
   ULONG_PTR ulCompletionKey = 0;
   LPOVERLAPPED lpOverlapped = NULL;
+  BOOL bRet;
+
+  for (;;) {
+    expire_deadlines(now);
 
-  BOOL bRet
-  = GetQueuedCompletionStatus(
-      hIoCompletionPort,
-      &dwBytesTransferred,
-      &ulCompletionKey,
-      &lpOverlapped,
-      static_cast<DWORD>(timeout.ms())
-    );
+    // Wake for the next AIOCB deadline if it is before the caller's.
+    timer_wheel_lock.lock();
+    Time wait_timeout = timer_wheel.get_next_timeout(now);
+    timer_wheel_lock.unlock();
+    if (deadline != Time::FOREVER && deadline - now < wait_timeout) {
+      wait_timeout = deadline - now;
+    }
+
+    bRet
+    = GetQueuedCompletionStatus(
+        hIoCompletionPort,
+        &dwBytesTransferred,
+        &ulCompletionKey,
+        &lpOverlapped,
+        (wait_timeout == Time::FOREVER)
+        ? INFINITE
+        : static_cast<DWORD>(
+          (wait_timeout.ns() + Time::NS_IN_MS - 1) / Time::NS_IN_MS
+        )
+      );
+
+    if (lpOverlapped != NULL || ulCompletionKey != 0) {
+      break;
+    }
+
+    now = Time::monotonic_now();
+    if (now >= deadline) {
+      break;
+    }
+  }
 
   if (lpOverlapped != NULL) {
     AIOCB& aiocb = AIOCB::cast(*lpOverlapped);
@@ -458,6 +602,16 @@ YO_NEW_REF Event* AIOQueue::timeddequeue(const Time& timeout) {
       aiocb.set_error(GetLastError());
     }
 
+    if (
+      disarm_deadline(aiocb)
+      &&
+      !bRet
+      &&
+      aiocb.get_error() == ERROR_OPERATION_ABORTED
+    ) {
+      aiocb.set_error(AIOCB::Error::TIMED_OUT);
+    }
+
     switch (aiocb.get_type_id()) {
     case acceptAIOCB::TYPE_ID: {
       acceptAIOCB& accept_aiocb = static_cast<acceptAIOCB&>(aiocb);
@@ -31,13 +31,19 @@
 #include "yield/sockets/aio/aiocb.hpp"
 
 #include <Windows.h>
+#include <winsock2.h> // For WSAETIMEDOUT
 
 namespace yield {
 namespace sockets {
 namespace aio {
+const uint32_t AIOCB::Error::CANCELED = ERROR_OPERATION_ABORTED;
+const uint32_t AIOCB::Error::TIMED_OUT = WSAETIMEDOUT;
+
 AIOCB::AIOCB(Socket& socket_, Object* context)
   : context(Object::inc_ref(context)),
-    socket_(socket_.inc_ref()) {
+    deadline_timer_event(NULL),
+    socket_(socket_.inc_ref()),
+    timeout(Time::FOREVER) {
   static_assert(sizeof(overlapped) == sizeof(::OVERLAPPED), "");
   memset(&overlapped, 0, sizeof(overlapped));
   this_ = this;
@@ -48,7 +54,9 @@ AIOCB::AIOCB(Socket& socket_, Object* context)
 
 AIOCB::AIOCB(Socket& socket_, off_t offset, Object *context)
   : context(Object::inc_ref(context)),
-    socket_(socket_.inc_ref()) {
+    deadline_timer_event(NULL),
+    socket_(socket_.inc_ref()),
+    timeout(Time::FOREVER) {
   memset(&overlapped, 0, sizeof(overlapped));
   overlapped.Offset = static_cast<uint32_t>(offset);
   overlapped.OffsetHigh = static_cast<uint32_t>(offset >> 32);
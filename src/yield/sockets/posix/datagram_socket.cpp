@@ -29,12 +29,37 @@
 
 #include "yield/sockets/datagram_socket.hpp"
 
+#include <netinet/in.h> // For the IPPROTO_* constants
+#include <netinet/udp.h> // For the UDP_* constants
 #include <sys/socket.h>
 
 namespace yield {
 namespace sockets {
 const int DatagramSocket::TYPE = SOCK_DGRAM;
 
+#ifdef __linux__
+#ifdef UDP_GRO
+static const size_t GRO_CONTROL_LEN = CMSG_SPACE(sizeof(int));
+
+static uint16_t get_gro_segment_size(msghdr& msghdr_, unsigned int msg_len) {
+  for (
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msghdr_);
+    cmsg != NULL;
+    cmsg = CMSG_NXTHDR(&msghdr_, cmsg)
+  ) {
+    if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int segment_size;
+      memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      return static_cast<uint16_t>(segment_size);
+    }
+  }
+
+  // The kernel only attaches the segment size to coalesced datagrams.
+  return static_cast<uint16_t>(msg_len);
+}
+#endif
+#endif
+
 ssize_t
 DatagramSocket::recvfrom(
   void* buf,
@@ -69,6 +94,174 @@ DatagramSocket::recvmsg(
   return ::recvmsg(*this, &msghdr_, flags);
 }
 
+ssize_t
+DatagramSocket::recvmmsg(
+  Buffer* const* buffers,
+  size_t buffers_len,
+  const MessageFlags& flags,
+  SocketAddress* peernames,
+  uint16_t* segment_sizes
+) {
+  if (buffers_len == 0) {
+    return 0;
+  }
+
+  // One contiguous run of iovecs per buffer, which may be a linked list.
+  vector<iovec> iov;
+  vector<size_t> iov_offsets(buffers_len + 1);
+  for (size_t buffer_i = 0; buffer_i < buffers_len; ++buffer_i) {
+    iov_offsets[buffer_i] = iov.size();
+    Buffers::as_read_iovecs(*buffers[buffer_i], iov);
+  }
+  iov_offsets[buffers_len] = iov.size();
+
+#ifdef __linux__
+  vector<mmsghdr> msgvec(buffers_len);
+#ifdef UDP_GRO
+  vector<char> control;
+  if (segment_sizes != NULL) {
+    control.resize(buffers_len * GRO_CONTROL_LEN);
+  }
+#endif
+  for (size_t buffer_i = 0; buffer_i < buffers_len; ++buffer_i) {
+    msghdr& msghdr_ = msgvec[buffer_i].msg_hdr;
+    msghdr_.msg_iov = &iov[iov_offsets[buffer_i]];
+    msghdr_.msg_iovlen = iov_offsets[buffer_i + 1] - iov_offsets[buffer_i];
+    if (peernames != NULL) {
+      msghdr_.msg_name = peernames[buffer_i];
+      msghdr_.msg_namelen = peernames[buffer_i].len();
+    }
+#ifdef UDP_GRO
+    if (segment_sizes != NULL) {
+      msghdr_.msg_control = &control[buffer_i * GRO_CONTROL_LEN];
+      msghdr_.msg_controllen = GRO_CONTROL_LEN;
+    }
+#endif
+  }
+
+  // MSG_WAITFORONE: a blocking socket would otherwise wait for
+  // buffers_len datagrams.
+  int recvmmsg_ret
+  = ::recvmmsg(
+      *this,
+      &msgvec[0],
+      static_cast<unsigned int>(buffers_len),
+      flags | MSG_WAITFORONE,
+      NULL
+    );
+
+  for (int msg_i = 0; msg_i < recvmmsg_ret; ++msg_i) {
+    unsigned int msg_len = msgvec[msg_i].msg_len;
+    Buffers::put(*buffers[msg_i], NULL, msg_len);
+    if (segment_sizes != NULL) {
+#ifdef UDP_GRO
+      segment_sizes[msg_i]
+      = get_gro_segment_size(msgvec[msg_i].msg_hdr, msg_len);
+#else
+      segment_sizes[msg_i] = static_cast<uint16_t>(msg_len);
+#endif
+    }
+  }
+
+  return recvmmsg_ret;
+#else
+  SocketAddress peername;
+  ssize_t recvmsg_ret
+  = recvmsg(
+      &iov[0],
+      static_cast<int>(iov_offsets[1]),
+      flags,
+      peernames != NULL ? peernames[0] : peername
+    );
+  if (recvmsg_ret >= 0) {
+    Buffers::put(*buffers[0], NULL, static_cast<size_t>(recvmsg_ret));
+    if (segment_sizes != NULL) {
+      segment_sizes[0] = static_cast<uint16_t>(recvmsg_ret);
+    }
+    return 1;
+  } else {
+    return -1;
+  }
+#endif
+}
+
+ssize_t
+DatagramSocket::sendmmsg(
+  const Buffer* const* buffers,
+  size_t buffers_len,
+  const MessageFlags& flags,
+  const SocketAddress* peernames
+) {
+  if (buffers_len == 0) {
+    return 0;
+  }
+
+  vector<iovec> iov;
+  vector<size_t> iov_offsets(buffers_len + 1);
+  for (size_t buffer_i = 0; buffer_i < buffers_len; ++buffer_i) {
+    iov_offsets[buffer_i] = iov.size();
+    Buffers::as_write_iovecs(*buffers[buffer_i], iov);
+  }
+  iov_offsets[buffers_len] = iov.size();
+
+#ifdef __linux__
+  vector<mmsghdr> msgvec(buffers_len);
+  for (size_t buffer_i = 0; buffer_i < buffers_len; ++buffer_i) {
+    msghdr& msghdr_ = msgvec[buffer_i].msg_hdr;
+    msghdr_.msg_iov = &iov[iov_offsets[buffer_i]];
+    msghdr_.msg_iovlen = iov_offsets[buffer_i + 1] - iov_offsets[buffer_i];
+    if (peernames != NULL) {
+      const SocketAddress* peername_
+      = peernames[buffer_i].filter(get_domain());
+      if (peername_ != NULL) {
+        const sockaddr* peername_sockaddr = *peername_;
+        msghdr_.msg_name = const_cast<sockaddr*>(peername_sockaddr);
+        msghdr_.msg_namelen = peername_->len();
+      } else {
+        return -1;
+      }
+    }
+  }
+
+  int sendmmsg_ret
+  = ::sendmmsg(
+      *this,
+      &msgvec[0],
+      static_cast<unsigned int>(buffers_len),
+      flags
+    );
+
+  // Each datagram takes its own zero-copy notification ID.
+  for (int msg_i = 0; msg_i < sendmmsg_ret; ++msg_i) {
+    count_zerocopy_send(msgvec[msg_i].msg_len, flags);
+  }
+
+  return sendmmsg_ret;
+#else
+  size_t buffer_i = 0;
+  for (; buffer_i < buffers_len; ++buffer_i) {
+    const iovec* iov_ = &iov[iov_offsets[buffer_i]];
+    int iovlen
+    = static_cast<int>(iov_offsets[buffer_i + 1] - iov_offsets[buffer_i]);
+    ssize_t sendmsg_ret;
+    if (peernames != NULL) {
+      sendmsg_ret = sendmsg(iov_, iovlen, flags, peernames[buffer_i]);
+    } else {
+      sendmsg_ret = Socket::sendmsg(iov_, iovlen, flags);
+    }
+    if (sendmsg_ret < 0) {
+      break;
+    }
+  }
+
+  if (buffer_i > 0) {
+    return static_cast<ssize_t>(buffer_i);
+  } else {
+    return -1;
+  }
+#endif
+}
+
 ssize_t
 DatagramSocket::sendmsg(
   const iovec* iov,
@@ -88,7 +281,9 @@ DatagramSocket::sendmsg(
   } else {
     return -1;
   }
-  return ::sendmsg(*this, &msghdr_, flags);
+  ssize_t sendmsg_ret = ::sendmsg(*this, &msghdr_, flags);
+  count_zerocopy_send(sendmsg_ret, flags);
+  return sendmsg_ret;
 }
 
 ssize_t
@@ -100,14 +295,17 @@ DatagramSocket::sendto(
 ) {
   const SocketAddress* peername_ = peername.filter(get_domain());
   if (peername_ != NULL) {
-    return ::sendto(
-             *this,
-             static_cast<const char*>(buf),
-             buflen,
-             flags,
-             *peername_,
-             peername_->len()
-           );
+    ssize_t sendto_ret
+    = ::sendto(
+        *this,
+        static_cast<const char*>(buf),
+        buflen,
+        flags,
+        *peername_,
+        peername_->len()
+      );
+    count_zerocopy_send(sendto_ret, flags);
+    return sendto_ret;
   } else {
     return -1;
   }
@@ -43,7 +43,17 @@ namespace yield {
 namespace sockets {
 const int Socket::Option::RCVBUF = SO_RCVBUF;
 const int Socket::Option::REUSEADDR = SO_REUSEADDR;
+#ifdef SO_REUSEPORT
+const int Socket::Option::REUSEPORT = SO_REUSEPORT;
+#else
+const int Socket::Option::REUSEPORT = -2; // Not a valid option name
+#endif
 const int Socket::Option::SNDBUF = SO_SNDBUF;
+#ifdef SO_ZEROCOPY
+const int Socket::Option::ZEROCOPY = SO_ZEROCOPY;
+#else
+const int Socket::Option::ZEROCOPY = -3; // Not a valid option name
+#endif
 
 bool Socket::bind(const SocketAddress& _name) {
   const SocketAddress* name = _name.filter(get_domain());
@@ -58,6 +68,18 @@ bool Socket::close() {
   return ::close(*this) != -1;
 }
 
+void
+Socket::count_zerocopy_send(
+  ssize_t send_ret,
+  const MessageFlags& flags
+) {
+#ifdef MSG_ZEROCOPY
+  if (zerocopy && send_ret > 0 && (flags & MSG_ZEROCOPY) == MSG_ZEROCOPY) {
+    ++zerocopy_send_count;
+  }
+#endif
+}
+
 bool Socket::connect(const SocketAddress& _peername) {
   const SocketAddress* peername = _peername.filter(get_domain());
   if (peername != NULL) {
@@ -180,7 +202,9 @@ Socket::send(
   size_t buflen,
   const MessageFlags& flags
 ) {
-  return ::send(*this, buf, buflen, flags);
+  ssize_t send_ret = ::send(*this, buf, buflen, flags);
+  count_zerocopy_send(send_ret, flags);
+  return send_ret;
 }
 
 ssize_t
@@ -193,30 +217,51 @@ Socket::sendmsg(
   memset(&msghdr_, 0, sizeof(msghdr_));
   msghdr_.msg_iov = const_cast<iovec*>(iov);
   msghdr_.msg_iovlen = iovlen;
-  return ::sendmsg(*this, &msghdr_, flags);
+  ssize_t sendmsg_ret = ::sendmsg(*this, &msghdr_, flags);
+  count_zerocopy_send(sendmsg_ret, flags);
+  return sendmsg_ret;
 }
 
 bool Socket::set_blocking_mode(bool blocking_mode) {
+  // The mode isn't cached: it belongs to the file description, which dup'd
+  // descriptors share.
   int current_fcntl_flags = fcntl(*this, F_GETFL, 0);
-  if (blocking_mode) {
-    if ((current_fcntl_flags & O_NONBLOCK) == O_NONBLOCK) {
-      return fcntl(*this, F_SETFL, current_fcntl_flags ^ O_NONBLOCK) != -1;
-    } else {
-      return true;
-    }
+  if (current_fcntl_flags == -1) {
+    return false;
+  }
+
+  int new_fcntl_flags
+  = blocking_mode
+    ? (current_fcntl_flags & ~O_NONBLOCK)
+    : (current_fcntl_flags | O_NONBLOCK);
+  if (
+    new_fcntl_flags == current_fcntl_flags
+    ||
+    fcntl(*this, F_SETFL, new_fcntl_flags) != -1
+  ) {
+    return true;
   } else {
-    return fcntl(*this, F_SETFL, current_fcntl_flags | O_NONBLOCK) != -1;
+    return false;
   }
 }
 
 bool Socket::setsockopt(int option_name, int option_value) {
-  return ::setsockopt(
-           *this,
-           SOL_SOCKET,
-           option_name,
-           reinterpret_cast<char*>(&option_value),
-           static_cast<int>(sizeof(option_value))
-         ) == 0;
+  if (
+    ::setsockopt(
+      *this,
+      SOL_SOCKET,
+      option_name,
+      reinterpret_cast<char*>(&option_value),
+      static_cast<int>(sizeof(option_value))
+    ) == 0
+  ) {
+    if (option_name == Option::ZEROCOPY) {
+      zerocopy = option_value != 0;
+    }
+    return true;
+  } else {
+    return false;
+  }
 }
 
 bool Socket::want_recv() const {
@@ -246,6 +291,20 @@ Socket::MessageFlags::MessageFlags(int message_flags) {
     message_flags ^= PEEK;
   }
 
+  if ((message_flags & MORE) == MORE) {
+#ifdef MSG_MORE
+    platform_message_flags |= MSG_MORE;
+#endif
+    message_flags ^= MORE;
+  }
+
+  if ((message_flags & ZEROCOPY) == ZEROCOPY) {
+#ifdef MSG_ZEROCOPY
+    platform_message_flags |= MSG_ZEROCOPY;
+#endif
+    message_flags ^= ZEROCOPY;
+  }
+
   platform_message_flags |= message_flags;
 
 #ifdef __linux
@@ -30,6 +30,7 @@
 #include "yield/sockets/stream_socket.hpp"
 
 #include <errno.h>
+#include <fcntl.h>
 #ifdef __linux__
 #include <sys/sendfile.h>
 #endif
@@ -45,10 +46,35 @@ const int StreamSocket::Option::LINGER = SO_LINGER;
 StreamSocket* StreamSocket::accept(SocketAddress& peername) {
   socklen_t peernamelen = peername.len();
 
+#if defined(__linux__) || defined(__sun)
+  int fcntl_flags = fcntl(*this, F_GETFL, 0);
+  bool nonblocking
+  = fcntl_flags != -1 && (fcntl_flags & O_NONBLOCK) == O_NONBLOCK;
+#endif
+
+#ifdef __linux__
+  // Linux doesn't carry O_NONBLOCK over to accepted sockets, so have accept4
+  // set it (and FD_CLOEXEC) rather than leaving it to a later fcntl.
+  socket_t peer_socket
+  = ::accept4(
+      *this,
+      peername,
+      &peernamelen,
+      SOCK_CLOEXEC | (nonblocking ? SOCK_NONBLOCK : 0)
+    );
+#else
   socket_t peer_socket = ::accept(*this, peername, &peernamelen);
+#endif
 
   if (peer_socket != -1) {
-    return dup2(peer_socket);
+    // BSD-derived accepts inherit O_NONBLOCK from the listen socket.
+    StreamSocket* accepted_socket = dup2(peer_socket);
+#ifdef __sun
+    if (nonblocking) {
+      accepted_socket->set_blocking_mode(false);
+    }
+#endif
+    return accepted_socket;
   } else {
     return NULL;
   }
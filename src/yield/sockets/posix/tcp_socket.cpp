@@ -29,6 +29,7 @@
 
 #include "yield/sockets/tcp_socket.hpp"
 
+#include <errno.h>
 #include <netinet/in.h> // For the IPPROTO_* constants
 #include <netinet/tcp.h> // For the TCP_* constants
 #include <sys/socket.h>
@@ -38,6 +39,9 @@ namespace sockets {
 const int TCPSocket::DOMAIN_DEFAULT = AF_INET;
 const int TCPSocket::PROTOCOL = IPPROTO_TCP;
 
+// TCP_DEFER_ACCEPT is SO_KEEPALIVE's value on Linux, so DEFER_ACCEPT is one
+// that no socket-level option has.
+const int TCPSocket::Option::DEFER_ACCEPT = -1;
 const int TCPSocket::Option::NODELAY = TCP_NODELAY;
 
 bool TCPSocket::setsockopt(int option_name, int option_value) {
@@ -49,6 +53,19 @@ bool TCPSocket::setsockopt(int option_name, int option_value) {
              reinterpret_cast<char*>(&option_value),
              static_cast<int>(sizeof(option_value))
            ) == 0;
+  } else if (option_name == Option::DEFER_ACCEPT) {
+#ifdef TCP_DEFER_ACCEPT
+    return ::setsockopt(
+             *this,
+             IPPROTO_TCP,
+             TCP_DEFER_ACCEPT,
+             reinterpret_cast<char*>(&option_value),
+             static_cast<int>(sizeof(option_value))
+           ) == 0;
+#else
+    errno = ENOPROTOOPT;
+    return false;
+#endif
   } else {
     return StreamSocket::setsockopt(option_name, option_value);
   }
@@ -29,12 +29,46 @@
 
 #include "yield/sockets/udp_socket.hpp"
 
+#include <errno.h>
 #include <netinet/in.h> // For the IPPROTO_* constants
+#include <netinet/udp.h> // For the UDP_* constants
 #include <sys/socket.h>
 
 namespace yield {
 namespace sockets {
 const int UDPSocket::DOMAIN_DEFAULT = AF_INET;
 const int UDPSocket::PROTOCOL = IPPROTO_UDP;
+
+// Where the UDP_* constants are missing, use values that no socket-level
+// option has.
+#ifdef UDP_GRO
+const int UDPSocket::Option::GRO = UDP_GRO;
+#else
+const int UDPSocket::Option::GRO = -4;
+#endif
+#ifdef UDP_SEGMENT
+const int UDPSocket::Option::SEGMENT = UDP_SEGMENT;
+#else
+const int UDPSocket::Option::SEGMENT = -5;
+#endif
+
+bool UDPSocket::setsockopt(int option_name, int option_value) {
+  if (option_name == Option::GRO || option_name == Option::SEGMENT) {
+#if defined(UDP_GRO) && defined(UDP_SEGMENT)
+    return ::setsockopt(
+             *this,
+             IPPROTO_UDP,
+             option_name,
+             reinterpret_cast<char*>(&option_value),
+             static_cast<int>(sizeof(option_value))
+           ) == 0;
+#else
+    errno = ENOPROTOOPT;
+    return false;
+#endif
+  } else {
+    return DatagramSocket::setsockopt(option_name, option_value);
+  }
+}
 }
 }
@@ -94,6 +94,63 @@ DatagramSocket::recvmsg(
   }
 }
 
+ssize_t
+DatagramSocket::recvmmsg(
+  Buffer* const* buffers,
+  size_t buffers_len,
+  const MessageFlags& flags,
+  SocketAddress* peernames,
+  uint16_t* segment_sizes
+) {
+  if (buffers_len == 0) {
+    return 0;
+  }
+
+  // Winsock has no batch receive, so read a single datagram.
+  SocketAddress peername;
+  ssize_t recv_ret
+  = recvfrom(
+      *buffers[0],
+      flags,
+      peernames != NULL ? peernames[0] : peername
+    );
+  if (recv_ret >= 0) {
+    if (segment_sizes != NULL) {
+      segment_sizes[0] = static_cast<uint16_t>(recv_ret);
+    }
+    return 1;
+  } else {
+    return -1;
+  }
+}
+
+ssize_t
+DatagramSocket::sendmmsg(
+  const Buffer* const* buffers,
+  size_t buffers_len,
+  const MessageFlags& flags,
+  const SocketAddress* peernames
+) {
+  size_t buffer_i = 0;
+  for (; buffer_i < buffers_len; ++buffer_i) {
+    ssize_t send_ret;
+    if (peernames != NULL) {
+      send_ret = sendto(*buffers[buffer_i], flags, peernames[buffer_i]);
+    } else {
+      send_ret = send(*buffers[buffer_i], flags);
+    }
+    if (send_ret < 0) {
+      break;
+    }
+  }
+
+  if (buffer_i > 0 || buffers_len == 0) {
+    return static_cast<ssize_t>(buffer_i);
+  } else {
+    return -1;
+  }
+}
+
 ssize_t
 DatagramSocket::sendmsg(
   const iovec* iov,
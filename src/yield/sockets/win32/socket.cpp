@@ -35,7 +35,9 @@ namespace yield {
 namespace sockets {
 const int Socket::Option::RCVBUF = SO_RCVBUF;
 const int Socket::Option::REUSEADDR = SO_REUSEADDR;
+const int Socket::Option::REUSEPORT = -2; // Not a valid option name
 const int Socket::Option::SNDBUF = SO_SNDBUF;
+const int Socket::Option::ZEROCOPY = -3; // Not a valid option name
 
 bool Socket::bind(const SocketAddress& _name) {
   const SocketAddress* name = _name.filter(get_domain());
@@ -318,6 +320,14 @@ Socket::MessageFlags::MessageFlags(int message_flags) {
     message_flags ^= PEEK;
   }
 
+  if ((message_flags & MORE) == MORE) { // No Winsock equivalent
+    message_flags ^= MORE;
+  }
+
+  if ((message_flags & ZEROCOPY) == ZEROCOPY) { // No Winsock equivalent
+    message_flags ^= ZEROCOPY;
+  }
+
   platform_message_flags |= message_flags;
 }
 }
@@ -45,6 +45,7 @@ StreamSocket* StreamSocket::accept(SocketAddress& peername) {
   socket_t peer_socket = ::accept(*this, peername, &peernamelen);
 
   if (peer_socket != INVALID_SOCKET) {
+    // Accepted sockets inherit the listen socket's blocking mode.
     return dup2(peer_socket);
   } else {
     return NULL;
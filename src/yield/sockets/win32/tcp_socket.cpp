@@ -35,6 +35,7 @@ namespace sockets {
 const int TCPSocket::DOMAIN_DEFAULT = AF_INET;
 const int TCPSocket::PROTOCOL = IPPROTO_TCP;
 
+const int TCPSocket::Option::DEFER_ACCEPT = -1;
 const int TCPSocket::Option::NODELAY = TCP_NODELAY;
 
 bool TCPSocket::setsockopt(int option_name, int option_value) {
@@ -46,6 +47,9 @@ bool TCPSocket::setsockopt(int option_name, int option_value) {
              reinterpret_cast<char*>(&option_value),
              static_cast<int>(sizeof(option_value))
            ) == 0;
+  } else if (option_name == Option::DEFER_ACCEPT) {
+    WSASetLastError(WSAENOPROTOOPT);
+    return false;
   } else {
     return StreamSocket::setsockopt(option_name, option_value);
   }
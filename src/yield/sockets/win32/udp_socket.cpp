@@ -34,5 +34,17 @@ namespace yield {
 namespace sockets {
 const int UDPSocket::DOMAIN_DEFAULT = AF_INET;
 const int UDPSocket::PROTOCOL = IPPROTO_UDP;
+
+const int UDPSocket::Option::GRO = -4;
+const int UDPSocket::Option::SEGMENT = -5;
+
+bool UDPSocket::setsockopt(int option_name, int option_value) {
+  if (option_name == Option::GRO || option_name == Option::SEGMENT) {
+    WSASetLastError(WSAENOPROTOOPT);
+    return false;
+  } else {
+    return DatagramSocket::setsockopt(option_name, option_value);
+  }
+}
 }
 }
@@ -29,9 +29,11 @@
 
 #include "yield/stage/polling_stage_scheduler.hpp"
 #include "yield/stage/stage.hpp"
+#include "yield/thread/processor_set.hpp"
 
 namespace yield {
 namespace stage {
+using yield::thread::ProcessorSet;
 using yield::thread::Thread;
 
 PollingStageScheduler::~PollingStageScheduler() {
@@ -50,7 +52,8 @@ PollingStageScheduler::~PollingStageScheduler() {
 void
 PollingStageScheduler::schedule(
   Stage& stage,
-  ConcurrencyLevel concurrency_level
+  ConcurrencyLevel concurrency_level,
+  const Placement& placement
 ) {
   for (uint16_t thread_i = 0; thread_i < concurrency_level; thread_i++) {
     if (thread_i < threads.size()) {
@@ -59,13 +62,18 @@ PollingStageScheduler::schedule(
       = static_cast<StagePoller*>(thread->get_runnable());
       stage_poller->schedule(stage);
     } else {
-      threads.push_back(new Thread(createStagePoller(stage)));
+      // Placement only applies to new threads; existing pollers keep
+      // the placement of the stage they were created for.
+      StagePoller& stage_poller = createStagePoller(stage);
+      stage_poller.set_processor_set(place(stage, placement));
+      threads.push_back(new Thread(stage_poller));
     }
   }
 }
 
 
-PollingStageScheduler::StagePoller::StagePoller(Stage& first_stage) {
+PollingStageScheduler::StagePoller::StagePoller(Stage& first_stage)
+  : processor_set(NULL) {
   stages.push_back(&first_stage.inc_ref());
 }
 
@@ -77,6 +85,14 @@ PollingStageScheduler::StagePoller::~StagePoller() {
   ) {
     Stage::dec_ref(**stage_i);
   }
+
+  delete processor_set;
+}
+
+void PollingStageScheduler::StagePoller::bind() {
+  if (processor_set != NULL) {
+    StageScheduler::bind(*processor_set);
+  }
 }
 
 vector<Stage*>& PollingStageScheduler::StagePoller::get_stages() {
@@ -89,6 +105,14 @@ vector<Stage*>& PollingStageScheduler::StagePoller::get_stages() {
   return stages;
 }
 
+void
+PollingStageScheduler::StagePoller::set_processor_set(
+  YO_NEW_REF ProcessorSet* processor_set
+) {
+  delete this->processor_set;
+  this->processor_set = processor_set;
+}
+
 void PollingStageScheduler::StagePoller::schedule(Stage& stage) {
   stage.inc_ref();
   while (!new_stage.enqueue(stage)) {
@@ -31,45 +31,77 @@
 #include "yield/time.hpp"
 #include "yield/stage/seda_stage_scheduler.hpp"
 #include "yield/stage/stage.hpp"
+#include "yield/thread/processor_set.hpp"
 #include "yield/thread/runnable.hpp"
 #include "yield/thread/thread.hpp"
 
 namespace yield {
 namespace stage {
+using yield::thread::ProcessorSet;
 using yield::thread::Thread;
 
 class SEDAStageScheduler::SEDAStage : public ::yield::thread::Runnable {
 public:
-  SEDAStage(Stage& stage)
-    : stage(stage.inc_ref()) {
+  SEDAStage(Stage& stage, YO_NEW_REF ProcessorSet* processor_set)
+    : processor_set(processor_set), stage(stage.inc_ref()) {
     should_run = true;
   }
 
+  ~SEDAStage() {
+    delete processor_set;
+    Stage::dec_ref(stage);
+  }
+
   void stop() {
     should_run = false;
+  }
+
+  void wake() {
     stage.handle(*new Stage::ShutdownEvent);
   }
 
   // yield::thread::Runnable
   void run() {
+    if (processor_set != NULL) {
+      bind(*processor_set);
+    }
+
     while (should_run) {
       stage.visit();
     }
   }
 
 private:
+  ProcessorSet* processor_set;
   bool should_run;
   Stage& stage;
 };
 
 
 SEDAStageScheduler::~SEDAStageScheduler() {
+  // Stop every thread before waking any: threads servicing the same stage
+  // share its queue, so one thread's ShutdownEvent may wake another.
   for (
     vector<Thread*>::iterator thread_i = threads.begin();
     thread_i != threads.end();
     ++thread_i
   ) {
     static_cast<SEDAStage*>((*thread_i)->get_runnable())->stop();
+  }
+
+  for (
+    vector<Thread*>::iterator thread_i = threads.begin();
+    thread_i != threads.end();
+    ++thread_i
+  ) {
+    static_cast<SEDAStage*>((*thread_i)->get_runnable())->wake();
+  }
+
+  for (
+    vector<Thread*>::iterator thread_i = threads.begin();
+    thread_i != threads.end();
+    ++thread_i
+  ) {
     (*thread_i)->join();
     Thread::dec_ref(**thread_i);
   }
@@ -78,11 +110,12 @@ SEDAStageScheduler::~SEDAStageScheduler() {
 void
 SEDAStageScheduler::schedule(
   Stage& stage,
-  ConcurrencyLevel concurrency_level
+  ConcurrencyLevel concurrency_level,
+  const Placement& placement
 ) {
-  auto_Object<SEDAStage> seda_stage = new SEDAStage(stage);
   for (int16_t thread_i = 0; thread_i < concurrency_level; thread_i++) {
-    threads.push_back(new Thread(seda_stage->inc_ref()));
+    SEDAStage* seda_stage = new SEDAStage(stage, place(stage, placement));
+    threads.push_back(new Thread(*seda_stage));
   }
 }
 }
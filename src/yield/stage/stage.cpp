@@ -86,11 +86,11 @@ void Stage::visit() {
   Event& event = event_queue.dequeue();
   event_queue_length--;
 
-  Time service_time_start(Time::now());
+  Time service_time_start(Time::monotonic_now());
 
   service(event);
 
-  Time service_time(Time::now() - service_time_start);
+  Time service_time(Time::monotonic_now() - service_time_start);
 }
 
 bool Stage::visit(const Time& timeout) {
@@ -99,11 +99,11 @@ bool Stage::visit(const Time& timeout) {
   if (event != NULL) {
     event_queue_length--;
 
-    Time service_time_start(Time::now());
+    Time service_time_start(Time::monotonic_now());
 
     service(*event);
 
-    Time service_time(Time::now() - service_time_start);
+    Time service_time(Time::monotonic_now() - service_time_start);
 
     return true;
   } else {
@@ -27,17 +27,175 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
 // THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include "yield/numa_allocator.hpp"
 #include "yield/stage/stage_scheduler.hpp"
 #include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
+#include "yield/thread/thread.hpp"
 
 namespace yield {
 namespace stage {
+using yield::thread::ProcessorSet;
+using yield::thread::ProcessorTopology;
+using yield::thread::Thread;
+
 const StageScheduler::ConcurrencyLevel
 StageScheduler::ConcurrencyLevel::DEFAULT(1);
 
+// One thread per physical core: SMT siblings share execution units, so
+// a second thread per core rarely pays for its extra context switches.
 const StageScheduler::ConcurrencyLevel
 StageScheduler::ConcurrencyLevel::PER_PROCESSOR(
-  yield::thread::ProcessorSet::get_online_logical_processor_count()
+  ProcessorSet::get_online_physical_processor_count()
+);
+
+const StageScheduler::Placement
+StageScheduler::Placement::DEFAULT(
+  StageScheduler::Placement::POLICY_DEFAULT,
+  0,
+  NULL,
+  NULL
+);
+
+const StageScheduler::Placement
+StageScheduler::Placement::SPREAD(
+  StageScheduler::Placement::POLICY_SPREAD,
+  0,
+  NULL,
+  NULL
 );
+
+
+StageScheduler::StageScheduler()
+  : next_core_i(0), processor_topology(NULL)
+{ }
+
+StageScheduler::~StageScheduler() {
+  for (
+    std::map<const Stage*, ProcessorSet*>::iterator placement_i
+    = placements.begin();
+    placement_i != placements.end();
+    ++placement_i
+  ) {
+    delete placement_i->second;
+  }
+
+  delete processor_topology;
+}
+
+ProcessorTopology& StageScheduler::get_processor_topology() {
+  if (processor_topology == NULL) {
+    processor_topology = new ProcessorTopology;
+  }
+  return *processor_topology;
+}
+
+bool StageScheduler::bind(const ProcessorSet& processor_set) {
+  if (!Thread::self()->setaffinity(processor_set)) {
+    return false;
+  }
+
+  // setaffinity has already migrated the caller onto processor_set.
+  if (NUMAAllocator::get_numa_node_count() > 1) {
+    NUMAAllocator::set_preferred_numa_node(
+      static_cast<int16_t>(NUMAAllocator::get_current_numa_node_id())
+    );
+  }
+
+  return true;
+}
+
+ProcessorSet*
+StageScheduler::place(
+  const Stage& stage,
+  const Placement& placement
+) {
+  const ProcessorSet* processor_set = NULL;
+
+  switch (placement.policy) {
+  case Placement::POLICY_DEFAULT:
+    return NULL;
+
+  case Placement::POLICY_SPREAD: {
+    const vector<ProcessorSet*>& cores = get_processor_topology().get_cores();
+    processor_set = cores[next_core_i++ % cores.size()];
+  }
+  break;
+
+  case Placement::POLICY_PACK: {
+    const vector<ProcessorSet*>& numa_nodes
+    = get_processor_topology().get_numa_nodes();
+    if (placement.numa_node_i < numa_nodes.size()) {
+      processor_set = numa_nodes[placement.numa_node_i];
+    }
+  }
+  break;
+
+  case Placement::POLICY_PIN: {
+    processor_set = placement.processor_set;
+  }
+  break;
+
+  case Placement::POLICY_COLOCATE: {
+    std::map<const Stage*, ProcessorSet*>::const_iterator other_placement_i
+    = placements.find(placement.stage);
+    if (other_placement_i == placements.end()) {
+      break;
+    }
+
+    ssize_t first_processor_i = other_placement_i->second->find_next(0);
+    if (first_processor_i == -1) {
+      break;
+    }
+    uint16_t other_processor_i = static_cast<uint16_t>(first_processor_i);
+
+    // The highest cache level the topology knows about is the last-level
+    // cache; without cache information fall back to the package.
+    ProcessorTopology& processor_topology = get_processor_topology();
+    for (uint8_t level = 8; level >= 2 && processor_set == NULL; level--) {
+      const vector<ProcessorSet*>& caches
+      = processor_topology.get_caches(level);
+      ssize_t cache_i = ProcessorTopology::find(caches, other_processor_i);
+      if (cache_i != -1) {
+        processor_set = caches[cache_i];
+      }
+    }
+
+    if (processor_set == NULL) {
+      const vector<ProcessorSet*>& packages
+      = processor_topology.get_packages();
+      ssize_t package_i
+      = ProcessorTopology::find(packages, other_processor_i);
+      if (package_i != -1) {
+        processor_set = packages[package_i];
+      }
+    }
+  }
+  break;
+  }
+
+  if (processor_set == NULL || processor_set->empty()) {
+    return NULL;
+  }
+
+  // The thread gets its own copy, since a pinned set need only outlive
+  // the schedule call.
+  ProcessorSet* thread_processor_set = new ProcessorSet;
+  ProcessorSet*& stage_placement = placements[&stage];
+  if (stage_placement == NULL) {
+    stage_placement = new ProcessorSet;
+  }
+  for (
+    ssize_t processor_i = processor_set->find_next(0);
+    processor_i != -1;
+    processor_i
+    = processor_set->find_next(static_cast<uint16_t>(processor_i + 1))
+  ) {
+    thread_processor_set->set(static_cast<uint16_t>(processor_i));
+    stage_placement->set(static_cast<uint16_t>(processor_i));
+  }
+
+  return thread_processor_set;
+}
 }
 }
@@ -42,6 +42,8 @@ public:
 
   // yield::thread::Runnable
   void run() {
+    bind();
+
     Time visit_timeout(0.5);
 
     while (should_run()) {
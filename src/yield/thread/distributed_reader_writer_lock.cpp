@@ -0,0 +1,219 @@
+// yield/thread/distributed_reader_writer_lock.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/numa_allocator.hpp"
+#include "yield/thread/distributed_reader_writer_lock.hpp"
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/thread.hpp"
+
+#include <new>
+
+namespace yield {
+namespace thread {
+#ifdef _WIN32
+__declspec(thread) char DistributedReaderWriterLock::reader_id = 0;
+__declspec(thread) uint32_t DistributedReaderWriterLock::reader_slot_i = 0;
+#else
+__thread char DistributedReaderWriterLock::reader_id = 0;
+__thread uint32_t DistributedReaderWriterLock::reader_slot_i = 0;
+#endif
+
+// How much longer than the last revocation took to keep the reader bias
+// off, from the BRAVO paper. Bounds revocation overhead to about 10%
+// of the time spent in write-heavy phases.
+const static uint64_t READER_BIAS_INHIBIT_MULTIPLIER = 9;
+
+DistributedReaderWriterLock::DistributedReaderWriterLock()
+  : reader_biased(true),
+    reader_bias_inhibited_until(static_cast<uint64_t>(0)),
+    central_reader_count(0),
+    central_writer(false),
+    central_waiting_writer_count(0) {
+  // Two slots per processor leaves room for more readers than processors
+  // before they start colliding.
+  uint32_t reader_slot_count = 8;
+  while (
+    reader_slot_count
+    <
+    2 * static_cast<uint32_t>(
+      ProcessorSet::get_online_logical_processor_count()
+    )
+  ) {
+    reader_slot_count <<= 1;
+  }
+  reader_slot_mask = reader_slot_count - 1;
+
+  reader_slots
+  = static_cast<ReaderSlot*>(
+      NUMAAllocator::allocate(
+        reader_slot_count * sizeof(ReaderSlot),
+        sizeof(ReaderSlot)
+      )
+    );
+  for (uint32_t slot_i = 0; slot_i < reader_slot_count; slot_i++) {
+    new (&reader_slots[slot_i]) ReaderSlot;
+    reader_slots[slot_i].reader.store(NULL, MEMORY_ORDER_RELAXED);
+  }
+}
+
+DistributedReaderWriterLock::~DistributedReaderWriterLock() {
+  NUMAAllocator::deallocate(reader_slots);
+}
+
+void DistributedReaderWriterLock::assign_reader_slot_i() {
+  // Number threads in the order they first read, so that up to
+  // reader_slot_mask + 1 threads get distinct slots in every lock.
+  static Atomic<uint32_t> next_reader_slot_i(0);
+  do {
+    reader_slot_i = next_reader_slot_i.fetch_add(1, MEMORY_ORDER_RELAXED) + 1;
+  } while (reader_slot_i == 0);
+}
+
+bool DistributedReaderWriterLock::rdlock_fast() {
+  ReaderSlot& reader_slot = get_reader_slot();
+  void* expected_reader = NULL;
+  if (
+    reader_slot.reader.compare_exchange(
+      expected_reader,
+      get_reader_id(),
+      MEMORY_ORDER_SEQ_CST
+    )
+  ) {
+    // A writer that revoked the bias before the slot was claimed will not
+    // wait for it, so recheck the bias after claiming.
+    if (reader_biased.load(MEMORY_ORDER_SEQ_CST)) {
+      return true;
+    }
+
+    reader_slot.reader.store(NULL, MEMORY_ORDER_RELEASE);
+  }
+
+  return false;
+}
+
+bool DistributedReaderWriterLock::rdlock_slow(bool block) {
+  central.lock_mutex();
+
+  // Writer-preferring: new readers queue behind waiting writers.
+  while (central_writer || central_waiting_writer_count > 0) {
+    if (!block) {
+      central.unlock_mutex();
+      return false;
+    }
+    central.wait();
+  }
+
+  central_reader_count++;
+
+  // Holding a central reader lock excludes writers, so no revocation
+  // can be in progress.
+  if (
+    !reader_biased.load(MEMORY_ORDER_RELAXED)
+    &&
+    Time::monotonic_now() >= reader_bias_inhibited_until
+  ) {
+    reader_biased.store(true, MEMORY_ORDER_RELEASE);
+  }
+
+  central.unlock_mutex();
+
+  return true;
+}
+
+void DistributedReaderWriterLock::rdunlock_slow() {
+  central.lock_mutex();
+  if (--central_reader_count == 0 && central_waiting_writer_count > 0) {
+    central.broadcast();
+  }
+  central.unlock_mutex();
+}
+
+bool DistributedReaderWriterLock::revoke_reader_bias(bool block) {
+  if (!reader_biased.load(MEMORY_ORDER_RELAXED)) {
+    return true;
+  }
+
+  reader_biased.store(false, MEMORY_ORDER_SEQ_CST);
+
+  Time start_time(Time::monotonic_now());
+
+  for (uint32_t slot_i = 0; slot_i <= reader_slot_mask; slot_i++) {
+    while (reader_slots[slot_i].reader.load(MEMORY_ORDER_SEQ_CST) != NULL) {
+      if (!block) {
+        return false;
+      }
+      Thread::yield();
+    }
+  }
+
+  Time now(Time::monotonic_now());
+  reader_bias_inhibited_until
+  = now + (now - start_time) * READER_BIAS_INHIBIT_MULTIPLIER;
+
+  return true;
+}
+
+bool DistributedReaderWriterLock::trywrlock() {
+  central.lock_mutex();
+  if (central_writer || central_reader_count > 0) {
+    central.unlock_mutex();
+    return false;
+  }
+  central_writer = true;
+  central.unlock_mutex();
+
+  if (revoke_reader_bias(false)) {
+    return true;
+  } else {
+    wrunlock();
+    return false;
+  }
+}
+
+bool DistributedReaderWriterLock::wrlock() {
+  central.lock_mutex();
+  central_waiting_writer_count++;
+  while (central_writer || central_reader_count > 0) {
+    central.wait();
+  }
+  central_waiting_writer_count--;
+  central_writer = true;
+  central.unlock_mutex();
+
+  return revoke_reader_bias(true);
+}
+
+void DistributedReaderWriterLock::wrunlock() {
+  central.lock_mutex();
+  central_writer = false;
+  central.broadcast();
+  central.unlock_mutex();
+}
+}
+}
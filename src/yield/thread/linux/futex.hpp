@@ -0,0 +1,76 @@
+// yield/thread/linux/futex.hpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef _YIELD_THREAD_LINUX_FUTEX_HPP_
+#define _YIELD_THREAD_LINUX_FUTEX_HPP_
+
+#include "yield/types.hpp"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace yield {
+namespace thread {
+/**
+  Sleep until woken by futex_wake, if *uaddr still equals val.
+  @param uaddr address of a 32-bit futex word
+  @param val the value *uaddr must still have for the caller to sleep
+  @param timeout optional relative timeout
+  @return 0 if woken, -1 with errno EAGAIN if *uaddr != val, ETIMEDOUT or EINTR
+*/
+static inline int
+futex_wait(
+  const volatile void* uaddr,
+  uint32_t val,
+  const timespec* timeout = NULL
+) {
+  return static_cast<int>(
+           syscall(SYS_futex, uaddr, FUTEX_WAIT_PRIVATE, val, timeout, NULL, 0)
+         );
+}
+
+/**
+  Wake up to n threads sleeping in futex_wait on uaddr.
+  @param uaddr address of a 32-bit futex word
+  @param n maximum number of threads to wake
+  @return the number of threads woken
+*/
+static inline int futex_wake(const volatile void* uaddr, int n) {
+  return static_cast<int>(
+           syscall(SYS_futex, uaddr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0)
+         );
+}
+}
+}
+
+#endif
@@ -0,0 +1,100 @@
+// yield/thread/linux/lightweight_mutex.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "futex.hpp"
+#include "yield/thread/lightweight_mutex.hpp"
+#include "yield/thread/processor_set.hpp"
+
+namespace yield {
+namespace thread {
+static_assert(
+  sizeof(Atomic<uint32_t>) == sizeof(uint32_t),
+  "futex word must be a plain 32-bit integer"
+);
+
+static inline void cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause" ::: "memory");
+#else
+  __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+void LightweightMutex::lock_contended() {
+  // Spinning only pays off if the holder can run at the same time.
+  static const bool spin
+    = ProcessorSet::get_online_logical_processor_count() > 1;
+
+  if (spin) {
+    // Spin up to twice the running average, as glibc's adaptive mutexes do.
+    uint32_t spin_count = this->spin_count.load(MEMORY_ORDER_RELAXED);
+    uint32_t max_spin_count = spin_count * 2 + 10;
+    if (max_spin_count > 100) {
+      max_spin_count = 100;
+    }
+
+    uint32_t spin_i = 0;
+    for (; spin_i < max_spin_count; spin_i++) {
+      if (state.load(MEMORY_ORDER_RELAXED) == STATE_UNLOCKED) {
+        uint32_t expected_state = STATE_UNLOCKED;
+        if (
+          state.compare_exchange(
+            expected_state,
+            STATE_LOCKED,
+            MEMORY_ORDER_ACQUIRE
+          )
+        ) {
+          break;
+        }
+      }
+      cpu_relax();
+    }
+
+    this->spin_count.store(
+      spin_count + (static_cast<int32_t>(spin_i - spin_count) / 8),
+      MEMORY_ORDER_RELAXED
+    );
+
+    if (spin_i < max_spin_count) {
+      return;
+    }
+  }
+
+  // Mark the mutex contended, so that the holder wakes us up on unlock.
+  while (state.exchange(STATE_CONTENDED, MEMORY_ORDER_ACQUIRE) != STATE_UNLOCKED) {
+    futex_wait(&state, STATE_CONTENDED);
+  }
+}
+
+void LightweightMutex::unlock_contended() {
+  futex_wake(&state, 1);
+}
+}
+}
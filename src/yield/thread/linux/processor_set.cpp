@@ -28,6 +28,7 @@
 // THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
 
 #include <unistd.h>
 
@@ -49,12 +50,25 @@ void ProcessorSet::clear(uint16_t processor_i) {
   CPU_CLR(processor_i, &cpu_set);
 }
 
+ssize_t ProcessorSet::find_next(uint16_t processor_i) const {
+  for (; processor_i < CPU_SETSIZE; processor_i++) {
+    if (CPU_ISSET(processor_i, &cpu_set)) {
+      return processor_i;
+    }
+  }
+  return -1;
+}
+
 uint16_t ProcessorSet::get_online_logical_processor_count() {
   return static_cast<uint16_t>(sysconf(_SC_NPROCESSORS_ONLN));
 }
 
 uint16_t ProcessorSet::get_online_physical_processor_count() {
-  return static_cast<uint16_t>(sysconf(_SC_NPROCESSORS_ONLN));
+  // Counting reads sysfs files, and ConcurrencyLevel::PER_PROCESSOR calls
+  // this during static initialization, so only count once.
+  static uint16_t online_physical_processor_count
+    = ProcessorTopology::count_cores();
+  return online_physical_processor_count;
 }
 
 bool ProcessorSet::isset(uint16_t processor_i) const {
@@ -0,0 +1,395 @@
+// yield/thread/linux/processor_topology.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <unistd.h>
+
+namespace yield {
+namespace thread {
+using std::map;
+
+static const char* SYS_DEVICES_SYSTEM = "/sys/devices/system";
+
+static bool read_sys_file(const string& path, string& contents) {
+  std::FILE* file = std::fopen(path.c_str(), "r");
+  if (file != NULL) {
+    contents.clear();
+    char buffer[256];
+    size_t read_ret;
+    while ((read_ret = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      contents.append(buffer, read_ret);
+    }
+    std::fclose(file);
+
+    size_t contents_end = contents.find_last_not_of(" \n");
+    contents.resize(contents_end != string::npos ? contents_end + 1 : 0);
+
+    return true;
+  } else {
+    return false;
+  }
+}
+
+// Parse a kernel list such as "0-3,8,10-11" into its members.
+static bool parse_list(const string& list, vector<uint16_t>& members) {
+  const char* p = list.c_str();
+  while (*p != 0) {
+    char* end;
+    unsigned long first = std::strtoul(p, &end, 10);
+    if (end == p) {
+      return false;
+    }
+    unsigned long last = first;
+    p = end;
+    if (*p == '-') {
+      last = std::strtoul(p + 1, &end, 10);
+      if (end == p + 1 || last < first) {
+        return false;
+      }
+      p = end;
+    }
+    if (last >= UINT16_MAX) {
+      return false;
+    }
+
+    for (unsigned long member = first; member <= last; member++) {
+      members.push_back(static_cast<uint16_t>(member));
+    }
+
+    if (*p == ',') {
+      p++;
+    } else if (*p != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Add the online members of a processor list to a grouping, once per
+// distinct list.
+static void
+add_processor_list(
+  const string& list,
+  const ProcessorSet& online_logical_processors,
+  map<string, ProcessorSet*>& sets_by_list,
+  vector<ProcessorSet*>& sets
+) {
+  if (sets_by_list.find(list) != sets_by_list.end()) {
+    return;
+  }
+
+  vector<uint16_t> members;
+  if (!parse_list(list, members)) {
+    return;
+  }
+
+  ProcessorSet* set = new ProcessorSet;
+  for (
+    vector<uint16_t>::const_iterator member_i = members.begin();
+    member_i != members.end();
+    ++member_i
+  ) {
+    if (online_logical_processors.isset(*member_i)) {
+      set->set(*member_i);
+    }
+  }
+
+  if (!set->empty()) {
+    sets_by_list[list] = set;
+    sets.push_back(set);
+  } else {
+    delete set;
+  }
+}
+
+static void
+get_online_logical_processor_ids(
+  const string& cpu_dir_path,
+  vector<uint16_t>& online_logical_processor_ids
+) {
+  string online;
+  if (
+    !read_sys_file(cpu_dir_path + "online", online)
+    ||
+    !parse_list(online, online_logical_processor_ids)
+    ||
+    online_logical_processor_ids.empty()
+  ) {
+    online_logical_processor_ids.clear();
+    uint16_t logical_processor_count
+    = ProcessorSet::get_online_logical_processor_count();
+    for (
+      uint16_t logical_processor_i = 0;
+      logical_processor_i < logical_processor_count;
+      logical_processor_i++
+    ) {
+      online_logical_processor_ids.push_back(logical_processor_i);
+    }
+  }
+}
+
+// Get the path of a logical processor's sysfs directory, and its id.
+static string
+get_logical_processor_dir_path(
+  const string& cpu_dir_path,
+  uint16_t logical_processor_i,
+  char (&logical_processor_id)[8]
+) {
+  std::snprintf(
+    logical_processor_id,
+    sizeof(logical_processor_id),
+    "%u",
+    static_cast<unsigned int>(logical_processor_i)
+  );
+  string logical_processor_dir_path(cpu_dir_path);
+  logical_processor_dir_path.append("cpu");
+  logical_processor_dir_path.append(logical_processor_id);
+  logical_processor_dir_path.append("/");
+  return logical_processor_dir_path;
+}
+
+ProcessorTopology::ProcessorTopology() {
+  string cpu_dir_path(SYS_DEVICES_SYSTEM);
+  cpu_dir_path.append("/cpu/");
+
+  vector<uint16_t> online_logical_processor_ids;
+  get_online_logical_processor_ids(cpu_dir_path, online_logical_processor_ids);
+
+  online_logical_processors = new ProcessorSet;
+  for (
+    vector<uint16_t>::const_iterator logical_processor_i
+    = online_logical_processor_ids.begin();
+    logical_processor_i != online_logical_processor_ids.end();
+    ++logical_processor_i
+  ) {
+    online_logical_processors->set(*logical_processor_i);
+  }
+
+  map<string, ProcessorSet*> cores_by_list, packages_by_list;
+  vector< map<string, ProcessorSet*> > caches_by_list;
+
+  for (
+    vector<uint16_t>::const_iterator logical_processor_i
+    = online_logical_processor_ids.begin();
+    logical_processor_i != online_logical_processor_ids.end();
+    ++logical_processor_i
+  ) {
+    char logical_processor_id[8];
+    string logical_processor_dir_path
+    = get_logical_processor_dir_path(
+        cpu_dir_path,
+        *logical_processor_i,
+        logical_processor_id
+      );
+
+    // A processor without topology information is its own core and package.
+    string list;
+    if (
+      !read_sys_file(
+        logical_processor_dir_path + "topology/thread_siblings_list",
+        list
+      )
+    ) {
+      list = logical_processor_id;
+    }
+    add_processor_list(list, *online_logical_processors, cores_by_list, cores);
+
+    if (
+      !read_sys_file(
+        logical_processor_dir_path + "topology/core_siblings_list",
+        list
+      )
+    ) {
+      list = logical_processor_id;
+    }
+    add_processor_list(
+      list,
+      *online_logical_processors,
+      packages_by_list,
+      packages
+    );
+
+    for (uint8_t cache_i = 0; ; cache_i++) {
+      char cache_dir_name[32];
+      std::snprintf(
+        cache_dir_name,
+        sizeof(cache_dir_name),
+        "cache/index%u/",
+        static_cast<unsigned int>(cache_i)
+      );
+      string cache_dir_path(logical_processor_dir_path);
+      cache_dir_path.append(cache_dir_name);
+
+      string level, type;
+      if (
+        !read_sys_file(cache_dir_path + "level", level)
+        ||
+        !read_sys_file(cache_dir_path + "type", type)
+        ||
+        !read_sys_file(cache_dir_path + "shared_cpu_list", list)
+      ) {
+        break;
+      }
+
+      // Count split L1 caches once, by their data half.
+      if (type == "Instruction") {
+        continue;
+      }
+
+      unsigned long level_i = std::strtoul(level.c_str(), NULL, 10);
+      if (level_i < 1 || level_i > 8) {
+        continue;
+      }
+      if (caches.size() < level_i) {
+        caches.resize(level_i);
+        caches_by_list.resize(level_i);
+      }
+      add_processor_list(
+        list,
+        *online_logical_processors,
+        caches_by_list[level_i - 1],
+        caches[level_i - 1]
+      );
+    }
+  }
+
+  // NUMA nodes without processors (memory-only nodes) are left out.
+  string node_dir_path(SYS_DEVICES_SYSTEM);
+  node_dir_path.append("/node/");
+  vector<uint16_t> online_numa_node_ids;
+  string online;
+  if (
+    read_sys_file(node_dir_path + "online", online)
+    &&
+    parse_list(online, online_numa_node_ids)
+  ) {
+    map<string, ProcessorSet*> numa_nodes_by_list;
+    for (
+      vector<uint16_t>::const_iterator numa_node_id_i
+      = online_numa_node_ids.begin();
+      numa_node_id_i != online_numa_node_ids.end();
+      ++numa_node_id_i
+    ) {
+      char cpulist_file_name[32];
+      std::snprintf(
+        cpulist_file_name,
+        sizeof(cpulist_file_name),
+        "node%u/cpulist",
+        static_cast<unsigned int>(*numa_node_id_i)
+      );
+
+      string list;
+      if (read_sys_file(node_dir_path + cpulist_file_name, list)) {
+        size_t numa_node_count = numa_nodes.size();
+        add_processor_list(
+          list,
+          *online_logical_processors,
+          numa_nodes_by_list,
+          numa_nodes
+        );
+        if (numa_nodes.size() > numa_node_count) {
+          numa_node_ids.push_back(*numa_node_id_i);
+        }
+      }
+    }
+  }
+
+  if (numa_nodes.empty()) {
+    ProcessorSet* numa_node = new ProcessorSet;
+    for (
+      vector<uint16_t>::const_iterator logical_processor_i
+      = online_logical_processor_ids.begin();
+      logical_processor_i != online_logical_processor_ids.end();
+      ++logical_processor_i
+    ) {
+      numa_node->set(*logical_processor_i);
+    }
+    numa_nodes.push_back(numa_node);
+    numa_node_ids.push_back(0);
+  }
+}
+
+uint16_t ProcessorTopology::count_cores() {
+  string cpu_dir_path(SYS_DEVICES_SYSTEM);
+  cpu_dir_path.append("/cpu/");
+
+  vector<uint16_t> online_logical_processor_ids;
+  get_online_logical_processor_ids(cpu_dir_path, online_logical_processor_ids);
+
+  // Read one sibling list per core, skipping the siblings it covers.
+  ProcessorSet counted_logical_processors;
+  uint16_t core_count = 0;
+  for (
+    vector<uint16_t>::const_iterator logical_processor_i
+    = online_logical_processor_ids.begin();
+    logical_processor_i != online_logical_processor_ids.end();
+    ++logical_processor_i
+  ) {
+    if (counted_logical_processors.isset(*logical_processor_i)) {
+      continue;
+    }
+
+    core_count++;
+    counted_logical_processors.set(*logical_processor_i);
+
+    char logical_processor_id[8];
+    string list;
+    vector<uint16_t> siblings;
+    if (
+      read_sys_file(
+        get_logical_processor_dir_path(
+          cpu_dir_path,
+          *logical_processor_i,
+          logical_processor_id
+        ) + "topology/thread_siblings_list",
+        list
+      )
+      &&
+      parse_list(list, siblings)
+    ) {
+      for (
+        vector<uint16_t>::const_iterator sibling_i = siblings.begin();
+        sibling_i != siblings.end();
+        ++sibling_i
+      ) {
+        counted_logical_processors.set(*sibling_i);
+      }
+    }
+  }
+
+  return core_count;
+}
+}
+}
@@ -0,0 +1,94 @@
+// yield/thread/linux/semaphore.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "futex.hpp"
+#include "yield/time.hpp"
+#include "yield/thread/semaphore.hpp"
+
+namespace yield {
+namespace thread {
+Semaphore::Semaphore()
+  : count(0), waiter_count(0) {
+}
+
+Semaphore::~Semaphore() {
+}
+
+void Semaphore::post() {
+  count.fetch_add(1, MEMORY_ORDER_SEQ_CST);
+  // Either a waiter sees the new count in futex_wait or we see the waiter.
+  if (waiter_count.load(MEMORY_ORDER_SEQ_CST) > 0) {
+    futex_wake(&count, 1);
+  }
+}
+
+bool Semaphore::timedwait(const Time& timeout) {
+  Time deadline = Time::monotonic_now() + timeout;
+
+  for (;;) {
+    if (trywait()) {
+      return true;
+    }
+
+    Time now = Time::monotonic_now();
+    if (now < deadline) {
+      timespec timeout_left_ts = deadline - now;
+      waiter_count.fetch_add(1, MEMORY_ORDER_SEQ_CST);
+      futex_wait(&count, 0, &timeout_left_ts);
+      waiter_count.fetch_sub(1, MEMORY_ORDER_RELAXED);
+    } else {
+      return false;
+    }
+  }
+}
+
+bool Semaphore::trywait() {
+  uint32_t count = this->count.load(MEMORY_ORDER_RELAXED);
+  while (count > 0) {
+    if (this->count.compare_exchange(count, count - 1, MEMORY_ORDER_ACQUIRE)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Semaphore::wait() {
+  for (;;) {
+    if (trywait()) {
+      return true;
+    }
+
+    waiter_count.fetch_add(1, MEMORY_ORDER_SEQ_CST);
+    futex_wait(&count, 0);
+    waiter_count.fetch_sub(1, MEMORY_ORDER_RELAXED);
+  }
+}
+}
+}
@@ -31,12 +31,29 @@
 #include "yield/time.hpp"
 #include "yield/thread/condition_variable.hpp"
 
+#include <time.h>
+
 namespace yield {
 namespace thread {
 ConditionVariable::ConditionVariable() {
+#ifdef __MACH__
   if (pthread_cond_init(&cond, NULL) != 0) {
     throw Exception();
   }
+#else
+  // Time timedwait deadlines against the monotonic clock, so that setting
+  // the system time doesn't shorten or stretch them.
+  pthread_condattr_t condattr;
+  if (pthread_condattr_init(&condattr) != 0) {
+    throw Exception();
+  }
+  pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+  int ret = pthread_cond_init(&cond, &condattr);
+  pthread_condattr_destroy(&condattr);
+  if (ret != 0) {
+    throw Exception();
+  }
+#endif
 
   if (pthread_mutex_init(&mutex, NULL) != 0) {
     throw Exception();
@@ -61,8 +78,17 @@ void ConditionVariable::signal() {
 }
 
 bool ConditionVariable::timedwait(const Time& timeout) {
+#ifdef __MACH__
   timespec timeout_ts = Time::now() + timeout;
   return pthread_cond_timedwait(&cond, &mutex, &timeout_ts) == 0;
+#else
+  // The deadline must be on the condattr's clock itself, which
+  // Time::monotonic_now() only approximates when it reads the TSC.
+  timespec now_ts;
+  clock_gettime(CLOCK_MONOTONIC, &now_ts);
+  timespec timeout_ts = Time(now_ts) + timeout;
+  return pthread_cond_timedwait(&cond, &mutex, &timeout_ts) == 0;
+#endif
 }
 
 bool ConditionVariable::trylock_mutex() {
@@ -33,7 +33,7 @@
 
 namespace yield {
 namespace thread {
-#ifndef __MACH__
+#if !defined(__linux__) && !defined(__MACH__)
 Semaphore::Semaphore() {
   if (sem_init(&sem, 0, 0) == -1) {
     throw Exception();
@@ -49,6 +49,7 @@ void Semaphore::post() {
 }
 
 bool Semaphore::timedwait(const Time& timeout) {
+  // sem_timedwait only takes CLOCK_REALTIME deadlines.
   timespec timeout_ts = Time::now() + timeout;
   return sem_timedwait(&sem, &timeout_ts) == 0;
 }
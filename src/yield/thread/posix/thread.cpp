@@ -34,32 +34,56 @@
 
 #ifdef __linux__
 #include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 namespace yield {
 namespace thread {
+// The caller's Thread: either a Thread started by the constructor below,
+// which is registered in run() without a reference, or a Thread created by
+// self() for a foreign thread, which is owned by self_thread_owner.
+static thread_local Thread* self_thread = NULL;
+
+/**
+  Owner of the Thread that self() creates for a thread not started by Thread,
+    which it releases at thread exit.
+*/
+class ForeignThread {
+public:
+  ForeignThread() : thread(NULL) { }
+
+  ~ForeignThread() {
+    if (thread != NULL) {
+      self_thread = NULL;
+      Thread::dec_ref(*thread);
+    }
+  }
+
+  Thread* thread;
+};
+
+static thread_local ForeignThread self_thread_owner;
+
+
 Thread::Thread(YO_NEW_REF Runnable& runnable)
   : runnable(&runnable) {
+  joined = false;
   state = STATE_READY;
 
-  pthread_attr_t attr;
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-
-  if (pthread_create(&pthread, &attr, &run, this) == 0) {
-    pthread_attr_destroy(&attr);
-
+  // Joinable, so that join() can wait for the thread; the destructor
+  // reaps threads that were never joined.
+  if (pthread_create(&pthread, NULL, &run, this) == 0) {
     while (state == STATE_READY) {
       sleep(0);
     }
   } else {
-    pthread_attr_destroy(&attr);
     throw Exception();
   }
 }
 
 Thread::Thread(pthread_t pthread)
   : pthread(pthread) {
+  joined = true; // Not ours to reap
   runnable = NULL;
   state = STATE_READY;
 }
@@ -67,7 +91,11 @@ Thread::Thread(pthread_t pthread)
 Thread::~Thread() {
   if (is_running()) {
     cancel();
-    join();
+  }
+
+  if (!joined && !join()) {
+    // e.g., the last reference was released by the thread itself
+    pthread_detach(pthread);
   }
 
   Runnable::dec_ref(runnable);
@@ -82,7 +110,12 @@ void* Thread::getspecific(uintptr_t key) {
 }
 
 bool Thread::join() {
-  return pthread_join(pthread, NULL) != -1;
+  if (pthread_join(pthread, NULL) == 0) {
+    joined = true;
+    return true;
+  } else {
+    return false;
+  }
 }
 
 uintptr_t Thread::key_create() {
@@ -99,13 +132,18 @@ bool Thread::key_delete(uintptr_t key) {
 }
 
 auto_Object<Thread> Thread::self() {
-  Thread* thread = new Thread(pthread_self());
+  if (self_thread == NULL) {
+    Thread* thread = new Thread(pthread_self());
 #if defined(__linux__)
-  thread->tid = syscall(SYS_gettid);
+    thread->tid = syscall(SYS_gettid);
 #elif defined(__sun)
-  thread->thread = thr_self();
+    thread->thread = thr_self();
 #endif
-  return thread;
+    self_thread_owner.thread = thread;
+    self_thread = thread;
+  }
+
+  return Object::inc_ref(*self_thread);
 }
 
 void* Thread::run(void* this_) {
@@ -118,9 +156,11 @@ void* Thread::run() {
 #elif defined(__sun)
   thread = thr_self();
 #endif
+  self_thread = this;
   state = STATE_RUNNING;
   runnable->run();
   state = STATE_SUSPENDED;
+  self_thread = NULL;
   return NULL;
 }
 
@@ -0,0 +1,116 @@
+// yield/thread/processor_topology.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
+
+namespace yield {
+namespace thread {
+static void delete_processor_sets(vector<ProcessorSet*>& processor_sets) {
+  for (
+    vector<ProcessorSet*>::iterator processor_set_i = processor_sets.begin();
+    processor_set_i != processor_sets.end();
+    ++processor_set_i
+  ) {
+    delete *processor_set_i;
+  }
+  processor_sets.clear();
+}
+
+#ifndef __linux__
+ProcessorTopology::ProcessorTopology() {
+  online_logical_processors = new ProcessorSet;
+  ProcessorSet* package = new ProcessorSet;
+  ProcessorSet* numa_node = new ProcessorSet;
+
+  uint16_t logical_processor_count
+  = ProcessorSet::get_online_logical_processor_count();
+  for (
+    uint16_t logical_processor_i = 0;
+    logical_processor_i < logical_processor_count;
+    logical_processor_i++
+  ) {
+    online_logical_processors->set(logical_processor_i);
+    package->set(logical_processor_i);
+    numa_node->set(logical_processor_i);
+
+    ProcessorSet* core = new ProcessorSet;
+    core->set(logical_processor_i);
+    cores.push_back(core);
+  }
+
+  packages.push_back(package);
+  numa_nodes.push_back(numa_node);
+  numa_node_ids.push_back(0);
+}
+
+uint16_t ProcessorTopology::count_cores() {
+  return ProcessorSet::get_online_logical_processor_count();
+}
+#endif
+
+ProcessorTopology::~ProcessorTopology() {
+  for (
+    vector< vector<ProcessorSet*> >::iterator level_i = caches.begin();
+    level_i != caches.end();
+    ++level_i
+  ) {
+    delete_processor_sets(*level_i);
+  }
+  delete_processor_sets(cores);
+  delete_processor_sets(numa_nodes);
+  delete online_logical_processors;
+  delete_processor_sets(packages);
+}
+
+ssize_t
+ProcessorTopology::find(
+  const vector<ProcessorSet*>& sets,
+  uint16_t logical_processor_i
+) {
+  for (size_t set_i = 0; set_i < sets.size(); set_i++) {
+    if (sets[set_i]->isset(logical_processor_i)) {
+      return static_cast<ssize_t>(set_i);
+    }
+  }
+
+  return -1;
+}
+
+const vector<ProcessorSet*>&
+ProcessorTopology::get_caches(uint8_t level) const {
+  static const vector<ProcessorSet*> no_caches;
+  if (level >= 1 && level <= caches.size()) {
+    return caches[level - 1];
+  } else {
+    return no_caches;
+  }
+}
+}
+}
@@ -53,6 +53,18 @@ void ProcessorSet::clear() {
   }
 }
 
+ssize_t ProcessorSet::find_next(uint16_t processor_i) const {
+  if (psetid != PS_NONE) {
+    processorid_t cpuid_max = sysconf(_SC_CPUID_MAX);
+    for (; processor_i <= cpuid_max; processor_i++) {
+      if (isset(processor_i)) {
+        return processor_i;
+      }
+    }
+  }
+  return -1;
+}
+
 uint16_t ProcessorSet::get_online_logical_processor_count() {
   uint16_t online_logical_processor_count = 0;
 
@@ -0,0 +1,105 @@
+// yield/thread/task_group.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/thread/task_group.hpp"
+#include "yield/thread/thread.hpp"
+#include "yield/thread/thread_pool.hpp"
+
+namespace yield {
+namespace thread {
+class TaskGroup::RunnableTask : public Task {
+public:
+  RunnableTask(TaskGroup& task_group, YO_NEW_REF Runnable& runnable)
+    : Task(task_group), runnable(runnable)
+  { }
+
+  ~RunnableTask() {
+    Runnable::dec_ref(runnable);
+  }
+
+protected:
+  // Task
+  void execute() {
+    runnable.run();
+  }
+
+private:
+  Runnable& runnable;
+};
+
+
+TaskGroup::TaskGroup(ThreadPool& thread_pool)
+  : finishing_task_count(0),
+    pending_task_count(0),
+    thread_pool(thread_pool) {
+}
+
+TaskGroup::~TaskGroup() {
+  wait();
+}
+
+void TaskGroup::finish() {
+  finishing_task_count.fetch_add(1, MEMORY_ORDER_RELAXED);
+  if (pending_task_count.fetch_sub(1, MEMORY_ORDER_ACQ_REL) == 1) {
+    finished.lock_mutex();
+    finished.broadcast();
+    finished.unlock_mutex();
+  }
+  finishing_task_count.fetch_sub(1, MEMORY_ORDER_RELEASE);
+}
+
+void TaskGroup::run(YO_NEW_REF Runnable& task) {
+  submit(*new RunnableTask(*this, task));
+}
+
+void TaskGroup::submit(YO_NEW_REF Task& task) {
+  pending_task_count.fetch_add(1, MEMORY_ORDER_RELAXED);
+  thread_pool.submit(task);
+}
+
+void TaskGroup::wait() {
+  while (pending_task_count.load(MEMORY_ORDER_ACQUIRE) != 0) {
+    if (!thread_pool.run_one()) {
+      // Nothing left to help with: the remaining tasks are running on
+      // other threads.
+      finished.lock_mutex();
+      if (pending_task_count.load(MEMORY_ORDER_ACQUIRE) != 0) {
+        finished.wait();
+      }
+      finished.unlock_mutex();
+    }
+  }
+
+  while (finishing_task_count.load(MEMORY_ORDER_ACQUIRE) != 0) {
+    Thread::yield();
+  }
+}
+}
+}
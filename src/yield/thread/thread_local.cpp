@@ -0,0 +1,154 @@
+// yield/thread/thread_local.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/thread/lightweight_mutex.hpp"
+#include "yield/thread/thread_local.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace yield {
+namespace thread {
+#ifdef _WIN32
+__declspec(thread) ThreadLocalKey::Slot* ThreadLocalKey::slots = NULL;
+__declspec(thread) uint32_t ThreadLocalKey::slot_count = 0;
+#else
+__thread ThreadLocalKey::Slot* ThreadLocalKey::slots = NULL;
+__thread uint32_t ThreadLocalKey::slot_count = 0;
+#endif
+
+/**
+  The process-wide allocator of key indices and generations.
+*/
+class ThreadLocalKeys {
+public:
+  static ThreadLocalKeys& get() {
+    // Constructed on first use, so keys may be created during static
+    // initialization of other translation units.
+    static ThreadLocalKeys keys;
+    return keys;
+  }
+
+public:
+  void create(uint32_t& index, uint32_t& generation) {
+    mutex.lock();
+    if (!free_indices.empty()) {
+      index = free_indices.back();
+      free_indices.pop_back();
+    } else {
+      index = static_cast<uint32_t>(generations.size());
+      generations.push_back(0);
+    }
+    // Generation 0 is reserved for unused slots.
+    generation = ++generations[index];
+    mutex.unlock();
+  }
+
+  void destroy(uint32_t index) {
+    mutex.lock();
+    free_indices.push_back(index);
+    mutex.unlock();
+  }
+
+private:
+  LightweightMutex mutex;
+  vector<uint32_t> free_indices;
+  vector<uint32_t> generations;
+};
+
+
+/**
+  Owner of the caller's slot array, which it frees at thread exit.
+*/
+class ThreadLocalSlots {
+public:
+  ~ThreadLocalSlots() {
+    std::free(ThreadLocalKey::slots);
+    ThreadLocalKey::slots = NULL;
+    ThreadLocalKey::slot_count = 0;
+  }
+
+public:
+  void grow(uint32_t min_slot_count) {
+    uint32_t new_slot_count = ThreadLocalKey::slot_count * 2;
+    if (new_slot_count < 8) {
+      new_slot_count = 8;
+    }
+    if (new_slot_count < min_slot_count) {
+      new_slot_count = min_slot_count;
+    }
+
+    ThreadLocalKey::Slot* new_slots
+    = static_cast<ThreadLocalKey::Slot*>(
+        std::realloc(
+          ThreadLocalKey::slots,
+          new_slot_count * sizeof(ThreadLocalKey::Slot)
+        )
+      );
+    if (new_slots == NULL) {
+      throw std::bad_alloc();
+    }
+
+    for (
+      uint32_t slot_i = ThreadLocalKey::slot_count;
+      slot_i < new_slot_count;
+      slot_i++
+    ) {
+      new_slots[slot_i].generation = 0;
+      new_slots[slot_i].value = NULL;
+    }
+
+    ThreadLocalKey::slots = new_slots;
+    ThreadLocalKey::slot_count = new_slot_count;
+  }
+};
+
+// A C++11 thread_local for its destructor, which the trivially-initialized
+// __thread slot array cannot have.
+static thread_local ThreadLocalSlots thread_local_slots;
+
+
+ThreadLocalKey::ThreadLocalKey() {
+  ThreadLocalKeys::get().create(index, generation);
+}
+
+ThreadLocalKey::~ThreadLocalKey() {
+  ThreadLocalKeys::get().destroy(index);
+}
+
+void ThreadLocalKey::set(void* value) {
+  if (index >= slot_count) {
+    thread_local_slots.grow(index + 1);
+  }
+
+  slots[index].generation = generation;
+  slots[index].value = value;
+}
+}
+}
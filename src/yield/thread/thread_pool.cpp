@@ -0,0 +1,263 @@
+// yield/thread/thread_pool.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/thread.hpp"
+#include "yield/thread/thread_pool.hpp"
+
+namespace yield {
+namespace thread {
+using yield::queue::WorkStealingDeque;
+
+class ThreadPool::Worker : public Runnable {
+public:
+  Worker(ThreadPool& thread_pool, uint32_t seed)
+    : seed(seed), thread_pool(thread_pool)
+  { }
+
+  WorkStealingDeque<Runnable>& get_tasks() {
+    return tasks;
+  }
+
+  // Pick a victim to steal from (xorshift32).
+  uint32_t random() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  // yield::thread::Runnable
+  void run() {
+    thread_pool.run_worker(*this);
+  }
+
+private:
+  uint32_t seed;
+  WorkStealingDeque<Runnable> tasks;
+  ThreadPool& thread_pool;
+};
+
+
+ThreadPool::ThreadPool(
+  uint16_t thread_count,
+  const ProcessorSet* logical_processor_set
+)
+  : injected_task_count(0),
+    running(true),
+    sleeping_worker_count(0) {
+  vector<uint16_t> logical_processor_ids;
+  if (logical_processor_set != NULL) {
+    for (
+      ssize_t logical_processor_i = logical_processor_set->find_next(0);
+      logical_processor_i != -1;
+      logical_processor_i = logical_processor_set->find_next(
+                              static_cast<uint16_t>(logical_processor_i + 1)
+                            )
+    ) {
+      logical_processor_ids.push_back(
+        static_cast<uint16_t>(logical_processor_i)
+      );
+    }
+  }
+
+  if (thread_count == 0) {
+    if (!logical_processor_ids.empty()) {
+      thread_count = static_cast<uint16_t>(logical_processor_ids.size());
+    } else {
+      thread_count = ProcessorSet::get_online_logical_processor_count();
+      if (thread_count == 0) {
+        thread_count = 1;
+      }
+    }
+  }
+
+  // Create every worker before starting any thread, so that thieves see
+  // the complete workers vector.
+  for (uint16_t worker_i = 0; worker_i < thread_count; worker_i++) {
+    workers.push_back(new Worker(*this, worker_i + 1));
+  }
+
+  for (uint16_t worker_i = 0; worker_i < thread_count; worker_i++) {
+    Thread* thread = new Thread(workers[worker_i]->inc_ref());
+    if (!logical_processor_ids.empty()) {
+      thread->setaffinity(
+        logical_processor_ids[worker_i % logical_processor_ids.size()]
+      );
+    }
+    threads.push_back(thread);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  running.store(false, MEMORY_ORDER_SEQ_CST);
+  idle.lock_mutex();
+  idle.broadcast();
+  idle.unlock_mutex();
+
+  for (
+    vector<Thread*>::iterator thread_i = threads.begin();
+    thread_i != threads.end();
+    ++thread_i
+  ) {
+    (*thread_i)->join();
+    Thread::dec_ref(**thread_i);
+  }
+
+  for (
+    vector<Worker*>::iterator worker_i = workers.begin();
+    worker_i != workers.end();
+    ++worker_i
+  ) {
+    Runnable* task;
+    while ((task = (*worker_i)->get_tasks().pop()) != NULL) {
+      Runnable::dec_ref(*task);
+    }
+    Worker::dec_ref(**worker_i);
+  }
+
+  for (
+    std::deque<Runnable*>::iterator task_i = injected_tasks.begin();
+    task_i != injected_tasks.end();
+    ++task_i
+  ) {
+    Runnable::dec_ref(**task_i);
+  }
+}
+
+ThreadPool::Worker* ThreadPool::get_current_worker() const {
+  return current_worker.get();
+}
+
+Runnable* ThreadPool::get_task(Worker* worker) {
+  Runnable* task;
+
+  if (worker != NULL) {
+    task = worker->get_tasks().pop();
+    if (task != NULL) {
+      return task;
+    }
+  }
+
+  if (injected_task_count.load(MEMORY_ORDER_ACQUIRE) > 0) {
+    task = NULL;
+    injected_tasks_lock.lock();
+    if (!injected_tasks.empty()) {
+      task = injected_tasks.front();
+      injected_tasks.pop_front();
+      injected_task_count.fetch_sub(1, MEMORY_ORDER_RELAXED);
+    }
+    injected_tasks_lock.unlock();
+    if (task != NULL) {
+      return task;
+    }
+  }
+
+  size_t victim_i = worker != NULL ? worker->random() : 0;
+  for (size_t try_i = 0; try_i < workers.size(); try_i++) {
+    Worker* victim = workers[(victim_i + try_i) % workers.size()];
+    if (victim != worker) {
+      task = victim->get_tasks().steal();
+      if (task != NULL) {
+        return task;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+bool ThreadPool::run_one() {
+  Runnable* task = get_task(get_current_worker());
+  if (task != NULL) {
+    task->run();
+    Runnable::dec_ref(*task);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+void ThreadPool::run_worker(Worker& worker) {
+  current_worker.set(&worker);
+
+  while (running.load(MEMORY_ORDER_ACQUIRE)) {
+    Runnable* task = get_task(&worker);
+
+    for (uint8_t spin_i = 0; task == NULL && spin_i < 32; spin_i++) {
+      Thread::yield();
+      task = get_task(&worker);
+    }
+
+    if (task == NULL) {
+      idle.lock_mutex();
+      sleeping_worker_count.fetch_add(1, MEMORY_ORDER_SEQ_CST);
+      // Pairs with the fence in wake: either the submitter sees this
+      // worker sleeping or this worker sees the submitted task.
+      atomic_fence(MEMORY_ORDER_SEQ_CST);
+      task = get_task(&worker);
+      if (task == NULL && running.load(MEMORY_ORDER_ACQUIRE)) {
+        idle.wait();
+      }
+      sleeping_worker_count.fetch_sub(1, MEMORY_ORDER_RELAXED);
+      idle.unlock_mutex();
+    }
+
+    if (task != NULL) {
+      task->run();
+      Runnable::dec_ref(*task);
+    }
+  }
+}
+
+void ThreadPool::submit(YO_NEW_REF Runnable& task) {
+  Worker* worker = get_current_worker();
+  if (worker != NULL) {
+    worker->get_tasks().push(task);
+  } else {
+    injected_tasks_lock.lock();
+    injected_tasks.push_back(&task);
+    injected_task_count.fetch_add(1, MEMORY_ORDER_RELEASE);
+    injected_tasks_lock.unlock();
+  }
+
+  wake();
+}
+
+void ThreadPool::wake() {
+  atomic_fence(MEMORY_ORDER_SEQ_CST);
+  if (sleeping_worker_count.load(MEMORY_ORDER_RELAXED) > 0) {
+    idle.lock_mutex();
+    idle.signal();
+    idle.unlock_mutex();
+  }
+}
+}
+}
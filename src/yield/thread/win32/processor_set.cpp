@@ -48,6 +48,15 @@ void ProcessorSet::clear(uint16_t processor_i) {
   mask &= ~(1L << processor_i);
 }
 
+ssize_t ProcessorSet::find_next(uint16_t processor_i) const {
+  for (; processor_i < sizeof(uintptr_t) * 8; processor_i++) {
+    if (isset(processor_i)) {
+      return processor_i;
+    }
+  }
+  return -1;
+}
+
 uint16_t ProcessorSet::get_online_logical_processor_count() {
   SYSTEM_INFO system_info;
   GetSystemInfo(&system_info);
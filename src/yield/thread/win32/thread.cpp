@@ -37,6 +37,32 @@
 
 namespace yield {
 namespace thread {
+// The caller's Thread: either a Thread started by the constructor below,
+// which is registered in run() without a reference, or a Thread created by
+// self() for a foreign thread, which is owned by self_thread_owner.
+static thread_local Thread* self_thread = NULL;
+
+/**
+  Owner of the Thread that self() creates for a thread not started by Thread,
+    which it releases at thread exit.
+*/
+class ForeignThread {
+public:
+  ForeignThread() : thread(NULL) { }
+
+  ~ForeignThread() {
+    if (thread != NULL) {
+      self_thread = NULL;
+      Thread::dec_ref(*thread);
+    }
+  }
+
+  Thread* thread;
+};
+
+static thread_local ForeignThread self_thread_owner;
+
+
 Thread::Thread(Runnable& runnable)
   : runnable(&runnable) {
   state = STATE_READY;
@@ -95,14 +121,22 @@ unsigned long __stdcall Thread::run(void* this_) {
 }
 
 unsigned long Thread::run() {
+  self_thread = this;
   state = STATE_RUNNING;
   runnable->run();
   state = STATE_SUSPENDED;
+  self_thread = NULL;
   return 0;
 }
 
 auto_Object<Thread> Thread::self() {
-  return new Thread(GetCurrentThread(), GetCurrentThreadId());
+  if (self_thread == NULL) {
+    Thread* thread = new Thread(GetCurrentThread(), GetCurrentThreadId());
+    self_thread_owner.thread = thread;
+    self_thread = thread;
+  }
+
+  return Object::inc_ref(*self_thread);
 }
 
 //
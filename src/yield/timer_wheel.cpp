@@ -0,0 +1,343 @@
+// yield/timer_wheel.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/debug.hpp"
+#include "yield/event_handler.hpp"
+#include "yield/timer_wheel.hpp"
+
+#ifdef _WIN32
+#include <intrin.h> // For _BitScanForward
+#endif
+
+namespace yield {
+#ifndef _WIN32
+const uint32_t TimerEvent::TYPE_ID;
+const uint8_t TimerWheel::SLOT_BITS;
+const size_t TimerWheel::SLOT_COUNT;
+const uint8_t TimerWheel::WHEEL_COUNT;
+#endif
+
+static const uint64_t SLOT_MASK = TimerWheel::SLOT_COUNT - 1;
+
+// Index of the lowest set bit of a non-zero x.
+static inline uint8_t find_first_set(uint64_t x) {
+#if defined(_WIN64)
+  unsigned long i;
+  _BitScanForward64(&i, x);
+  return static_cast<uint8_t>(i);
+#elif defined(_WIN32)
+  unsigned long i;
+  if (_BitScanForward(&i, static_cast<unsigned long>(x))) {
+    return static_cast<uint8_t>(i);
+  }
+  _BitScanForward(&i, static_cast<unsigned long>(x >> 32));
+  return static_cast<uint8_t>(i + 32);
+#else
+  return static_cast<uint8_t>(__builtin_ctzll(x));
+#endif
+}
+
+TimerWheel::TimerWheel(const Time& resolution)
+  : armed_timer_count(0),
+    base_time(Time::monotonic_now()),
+    current_tick(0),
+    expired_timers(NULL),
+    resolution(resolution) {
+  debug_assert_gt(resolution, static_cast<uint64_t>(0));
+
+  for (uint8_t wheel_i = 0; wheel_i < WHEEL_COUNT; wheel_i++) {
+    occupied_slots[wheel_i] = 0;
+    for (size_t slot_i = 0; slot_i < SLOT_COUNT; slot_i++) {
+      slots[wheel_i][slot_i] = NULL;
+    }
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  while (expired_timers != NULL) {
+    TimerEvent& timer_event = *expired_timers;
+    unlink(timer_event);
+    TimerEvent::dec_ref(timer_event);
+  }
+
+  for (uint8_t wheel_i = 0; wheel_i < WHEEL_COUNT; wheel_i++) {
+    for (size_t slot_i = 0; slot_i < SLOT_COUNT; slot_i++) {
+      while (slots[wheel_i][slot_i] != NULL) {
+        TimerEvent& timer_event = *slots[wheel_i][slot_i];
+        unlink(timer_event);
+        TimerEvent::dec_ref(timer_event);
+      }
+    }
+  }
+}
+
+void TimerWheel::advance(uint64_t now_tick) {
+  while (current_tick <= now_tick) {
+    // Skip straight to the next tick with work instead of visiting
+    // every empty slot in between.
+    uint64_t next_tick = get_next_tick();
+    if (next_tick > now_tick) {
+      current_tick = now_tick + 1;
+      return;
+    }
+    current_tick = next_tick;
+
+    // Cascade the outer wheels whose slot turns over on this tick,
+    // innermost first.
+    if ((current_tick & SLOT_MASK) == 0) {
+      for (uint8_t wheel_i = 1; wheel_i < WHEEL_COUNT; wheel_i++) {
+        size_t slot_i = (current_tick >> (wheel_i * SLOT_BITS)) & SLOT_MASK;
+        cascade(wheel_i, slot_i);
+        if (slot_i != 0) {
+          break;
+        }
+      }
+    }
+
+    TimerEvent** slot = &slots[0][current_tick & SLOT_MASK];
+    while (*slot != NULL) {
+      TimerEvent& timer_event = **slot;
+      debug_assert_le(timer_event.expires_tick, current_tick);
+      unlink(timer_event);
+      link(timer_event, &expired_timers);
+    }
+
+    current_tick++;
+  }
+}
+
+void TimerWheel::arm(YO_NEW_REF TimerEvent& timer_event) {
+  if (timer_event.slot != NULL) {
+    unlink(timer_event);
+    armed_timer_count--;
+    TimerEvent::dec_ref(timer_event);
+  }
+
+  timer_event.deadline = Time::monotonic_now() + timer_event.timeout;
+  // Round up, so that the timer is never delivered early.
+  timer_event.expires_tick
+  = get_tick(timer_event.deadline + resolution - static_cast<uint64_t>(1));
+  link(timer_event);
+  armed_timer_count++;
+}
+
+bool TimerWheel::cancel(TimerEvent& timer_event) {
+  if (timer_event.slot != NULL) {
+    unlink(timer_event);
+    armed_timer_count--;
+    TimerEvent::dec_ref(timer_event);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+void TimerWheel::cascade(uint8_t wheel_i, size_t slot_i) {
+  // Detach the whole slot first: timers beyond the outermost wheel's range
+  // are re-linked into the slot they came from.
+  TimerEvent* timer_event = slots[wheel_i][slot_i];
+  slots[wheel_i][slot_i] = NULL;
+  occupied_slots[wheel_i] &= ~(static_cast<uint64_t>(1) << slot_i);
+
+  while (timer_event != NULL) {
+    TimerEvent* next_timer_event = timer_event->next;
+    timer_event->next = timer_event->prev = NULL;
+    timer_event->slot = NULL;
+    link(*timer_event);
+    timer_event = next_timer_event;
+  }
+}
+
+YO_NEW_REF TimerEvent* TimerWheel::expire(const Time& now) {
+  if (expired_timers == NULL) {
+    if (armed_timer_count == 0) {
+      return NULL;
+    }
+
+    advance(get_tick(now));
+
+    if (expired_timers == NULL) {
+      return NULL;
+    }
+  }
+
+  TimerEvent& timer_event = *expired_timers;
+  unlink(timer_event);
+
+  if (timer_event.period > static_cast<uint64_t>(0)) {
+    // Keep to the original schedule, but skip any periods that were
+    // missed entirely rather than delivering them in a burst.
+    timer_event.deadline += timer_event.period;
+    if (timer_event.deadline <= now) {
+      timer_event.deadline = now + timer_event.period;
+    }
+    timer_event.expires_tick
+    = get_tick(timer_event.deadline + resolution - static_cast<uint64_t>(1));
+    link(timer_event);
+    return &timer_event.inc_ref();
+  } else {
+    armed_timer_count--;
+    return &timer_event;
+  }
+}
+
+size_t TimerWheel::expire(const Time& now, EventHandler& event_handler) {
+  size_t expired_timer_count = 0;
+  for (;;) {
+    TimerEvent* timer_event = expire(now);
+    if (timer_event != NULL) {
+      event_handler.handle(*timer_event);
+      expired_timer_count++;
+    } else {
+      return expired_timer_count;
+    }
+  }
+}
+
+uint64_t TimerWheel::get_next_tick() const {
+  uint64_t next_tick = UINT64_MAX;
+
+  for (uint8_t wheel_i = 0; wheel_i < WHEEL_COUNT; wheel_i++) {
+    uint64_t occupied_slots = this->occupied_slots[wheel_i];
+    if (occupied_slots == 0) {
+      continue;
+    }
+
+    // The first tick at or after current_tick on which this wheel
+    // turns over, counted in this wheel's slots.
+    uint8_t shift = static_cast<uint8_t>(wheel_i * SLOT_BITS);
+    uint64_t first_slot_tick
+    = (current_tick + (static_cast<uint64_t>(1) << shift) - 1) >> shift;
+    size_t first_slot_i = first_slot_tick & SLOT_MASK;
+
+    // Rotate the occupancy bitmap so that bit 0 is first_slot_i.
+    if (first_slot_i != 0) {
+      occupied_slots
+      = (occupied_slots >> first_slot_i)
+        |
+        (occupied_slots << (SLOT_COUNT - first_slot_i));
+    }
+
+    uint64_t tick
+    = (first_slot_tick + find_first_set(occupied_slots)) << shift;
+    if (tick < next_tick) {
+      next_tick = tick;
+    }
+  }
+
+  return next_tick;
+}
+
+Time TimerWheel::get_next_timeout(const Time& now) const {
+  if (expired_timers != NULL) {
+    return static_cast<uint64_t>(0);
+  }
+
+  uint64_t next_tick = get_next_tick();
+  if (next_tick == UINT64_MAX) {
+    return Time::FOREVER;
+  }
+
+  return base_time + resolution * next_tick - now;
+}
+
+uint64_t TimerWheel::get_tick(const Time& time) const {
+  return (time - base_time).ns() / resolution.ns();
+}
+
+void TimerWheel::link(TimerEvent& timer_event) {
+  uint64_t expires_tick = timer_event.expires_tick;
+  if (expires_tick < current_tick) {
+    expires_tick = current_tick;
+  }
+
+  // Pick the innermost wheel whose range covers the timer.
+  uint64_t delta = expires_tick - current_tick;
+  uint8_t wheel_i = 0;
+  while (
+    wheel_i + 1 < WHEEL_COUNT
+    &&
+    delta >= (static_cast<uint64_t>(1) << ((wheel_i + 1) * SLOT_BITS))
+  ) {
+    wheel_i++;
+  }
+
+  // Timers beyond the outermost wheel wait in its furthest slot and are
+  // re-linked when it cascades.
+  uint64_t max_delta
+  = (static_cast<uint64_t>(1) << (WHEEL_COUNT * SLOT_BITS)) - 1;
+  if (delta > max_delta) {
+    expires_tick = current_tick + max_delta;
+  }
+
+  size_t slot_i = (expires_tick >> (wheel_i * SLOT_BITS)) & SLOT_MASK;
+  link(timer_event, &slots[wheel_i][slot_i]);
+}
+
+void TimerWheel::link(TimerEvent& timer_event, TimerEvent** slot) {
+  debug_assert_eq(timer_event.slot, NULL);
+
+  timer_event.next = *slot;
+  timer_event.prev = NULL;
+  if (*slot != NULL) {
+    (*slot)->prev = &timer_event;
+  }
+  *slot = &timer_event;
+  timer_event.slot = slot;
+
+  if (slot != &expired_timers) {
+    size_t slot_i = static_cast<size_t>(slot - &slots[0][0]);
+    occupied_slots[slot_i / SLOT_COUNT]
+    |= static_cast<uint64_t>(1) << (slot_i % SLOT_COUNT);
+  }
+}
+
+void TimerWheel::unlink(TimerEvent& timer_event) {
+  TimerEvent** slot = timer_event.slot;
+  debug_assert_ne(slot, NULL);
+
+  if (timer_event.prev != NULL) {
+    timer_event.prev->next = timer_event.next;
+  } else {
+    *slot = timer_event.next;
+    if (*slot == NULL && slot != &expired_timers) {
+      size_t slot_i = static_cast<size_t>(slot - &slots[0][0]);
+      occupied_slots[slot_i / SLOT_COUNT]
+      &= ~(static_cast<uint64_t>(1) << (slot_i % SLOT_COUNT));
+    }
+  }
+
+  if (timer_event.next != NULL) {
+    timer_event.next->prev = timer_event.prev;
+  }
+
+  timer_event.next = timer_event.prev = NULL;
+  timer_event.slot = NULL;
+}
+}
@@ -48,4 +48,82 @@ TEST(atomic, inc) {
   atomic_t new_current_value = atomic_inc(&current_value);
   ASSERT_EQ(new_current_value, 1);
 }
-}
\ No newline at end of file
+
+TEST(atomic, cas2) {
+  atomic2_t current_value;
+  current_value.lo = 0;
+  current_value.hi = 1;
+
+  atomic2_t old_value;
+  old_value.lo = 0;
+  old_value.hi = 1;
+  atomic2_t new_value;
+  new_value.lo = 2;
+  new_value.hi = 3;
+
+  atomic2_t prev_value = atomic_cas2(&current_value, new_value, old_value);
+  ASSERT_EQ(prev_value.lo, 0);
+  ASSERT_EQ(prev_value.hi, 1);
+  ASSERT_EQ(current_value.lo, 2);
+  ASSERT_EQ(current_value.hi, 3);
+
+  prev_value = atomic_cas2(&current_value, old_value, old_value);
+  ASSERT_EQ(prev_value.lo, 2);
+  ASSERT_EQ(prev_value.hi, 3);
+  ASSERT_EQ(current_value.lo, 2);
+  ASSERT_EQ(current_value.hi, 3);
+}
+
+TEST(Atomic, compare_exchange) {
+  Atomic<atomic_t> value(0);
+  atomic_t expected = 0;
+  ASSERT_TRUE(value.compare_exchange(expected, 1, MEMORY_ORDER_ACQ_REL));
+  ASSERT_EQ(value.load(), 1);
+  ASSERT_FALSE(value.compare_exchange(expected, 2, MEMORY_ORDER_RELEASE));
+  ASSERT_EQ(expected, 1);
+  ASSERT_EQ(value.load(), 1);
+}
+
+TEST(Atomic, exchange) {
+  int x;
+  Atomic<int*> value;
+  ASSERT_EQ(value.exchange(&x, MEMORY_ORDER_ACQUIRE), static_cast<int*>(NULL));
+  ASSERT_EQ(value.load(MEMORY_ORDER_RELAXED), &x);
+}
+
+TEST(Atomic, fetch_add) {
+  Atomic<atomic_t> value(1);
+  ASSERT_EQ(value.fetch_add(1, MEMORY_ORDER_RELAXED), 1);
+  ASSERT_EQ(value.fetch_sub(2, MEMORY_ORDER_RELEASE), 2);
+  ASSERT_EQ(value.load(MEMORY_ORDER_ACQUIRE), 0);
+}
+
+TEST(Atomic, store) {
+  Atomic<atomic_t> value;
+  ASSERT_EQ(value.load(), 0);
+  value.store(1, MEMORY_ORDER_RELEASE);
+  atomic_fence(MEMORY_ORDER_SEQ_CST);
+  ASSERT_EQ(value.load(MEMORY_ORDER_ACQUIRE), 1);
+}
+
+TEST(AtomicTaggedPointer, compare_exchange) {
+  int x;
+  AtomicTaggedPointer<int> value;
+
+  TaggedPointer<int> expected = value.load();
+  ASSERT_EQ(expected.pointer, static_cast<int*>(NULL));
+  ASSERT_EQ(expected.tag, 0);
+
+  TaggedPointer<int> desired;
+  desired.pointer = &x;
+  desired.tag = expected.tag + 1;
+  ASSERT_TRUE(value.compare_exchange(expected, desired));
+
+  // Same pointer, stale tag: ABA must be detected.
+  expected.pointer = &x;
+  expected.tag = 0;
+  ASSERT_FALSE(value.compare_exchange(expected, desired));
+  ASSERT_EQ(expected.pointer, &x);
+  ASSERT_EQ(expected.tag, 1);
+}
+}
@@ -31,6 +31,8 @@
 #include "yield/auto_object.hpp"
 #include "gtest/gtest.h"
 
+#include <utility> // For std::move
+
 namespace yield {
 TEST(auto_Object, null) {
   try {
@@ -68,4 +70,57 @@ TEST(auto_Object, get) {
   }
   ASSERT_TRUE(TestObject::deleted);
 }
+
+TEST(auto_Object, move) {
+  {
+    TestObject* so = new TestObject;
+    auto_Object<TestObject> auto_so(*so);
+    {
+      auto_Object<TestObject> auto_so2(std::move(auto_so));
+      ASSERT_EQ(&auto_so2.get(), so);
+    }
+    ASSERT_TRUE(TestObject::deleted);
+  }
+}
+
+TEST(auto_Object, move_assign) {
+  auto_Object<TestObject> auto_so(new TestObject);
+  TestObject* so2 = new TestObject;
+  auto_so = auto_Object<TestObject>(*so2);
+  ASSERT_TRUE(TestObject::deleted);
+  ASSERT_EQ(&auto_so.get(), so2);
+}
+
+TEST(auto_Object, move_from_moved) {
+  {
+    auto_Object<TestObject> auto_so(new TestObject);
+    auto_Object<TestObject> auto_so2(std::move(auto_so));
+    auto_Object<Object> auto_o(std::move(auto_so));
+    ASSERT_EQ(auto_so.release(), static_cast<TestObject*>(NULL));
+    ASSERT_EQ(auto_o.release(), static_cast<Object*>(NULL));
+    ASSERT_FALSE(TestObject::deleted);
+  }
+  ASSERT_TRUE(TestObject::deleted);
+}
+
+TEST(auto_Object, move_upcast) {
+  {
+    auto_Object<TestObject> auto_so(new TestObject);
+    auto_Object<Object> auto_o(std::move(auto_so));
+    ASSERT_FALSE(TestObject::deleted);
+  }
+  ASSERT_TRUE(TestObject::deleted);
+}
+
+TEST(auto_Object, release) {
+  TestObject* so = new TestObject;
+  {
+    auto_Object<TestObject> auto_so(*so);
+    ASSERT_EQ(auto_so.release(), so);
+    ASSERT_EQ(auto_so.release(), static_cast<TestObject*>(NULL));
+  }
+  ASSERT_FALSE(TestObject::deleted);
+  TestObject::dec_ref(*so);
+  ASSERT_TRUE(TestObject::deleted);
+}
 }
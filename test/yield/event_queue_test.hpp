@@ -63,6 +63,18 @@ TYPED_TEST_P(EventQueueTest, dequeue) {
   ASSERT_EQ(null_event, static_cast<Event*>(NULL));
 }
 
+TYPED_TEST_P(EventQueueTest, enqueue_auto_Object) {
+  auto_Object<Event> event = new typename EventQueueTest<TypeParam>::MockEvent;
+  TypeParam event_queue;
+
+  bool enqueue_ret
+  = static_cast<EventQueue&>(event_queue).enqueue(auto_Object<Event>(event));
+  ASSERT_TRUE(enqueue_ret);
+
+  auto_Object<Event> dequeued_event = event_queue.dequeue();
+  ASSERT_EQ(event, dequeued_event);
+}
+
 TYPED_TEST_P(EventQueueTest, timeddequeue) {
   auto_Object<Event> event = new typename EventQueueTest<TypeParam>::MockEvent;
   TypeParam event_queue;
@@ -93,7 +105,13 @@ TYPED_TEST_P(EventQueueTest, trydequeue) {
   ASSERT_EQ(null_event, static_cast<Event*>(NULL));
 }
 
-REGISTER_TYPED_TEST_CASE_P(EventQueueTest, dequeue, timeddequeue, trydequeue);
+REGISTER_TYPED_TEST_CASE_P(
+  EventQueueTest,
+  dequeue,
+  enqueue_auto_Object,
+  timeddequeue,
+  trydequeue
+);
 }
 
 #endif
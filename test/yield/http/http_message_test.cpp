@@ -104,5 +104,25 @@ TEST(HTTPMessage, get_fields) {
   ASSERT_EQ(fields[1].first.iov_len, 5);
   ASSERT_EQ(fields[1].second.iov_len, 9);
 }
+
+TEST(HTTPMessage, release_body) {
+  auto_Object<Buffer> body = Buffer::copy("body");
+  auto_Object<HTTPRequest> http_request
+  = new HTTPRequest(HTTPRequest::Method::GET, "/", &body->inc_ref());
+  auto_Object<Object> released_body = http_request->release_body();
+  ASSERT_EQ(&released_body.get(), static_cast<Object*>(&body.get()));
+  ASSERT_EQ(http_request->get_body(), static_cast<Object*>(NULL));
+  ASSERT_EQ(http_request->release_body(), static_cast<Object*>(NULL));
+}
+
+TEST(HTTPMessage, release_header) {
+  HTTPRequest* http_request = new HTTPRequest(HTTPRequest::Method::GET, "/");
+  http_request->set_field("Host", "localhost");
+  Buffer* header = &http_request->get_header();
+  auto_Object<Buffer> released_header = http_request->release_header();
+  HTTPRequest::dec_ref(*http_request);
+  ASSERT_EQ(&released_header.get(), header);
+  ASSERT_GT(released_header->size(), 0u);
+}
 }
 }
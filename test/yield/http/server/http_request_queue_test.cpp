@@ -34,13 +34,23 @@
 #include "yield/fs/file_system.hpp"
 #include "yield/fs/stat.hpp"
 #include "yield/http/http_response.hpp"
+#include "yield/http/server/http_connection.hpp"
 #include "yield/http/server/http_request.hpp"
 #include "yield/http/server/http_request_queue.hpp"
+#include "yield/sockets/tcp_socket.hpp"
 #include "gtest/gtest.h"
 
+#include <sstream>
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
 namespace yield {
 namespace http {
 namespace server {
+using yield::sockets::SocketAddress;
+using yield::sockets::TCPSocket;
+
 class TestHTTPRequestQueue : public HTTPRequestQueue<> {
 public:
   TestHTTPRequestQueue(YO_NEW_REF Log* log = NULL)
@@ -57,6 +67,16 @@ protected:
       http_request.respond(200, "Hello world");
     } else if (http_request.get_uri().get_path() == "/drop") {
       ;
+    } else if (http_request.get_uri().get_path() == "/keep") {
+      // Keep a reference to the response past respond, e.g. to log it.
+      HTTPResponse& http_response
+      = *new HTTPResponse(200, &Buffer::copy("Hello world"));
+      http_request.respond(http_response.inc_ref());
+      std::ostringstream http_response_str;
+      http_response_str << http_response;
+      ASSERT_GT(http_response.get_header().size(), 12u);
+      ASSERT_EQ(memcmp(http_response.get_header(), "HTTP/1.1 200", 12), 0);
+      HTTPResponse::dec_ref(http_response);
     } else if (http_request.get_uri().get_path() == "/sendfile") {
       yield::fs::File* file
 #ifdef _WIN32
@@ -89,6 +109,253 @@ protected:
   }
 };
 
+TEST_F(HTTPRequestQueueTest, sendfile) {
+  HTTPRequestQueue<> http_request_queue(8003);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8003))) {
+    throw Exception();
+  }
+
+  const char* request = "GET /sendfile HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+  ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+  HTTPRequest* http_request
+  = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(5.0));
+  ASSERT_TRUE(http_request != NULL);
+  handle(*http_request);
+
+  // The header is held back until the file body follows it.
+  string response;
+  client_socket.set_blocking_mode(false);
+  for (uint8_t try_i = 0; try_i < 50; ++try_i) {
+    http_request_queue.timeddequeue(0.1);
+    char data[4096];
+    ssize_t recv_ret;
+    while ((recv_ret = client_socket.recv(data, sizeof(data), 0)) > 0) {
+      response.append(data, static_cast<size_t>(recv_ret));
+    }
+    size_t body_offset = response.find("\r\n\r\n");
+    if (body_offset != string::npos && response.size() > body_offset + 4) {
+      break;
+    }
+  }
+
+  ASSERT_EQ(response.compare(0, 12, "HTTP/1.1 200"), 0);
+  size_t body_offset = response.find("\r\n\r\n");
+  ASSERT_NE(body_offset, string::npos);
+  ASSERT_GT(response.size(), body_offset + 4);
+}
+
+TEST_F(HTTPRequestQueueTest, post_large_body) {
+  HTTPRequestQueue<> http_request_queue(8002);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8002))) {
+    throw Exception();
+  }
+
+  // Large enough to grow the connection's recv buffers over several reads,
+  // and sized so that the request exactly fills its continuation buffer.
+  const char* request_header
+  = "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 65477\r\n\r\n";
+  string body(64 * 1024 - strlen(request_header), 'x');
+  std::ostringstream request;
+  request << request_header << body;
+
+  size_t recv_buffer_capacity = Buffer::getpagesize();
+  for (uint8_t request_i = 0; request_i < 3; ++request_i) {
+    // Full reads of the large requests grow the connection's recv buffers;
+    // the small last request shrinks them again.
+    string request_str
+    = request_i < 2 ? request.str()
+      : "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    client_socket.set_blocking_mode(true);
+    ssize_t send_ret
+    = client_socket.send(request_str.data(), request_str.size(), 0);
+    ASSERT_EQ(send_ret, static_cast<ssize_t>(request_str.size()));
+
+    HTTPRequest* http_request
+    = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(5.0));
+    ASSERT_TRUE(http_request != NULL);
+    size_t next_recv_buffer_capacity
+    = http_request->get_connection().get_recv_buffer_capacity();
+    if (request_i < 2) {
+      ASSERT_EQ(http_request->get_content_length(), body.size());
+      ASSERT_GE(next_recv_buffer_capacity, recv_buffer_capacity);
+      // Continuation buffers filled by the body must not grow it further.
+      ASSERT_LE(next_recv_buffer_capacity, 4 * Buffer::getpagesize());
+      if (request_i == 1) {
+        ASSERT_GT(next_recv_buffer_capacity, Buffer::getpagesize());
+      }
+    } else {
+      ASSERT_LT(next_recv_buffer_capacity, recv_buffer_capacity);
+    }
+    recv_buffer_capacity = next_recv_buffer_capacity;
+    handle(*http_request);
+
+    char response[1024];
+    ssize_t recv_ret = 0;
+    for (uint8_t try_i = 0; try_i < 50 && recv_ret <= 0; ++try_i) {
+      http_request_queue.timeddequeue(0.1);
+      client_socket.set_blocking_mode(false);
+      recv_ret = client_socket.recv(response, sizeof(response), 0);
+    }
+    ASSERT_GT(recv_ret, 12);
+    ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+  }
+}
+
+TEST_F(HTTPRequestQueueTest, respond_keep_reference) {
+  HTTPRequestQueue<> http_request_queue(8007);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8007))) {
+    throw Exception();
+  }
+
+  const char* request = "GET /keep HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+  ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+  HTTPRequest* http_request
+  = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(5.0));
+  ASSERT_TRUE(http_request != NULL);
+  handle(*http_request);
+  http_request_queue.timeddequeue(0.1);
+
+  char response[1024];
+  ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+  ASSERT_GT(recv_ret, 12);
+  ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+}
+
+TEST_F(HTTPRequestQueueTest, idle_timeout) {
+  HTTPRequestQueue<> http_request_queue(8001, NULL, 0.1);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8001))) {
+    throw Exception();
+  }
+
+  const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+  ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+  // Respond to the request, then leave the connection idle past its timeout.
+  Time stop_time = Time::monotonic_now() + Time(0.5);
+  while (Time::monotonic_now() < stop_time) {
+    HTTPRequest* http_request
+    = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(0.1));
+    if (http_request != NULL) {
+      handle(*http_request);
+    }
+  }
+
+  char response[1024];
+  ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+  ASSERT_GT(recv_ret, 12);
+  ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+
+  // The server closed the idle connection.
+  ASSERT_EQ(client_socket.recv(response, sizeof(response), 0), 0);
+}
+
+TEST_F(HTTPRequestQueueTest, idle_timeout_slow_handler) {
+  HTTPRequestQueue<> http_request_queue(8006, NULL, 0.1);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8006))) {
+    throw Exception();
+  }
+
+  const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+  ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+  HTTPRequest* http_request = NULL;
+  while (http_request == NULL) {
+    http_request
+    = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(0.1));
+  }
+
+  // Hold the request past the connection's idle timeout, as a slow handler
+  // would, while the queue keeps reaping idle connections.
+  Time stop_time = Time::monotonic_now() + Time(0.5);
+  while (Time::monotonic_now() < stop_time) {
+    Event* event = http_request_queue.timeddequeue(0.1);
+    if (event != NULL) {
+      Event::dec_ref(*event);
+    }
+  }
+  handle(*http_request);
+  Event* event = http_request_queue.timeddequeue(0.1);
+  if (event != NULL) {
+    Event::dec_ref(*event);
+  }
+
+  char response[1024];
+  ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+  ASSERT_GT(recv_ret, 12);
+  ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+}
+
+TEST_F(HTTPRequestQueueTest, peer_reset) {
+  HTTPRequestQueue<> http_request_queue(8004);
+
+  const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  char response[1024];
+  for (uint8_t client_i = 0; client_i < 2; ++client_i) {
+    auto_Object<TCPSocket> client_socket = new TCPSocket;
+    if (!client_socket->connect(SocketAddress("127.0.0.1", 8004))) {
+      throw Exception();
+    }
+
+    ssize_t send_ret = client_socket->send(request, strlen(request), 0);
+    ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+    HTTPRequest* http_request = NULL;
+    for (uint8_t try_i = 0; try_i < 50 && http_request == NULL; ++try_i) {
+      http_request
+      = Object::cast<HTTPRequest>(http_request_queue.timeddequeue(0.1));
+    }
+    ASSERT_TRUE(http_request != NULL);
+    handle(*http_request);
+
+    ssize_t recv_ret = 0;
+    for (uint8_t try_i = 0; try_i < 50 && recv_ret <= 0; ++try_i) {
+      http_request_queue.timeddequeue(0.1);
+      client_socket->set_blocking_mode(false);
+      recv_ret = client_socket->recv(response, sizeof(response), 0);
+    }
+    ASSERT_GT(recv_ret, 12);
+    ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+
+    // Close the first connection with a RST, which the server sees as
+    // an event with several types (IN | HUP | ERR) at once. The server
+    // must survive it and go on to serve the second connection.
+    if (client_i == 0) {
+      linger linger_ = { 1, 0 };
+      ::setsockopt(
+        *client_socket,
+        SOL_SOCKET,
+        SO_LINGER,
+        reinterpret_cast<char*>(&linger_),
+        static_cast<int>(sizeof(linger_))
+      );
+      client_socket = auto_Object<TCPSocket>(new TCPSocket);
+      for (uint8_t try_i = 0; try_i < 5; ++try_i) {
+        ASSERT_EQ(
+          http_request_queue.timeddequeue(0.1),
+          static_cast<Event*>(NULL)
+        );
+      }
+    }
+  }
+}
+
 TEST_F(HTTPRequestQueueTest, dequeue) {
   TestHTTPRequestQueue http_request_queue(&Log::open(std::cout));
   for (;;) {
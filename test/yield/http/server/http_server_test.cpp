@@ -0,0 +1,142 @@
+// yield/http/server/http_server_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/exception.hpp"
+#include "yield/http/server/http_request.hpp"
+#include "yield/http/server/http_server.hpp"
+#include "yield/sockets/tcp_socket.hpp"
+#include "yield/stage/seda_stage_scheduler.hpp"
+#include "yield/thread/thread.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace http {
+namespace server {
+using yield::sockets::SocketAddress;
+using yield::sockets::TCPSocket;
+using yield::stage::SEDAStageScheduler;
+using yield::thread::Thread;
+
+class HTTPServerTestHTTPRequestHandler : public EventHandler {
+public:
+  // yield::EventHandler
+  void handle(YO_NEW_REF Event& event) {
+    HTTPRequest* http_request = Object::cast<HTTPRequest>(&event);
+    if (http_request != NULL) {
+      http_request->respond(200, "Hello world");
+    }
+    Event::dec_ref(event);
+  }
+};
+
+TEST(HTTPServer, respond_from_workers) {
+  HTTPServer<>* http_server
+  = new HTTPServer<>(*new HTTPServerTestHTTPRequestHandler, 8082, 2);
+  SEDAStageScheduler* stage_scheduler = new SEDAStageScheduler;
+  stage_scheduler->schedule(*http_server);
+  HTTPServer<>::dec_ref(*http_server);
+
+  // Responses are marshalled from the workers back to the server's thread.
+  for (uint8_t connection_i = 0; connection_i < 2; ++connection_i) {
+    TCPSocket client_socket;
+    if (!client_socket.connect(SocketAddress("127.0.0.1", 8082))) {
+      throw Exception();
+    }
+
+    for (uint8_t request_i = 0; request_i < 2; ++request_i) {
+      const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+      ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+      ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+      char response[1024];
+      ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+      ASSERT_GT(recv_ret, 12);
+      ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+    }
+  }
+
+  SEDAStageScheduler::dec_ref(*stage_scheduler);
+}
+
+class HTTPServerTestPipelinedHTTPRequestHandler : public EventHandler {
+public:
+  // yield::EventHandler
+  void handle(YO_NEW_REF Event& event) {
+    HTTPRequest* http_request = Object::cast<HTTPRequest>(&event);
+    if (http_request != NULL) {
+      string path = http_request->get_uri().get_path();
+      if (path == "/slow") {
+        // Let the next request's response reach the server's thread first.
+        Thread::sleep(0.1);
+      }
+      http_request->respond(200, path.c_str());
+    }
+    Event::dec_ref(event);
+  }
+};
+
+TEST(HTTPServer, respond_to_pipelined_requests_in_order) {
+  HTTPServer<>* http_server
+  = new HTTPServer<>(
+    *new HTTPServerTestPipelinedHTTPRequestHandler,
+    8005,
+    2
+  );
+  SEDAStageScheduler* stage_scheduler = new SEDAStageScheduler;
+  stage_scheduler->schedule(*http_server);
+  HTTPServer<>::dec_ref(*http_server);
+
+  TCPSocket client_socket;
+  if (!client_socket.connect(SocketAddress("127.0.0.1", 8005))) {
+    throw Exception();
+  }
+
+  const char* requests
+  = "GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n"
+    "GET /fast HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ssize_t send_ret = client_socket.send(requests, strlen(requests), 0);
+  ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(requests)));
+
+  string responses;
+  while (responses.find("/slow") == string::npos
+         ||
+         responses.find("/fast") == string::npos) {
+    char response[1024];
+    ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+    ASSERT_GT(recv_ret, 0);
+    responses.append(response, static_cast<size_t>(recv_ret));
+  }
+  ASSERT_LT(responses.find("/slow"), responses.find("/fast"));
+
+  SEDAStageScheduler::dec_ref(*stage_scheduler);
+}
+}
+}
+}
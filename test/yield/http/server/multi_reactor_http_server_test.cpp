@@ -0,0 +1,91 @@
+// yield/http/server/multi_reactor_http_server_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/auto_object.hpp"
+#include "yield/exception.hpp"
+#include "yield/http/server/http_request.hpp"
+#include "yield/http/server/multi_reactor_http_server.hpp"
+#include "yield/sockets/tcp_socket.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace http {
+namespace server {
+using yield::sockets::SocketAddress;
+using yield::sockets::TCPSocket;
+
+class MultiReactorHTTPServerTestHTTPRequestHandler : public EventHandler {
+public:
+  // yield::EventHandler
+  void handle(YO_NEW_REF Event& event) {
+    HTTPRequest* http_request = Object::cast<HTTPRequest>(&event);
+    if (http_request != NULL) {
+      http_request->respond(200, "Hello world");
+    }
+    Event::dec_ref(event);
+  }
+};
+
+TEST(MultiReactorHTTPServer, constructor) {
+  MultiReactorHTTPServer<> http_server(
+    *new MultiReactorHTTPServerTestHTTPRequestHandler,
+    8081,
+    2
+  );
+  ASSERT_EQ(http_server.get_reactor_count(), 2u);
+}
+
+TEST(MultiReactorHTTPServer, respond) {
+  MultiReactorHTTPServer<> http_server(
+    *new MultiReactorHTTPServerTestHTTPRequestHandler,
+    8081,
+    2
+  );
+
+  // Each connection is serviced by whichever reactor the kernel hands it to.
+  for (uint8_t connection_i = 0; connection_i < 4; ++connection_i) {
+    TCPSocket client_socket;
+    if (!client_socket.connect(SocketAddress("127.0.0.1", 8081))) {
+      throw Exception();
+    }
+
+    const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ssize_t send_ret = client_socket.send(request, strlen(request), 0);
+    ASSERT_EQ(send_ret, static_cast<ssize_t>(strlen(request)));
+
+    char response[1024];
+    ssize_t recv_ret = client_socket.recv(response, sizeof(response), 0);
+    ASSERT_GT(recv_ret, 12);
+    ASSERT_EQ(memcmp(response, "HTTP/1.1 200", 12), 0);
+  }
+}
+}
+}
+}
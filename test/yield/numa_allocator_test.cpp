@@ -0,0 +1,140 @@
+// yield/numa_allocator_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/numa_allocator.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+namespace yield {
+static bool is_aligned(const void* ptr, size_t alignment) {
+  return (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0;
+}
+
+TEST(NUMAAllocator, allocate) {
+  void* ptr = NUMAAllocator::allocate(100);
+  ASSERT_TRUE(is_aligned(ptr, NUMAAllocator::ALIGNMENT_DEFAULT));
+  std::memset(ptr, 0xff, 100);
+  NUMAAllocator::deallocate(ptr);
+}
+
+TEST(NUMAAllocator, allocate_aligned) {
+  for (size_t alignment = 1; alignment <= 8192; alignment <<= 1) {
+    void* ptr = NUMAAllocator::allocate(alignment, alignment);
+    ASSERT_TRUE(is_aligned(ptr, alignment));
+    std::memset(ptr, 0xff, alignment);
+    NUMAAllocator::deallocate(ptr);
+
+    ptr = NUMAAllocator::allocate(alignment, alignment, 0);
+    ASSERT_TRUE(is_aligned(ptr, alignment));
+    std::memset(ptr, 0xff, alignment);
+    NUMAAllocator::deallocate(ptr);
+  }
+}
+
+TEST(NUMAAllocator, allocate_aligned_unpadded) {
+  // Aligned blocks take only their size class, so two of them are adjacent.
+  size_t size = 128 * 1024;
+  void* ptr1 = NUMAAllocator::allocate(size, size, 0);
+  void* ptr2 = NUMAAllocator::allocate(size, size, 0);
+  ASSERT_TRUE(is_aligned(ptr1, size));
+  ASSERT_TRUE(is_aligned(ptr2, size));
+#ifdef __linux__
+  ASSERT_EQ(
+    static_cast<char*>(ptr1) > static_cast<char*>(ptr2)
+    ? static_cast<size_t>(static_cast<char*>(ptr1) - static_cast<char*>(ptr2))
+    : static_cast<size_t>(static_cast<char*>(ptr2) - static_cast<char*>(ptr1)),
+    size
+  );
+#endif
+  NUMAAllocator::deallocate(ptr2);
+  NUMAAllocator::deallocate(ptr1);
+}
+
+TEST(NUMAAllocator, allocate_large) {
+  size_t size = 1024 * 1024 + 1;
+  void* ptr = NUMAAllocator::allocate(size, 4096, 0);
+  ASSERT_TRUE(is_aligned(ptr, 4096));
+  std::memset(ptr, 0xff, size);
+  NUMAAllocator::deallocate(ptr);
+}
+
+TEST(NUMAAllocator, allocate_on_node) {
+  // Node 0 always exists; this exercises the arena path even on
+  // single-node systems.
+  vector<void*> ptrs;
+  for (size_t size = 1; size <= 256 * 1024; size *= 3) {
+    void* ptr
+    = NUMAAllocator::allocate(size, NUMAAllocator::ALIGNMENT_DEFAULT, 0);
+    std::memset(ptr, 0xff, size);
+#ifdef __linux__
+    ASSERT_EQ(NUMAAllocator::get_numa_node_id(ptr), 0);
+#endif
+    ptrs.push_back(ptr);
+  }
+
+  for (size_t ptr_i = 0; ptr_i < ptrs.size(); ptr_i++) {
+    NUMAAllocator::deallocate(ptrs[ptr_i]);
+  }
+
+  // Freed blocks are reused.
+  void* ptr1
+  = NUMAAllocator::allocate(100, NUMAAllocator::ALIGNMENT_DEFAULT, 0);
+  NUMAAllocator::deallocate(ptr1);
+  void* ptr2
+  = NUMAAllocator::allocate(100, NUMAAllocator::ALIGNMENT_DEFAULT, 0);
+  NUMAAllocator::deallocate(ptr2);
+  ASSERT_EQ(ptr1, ptr2);
+}
+
+TEST(NUMAAllocator, deallocate_NULL) {
+  NUMAAllocator::deallocate(NULL);
+}
+
+TEST(NUMAAllocator, get_current_numa_node_id) {
+  ASSERT_LT(
+    NUMAAllocator::get_current_numa_node_id(),
+    1024
+  );
+}
+
+TEST(NUMAAllocator, get_numa_node_count) {
+  ASSERT_GE(NUMAAllocator::get_numa_node_count(), 1);
+}
+
+TEST(NUMAAllocator, set_preferred_numa_node) {
+#ifdef __linux__
+  if (NUMAAllocator::set_preferred_numa_node(0)) {
+    ASSERT_TRUE(
+      NUMAAllocator::set_preferred_numa_node(NUMAAllocator::NUMA_NODE_LOCAL)
+    );
+  }
+#endif
+}
+}
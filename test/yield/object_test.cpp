@@ -28,8 +28,11 @@
 // THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "test_object.hpp"
+#include "yield/time.hpp"
 #include "gtest/gtest.h"
 
+#include <iostream>
+
 namespace yield {
 bool TestObject::deleted = false;
 
@@ -46,11 +49,67 @@ TEST(Object, dec_ref) {
   ASSERT_TRUE(TestObject::deleted);
 }
 
+TEST(Object, dec_ref_thread_confined) {
+  TestObject* test_object = new TestObject;
+  test_object->set_thread_confined(true);
+  Object::inc_ref(test_object);
+  Object::inc_ref(test_object);
+  Object::dec_ref(test_object);
+  Object::dec_ref(test_object);
+  ASSERT_FALSE(TestObject::deleted);
+  ASSERT_TRUE(test_object->is_thread_confined());
+  Object::dec_ref(test_object);
+  ASSERT_TRUE(TestObject::deleted);
+}
+
+// Atomic vs. thread-confined inc_ref/dec_ref pairs on one thread.
+// Run with --gtest_also_run_disabled_tests.
+TEST(Object, DISABLED_inc_ref_dec_ref) {
+  const uint32_t iteration_count = 100000000;
+  TestObject* test_object = new TestObject;
+
+  uint64_t ns[2];
+  for (uint8_t thread_confined = 0; thread_confined < 2; ++thread_confined) {
+    test_object->set_thread_confined(thread_confined == 1);
+    Time start_time(Time::monotonic_now());
+    for (uint32_t i = 0; i < iteration_count; ++i) {
+      Object::inc_ref(test_object);
+      Object::dec_ref(test_object);
+    }
+    ns[thread_confined] = (Time::monotonic_now() - start_time).ns();
+  }
+
+  ASSERT_FALSE(TestObject::deleted);
+  Object::dec_ref(test_object);
+
+  std::cout << "atomic "
+            << static_cast<double>(iteration_count) / ns[0] * 1000.0
+            << " Mops/s, thread-confined "
+            << static_cast<double>(iteration_count) / ns[1] * 1000.0
+            << " Mops/s" << std::endl;
+}
+
 TEST(Object, inc_ref) {
   TestObject* test_object = new TestObject;
   Object::inc_ref(test_object);
 }
 
+TEST(Object, set_thread_confined) {
+  TestObject* test_object = new TestObject;
+  ASSERT_FALSE(test_object->is_thread_confined());
+  test_object->set_thread_confined(true);
+  ASSERT_TRUE(test_object->is_thread_confined());
+  Object::inc_ref(test_object);
+  Object::dec_ref(test_object);
+  test_object->set_thread_confined(false);
+  ASSERT_FALSE(test_object->is_thread_confined());
+  Object::inc_ref(test_object);
+  Object::dec_ref(test_object);
+  ASSERT_FALSE(TestObject::deleted);
+  Object::dec_ref(test_object);
+  ASSERT_TRUE(TestObject::deleted);
+}
+
 TEST(Object, rtti) {
   TestObject test_object;
   ASSERT_EQ(test_object.get_type_id(), 0);
@@ -161,6 +161,15 @@ TEST_F(FDEventQueueTest, associate_zero) {
   ASSERT_EQ(event, static_cast<Event*>(NULL));
 }
 
+TEST(FDEventQueue, cancel_timer) {
+  FDEventQueue fd_event_queue;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.01));
+  fd_event_queue.arm_timer(timer_event->inc_ref());
+  ASSERT_TRUE(fd_event_queue.cancel_timer(*timer_event));
+  Event* event = fd_event_queue.timeddequeue(Time(0.05));
+  ASSERT_EQ(event, static_cast<Event*>(NULL));
+}
+
 TEST(FDEventQueue, constructor) {
   FDEventQueue();
 }
@@ -177,6 +186,36 @@ TEST_F(FDEventQueueTest, dequeue_FDEvent) {
   auto_Object<Event> event = fd_event_queue.dequeue();
 }
 
+TEST(FDEventQueue, dequeue_TimerEvent) {
+  FDEventQueue fd_event_queue;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.05));
+  fd_event_queue.arm_timer(timer_event->inc_ref());
+
+  // The caller's timeout still applies when it is shorter.
+  Event* event = fd_event_queue.timeddequeue(Time(0.01));
+  ASSERT_EQ(event, static_cast<Event*>(NULL));
+
+  auto_Object<Event> dequeued_event = fd_event_queue.dequeue();
+  ASSERT_EQ(&dequeued_event.get(), &timer_event.get());
+  ASSERT_GE(Time::monotonic_now(), timer_event->get_deadline());
+}
+
+TEST_F(FDEventQueueTest, dequeue_TimerEvent_and_FDEvent) {
+  FDEventQueue fd_event_queue;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.05));
+  fd_event_queue.arm_timer(timer_event->inc_ref());
+
+  if (!fd_event_queue.associate(get_read_fd(), FDEvent::TYPE_READ_READY)) {
+    throw Exception();
+  }
+
+  signal_pipe();
+
+  auto_Object<Event> event = fd_event_queue.dequeue();
+  ASSERT_EQ(event->get_type_id(), FDEvent::TYPE_ID);
+  ASSERT_TRUE(timer_event->is_armed());
+}
+
 TEST_F(FDEventQueueTest, dequeue_writable_FDEvent) {
   FDEventQueue fd_event_queue;
 
@@ -53,6 +53,14 @@ TEST(FDEvent, get_type) {
   );
 }
 
+TEST(FDEvent, get_type_mask) {
+  FDEvent::Type type = FDEvent::TYPE_READ_READY | FDEvent::TYPE_HUP;
+  FDEvent fd_event(static_cast<fd_t>(0), type);
+  ASSERT_EQ(fd_event.get_type(), type);
+  ASSERT_NE(fd_event.get_type() & FDEvent::TYPE_HUP, 0);
+  ASSERT_EQ(fd_event.get_type() & FDEvent::TYPE_WRITE_READY, 0);
+}
+
 TEST(FDEvent, get_type_id) {
   ASSERT_EQ(
     FDEvent(static_cast<fd_t>(0), FDEvent::TYPE_READ_READY).get_type_id(),
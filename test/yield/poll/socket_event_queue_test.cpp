@@ -152,6 +152,63 @@ TEST(SocketEventQueue, dequeue_SocketEvent) {
   = Object::cast<FDEvent>(socket_event_queue.dequeue());
 }
 
+TEST(SocketEventQueue, dequeue_HUP_SocketEvent) {
+  StreamSocketPair sockets;
+  FDEventQueue socket_event_queue(true);
+
+  if (
+    !socket_event_queue.associate(sockets.first(), FDEvent::TYPE_READ_READY)
+  ) {
+    throw Exception();
+  }
+
+  sockets.second().send("m", 1, 0);
+  if (!sockets.second().shutdown()) {
+    throw Exception();
+  }
+
+  auto_Object<FDEvent> socket_event
+  = Object::cast<FDEvent>(socket_event_queue.dequeue());
+  ASSERT_EQ(socket_event->get_fd(), sockets.first());
+  ASSERT_NE(socket_event->get_type() & FDEvent::TYPE_READ_READY, 0);
+#ifdef __linux__
+  ASSERT_NE(socket_event->get_type() & FDEvent::TYPE_HUP, 0);
+#endif
+}
+
+TEST(SocketEventQueue, dequeue_read_and_write_ready_SocketEvent) {
+  StreamSocketPair sockets;
+  FDEventQueue socket_event_queue(true);
+
+  if (
+    !socket_event_queue.associate(
+      sockets.first(),
+      FDEvent::TYPE_READ_READY | FDEvent::TYPE_WRITE_READY
+    )
+  ) {
+    throw Exception();
+  }
+
+  sockets.second().send("m", 1, 0);
+
+  auto_Object<FDEvent> socket_event
+  = Object::cast<FDEvent>(socket_event_queue.dequeue());
+  ASSERT_EQ(socket_event->get_fd(), sockets.first());
+#if defined(__FreeBSD__) || defined(__MACH__)
+  // kqueue reports each filter as an event of its own.
+  ASSERT_NE(
+    socket_event->get_type()
+    & (FDEvent::TYPE_READ_READY | FDEvent::TYPE_WRITE_READY),
+    0
+  );
+#else
+  ASSERT_EQ(
+    socket_event->get_type(),
+    FDEvent::TYPE_READ_READY | FDEvent::TYPE_WRITE_READY
+  );
+#endif
+}
+
 TEST(SocketEventQueue, dequeue_two_SocketEvents) {
   StreamSocketPair sockets;
   FDEventQueue socket_event_queue(true);
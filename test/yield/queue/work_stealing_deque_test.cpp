@@ -0,0 +1,170 @@
+// yield/queue/work_stealing_deque_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/atomic.hpp"
+#include "yield/auto_object.hpp"
+#include "yield/queue/work_stealing_deque.hpp"
+#include "yield/thread/runnable.hpp"
+#include "yield/thread/thread.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace queue {
+using yield::thread::Runnable;
+using yield::thread::Thread;
+
+TEST(WorkStealingDeque, grow) {
+  WorkStealingDeque<uint32_t> deque(2);
+  uint32_t values[100];
+
+  for (uint32_t i = 0; i < 100; i++) {
+    values[i] = i;
+    deque.push(values[i]);
+  }
+
+  for (uint32_t i = 0; i < 50; i++) {
+    ASSERT_EQ(*deque.steal(), i);
+  }
+
+  for (uint32_t i = 99; i >= 50; i--) {
+    ASSERT_EQ(*deque.pop(), i);
+  }
+
+  ASSERT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDeque, pop) {
+  WorkStealingDeque<uint32_t> deque;
+  uint32_t values[] = { 0, 1 };
+
+  ASSERT_EQ(deque.pop(), static_cast<uint32_t*>(NULL));
+  deque.push(values[0]);
+  deque.push(values[1]);
+  ASSERT_EQ(deque.pop(), &values[1]);
+  ASSERT_EQ(deque.pop(), &values[0]);
+  ASSERT_EQ(deque.pop(), static_cast<uint32_t*>(NULL));
+}
+
+TEST(WorkStealingDeque, steal) {
+  WorkStealingDeque<uint32_t> deque;
+  uint32_t values[] = { 0, 1 };
+
+  ASSERT_EQ(deque.steal(), static_cast<uint32_t*>(NULL));
+  deque.push(values[0]);
+  deque.push(values[1]);
+  ASSERT_EQ(deque.steal(), &values[0]);
+  ASSERT_EQ(deque.steal(), &values[1]);
+  ASSERT_EQ(deque.steal(), static_cast<uint32_t*>(NULL));
+}
+
+class WorkStealingDequeTest : public ::testing::Test {
+protected:
+  class Thief : public Runnable {
+  public:
+    Thief(
+      WorkStealingDeque<uint32_t>& deque,
+      Atomic<bool>& done,
+      Atomic<uint32_t>& stolen_count,
+      Atomic<uint64_t>& stolen_sum
+    ) : deque(deque),
+      done(done),
+      stolen_count(stolen_count),
+      stolen_sum(stolen_sum)
+    { }
+
+    // yield::thread::Runnable
+    void run() {
+      for (;;) {
+        uint32_t* value = deque.steal();
+        if (value != NULL) {
+          stolen_sum.fetch_add(*value, MEMORY_ORDER_RELAXED);
+          stolen_count.fetch_add(1, MEMORY_ORDER_RELEASE);
+        } else if (done.load(MEMORY_ORDER_ACQUIRE) && deque.empty()) {
+          break;
+        } else {
+          Thread::yield();
+        }
+      }
+    }
+
+  private:
+    WorkStealingDeque<uint32_t>& deque;
+    Atomic<bool>& done;
+    Atomic<uint32_t>& stolen_count;
+    Atomic<uint64_t>& stolen_sum;
+  };
+};
+
+TEST_F(WorkStealingDequeTest, concurrent_steal) {
+  const uint32_t value_count = 100000;
+  vector<uint32_t> values(value_count);
+  WorkStealingDeque<uint32_t> deque(4);
+  Atomic<bool> done(false);
+  Atomic<uint32_t> stolen_count(0);
+  Atomic<uint64_t> stolen_sum(0);
+
+  auto_Object<Thread> thief1
+  = new Thread(*new Thief(deque, done, stolen_count, stolen_sum));
+  auto_Object<Thread> thief2
+  = new Thread(*new Thief(deque, done, stolen_count, stolen_sum));
+
+  uint32_t popped_count = 0;
+  uint64_t popped_sum = 0;
+  for (uint32_t i = 0; i < value_count; i++) {
+    values[i] = i;
+    deque.push(values[i]);
+    if (i % 3 == 0) {
+      uint32_t* value = deque.pop();
+      if (value != NULL) {
+        popped_count++;
+        popped_sum += *value;
+      }
+    }
+  }
+  done.store(true, MEMORY_ORDER_RELEASE);
+
+  uint32_t* value;
+  while ((value = deque.pop()) != NULL) {
+    popped_count++;
+    popped_sum += *value;
+  }
+
+  while (thief1->is_running() || thief2->is_running()) {
+    Thread::yield();
+  }
+
+  ASSERT_EQ(popped_count + stolen_count.load(), value_count);
+  ASSERT_EQ(
+    popped_sum + stolen_sum.load(),
+    static_cast<uint64_t>(value_count) * (value_count - 1) / 2
+  );
+}
+}
+}
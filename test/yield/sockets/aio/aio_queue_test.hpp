@@ -97,6 +97,154 @@ TYPED_TEST_P(AIOQueueTest, recv) {
   ASSERT_EQ((*buffer)[0], 'm');
 }
 
+TYPED_TEST_P(AIOQueueTest, recv_cancel) {
+  TypeParam aio_queue;
+
+  StreamSocketPair sockets;
+  if (!aio_queue.associate(sockets.first())) {
+    throw Exception();
+  }
+
+  auto_Object<recvAIOCB> aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  // For the NBIOQueue: force the first retry
+  {
+    Event* out_event = aio_queue.trydequeue();
+    ASSERT_EQ(out_event, static_cast<Event*>(NULL));
+  }
+
+  if (!aio_queue.cancel(*aiocb)) {
+    throw Exception();
+  }
+
+  {
+    auto_Object<recvAIOCB> out_aiocb
+    = Object::cast<recvAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(&out_aiocb.get(), &aiocb.get());
+    ASSERT_EQ(out_aiocb->get_error(), AIOCB::Error::CANCELED);
+    ASSERT_EQ(out_aiocb->get_return(), -1);
+  }
+
+  // The socket is usable again afterwards.
+  sockets.second().send("m", 1, 0);
+  auto_Object<recvAIOCB> next_aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  if (!aio_queue.enqueue(next_aiocb->inc_ref())) {
+    throw Exception();
+  }
+  auto_Object<recvAIOCB> out_aiocb
+  = Object::cast<recvAIOCB>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), &next_aiocb.get());
+  ASSERT_EQ(out_aiocb->get_error(), 0);
+  ASSERT_EQ(out_aiocb->get_return(), 1);
+}
+
+TYPED_TEST_P(AIOQueueTest, recv_cancel_queued) {
+  TypeParam aio_queue;
+
+  StreamSocketPair sockets;
+  if (!aio_queue.associate(sockets.first())) {
+    throw Exception();
+  }
+
+  auto_Object<recvAIOCB> aiocbs[2] = {
+    new recvAIOCB(sockets.first(), *new Buffer(2), 0),
+    new recvAIOCB(sockets.first(), *new Buffer(2), 0)
+  };
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!aio_queue.enqueue(aiocbs[i]->inc_ref())) {
+      throw Exception();
+    }
+  }
+
+  // For the NBIOQueue: force the first retry
+  {
+    Event* out_event = aio_queue.trydequeue();
+    ASSERT_EQ(out_event, static_cast<Event*>(NULL));
+  }
+
+  if (!aio_queue.cancel(*aiocbs[0])) {
+    throw Exception();
+  }
+
+  {
+    auto_Object<recvAIOCB> out_aiocb
+    = Object::cast<recvAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(&out_aiocb.get(), &aiocbs[0].get());
+    ASSERT_EQ(out_aiocb->get_error(), AIOCB::Error::CANCELED);
+  }
+
+  sockets.second().send("te", 2, 0);
+
+  auto_Object<recvAIOCB> out_aiocb
+  = Object::cast<recvAIOCB>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), &aiocbs[1].get());
+  ASSERT_EQ(out_aiocb->get_error(), 0);
+  ASSERT_EQ(out_aiocb->get_buffer(), "te");
+}
+
+TYPED_TEST_P(AIOQueueTest, recv_timeout) {
+  TypeParam aio_queue;
+
+  StreamSocketPair sockets;
+  if (!aio_queue.associate(sockets.first())) {
+    throw Exception();
+  }
+
+  auto_Object<recvAIOCB> aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  aiocb->set_timeout(Time(0.02));
+  Time start_time = Time::monotonic_now();
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  auto_Object<recvAIOCB> out_aiocb
+  = Object::cast<recvAIOCB>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), &aiocb.get());
+  ASSERT_EQ(out_aiocb->get_error(), AIOCB::Error::TIMED_OUT);
+  ASSERT_EQ(out_aiocb->get_return(), -1);
+  ASSERT_GE(Time::monotonic_now() - start_time, Time(0.02));
+}
+
+TYPED_TEST_P(AIOQueueTest, recv_timeout_completed) {
+  TypeParam aio_queue;
+
+  StreamSocketPair sockets;
+  if (!aio_queue.associate(sockets.first())) {
+    throw Exception();
+  }
+
+  auto_Object<recvAIOCB> aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  aiocb->set_timeout(Time(0.02));
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  {
+    Event* out_event = aio_queue.trydequeue();
+    ASSERT_EQ(out_event, static_cast<Event*>(NULL));
+  }
+
+  sockets.second().send("m", 1, 0);
+
+  {
+    auto_Object<recvAIOCB> out_aiocb
+    = Object::cast<recvAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(out_aiocb->get_error(), 0);
+    ASSERT_EQ(out_aiocb->get_return(), 1);
+  }
+
+  // The deadline was disarmed with the completion.
+  Event* out_event = aio_queue.timeddequeue(Time(0.05));
+  ASSERT_EQ(out_event, static_cast<Event*>(NULL));
+}
+
 TYPED_TEST_P(AIOQueueTest, recvmsg) {
   TypeParam aio_queue;
 
@@ -301,7 +449,7 @@ TYPED_TEST_P(AIOQueueTest, sendmsg) {
   ASSERT_EQ(memcmp(test_string, "test string", 11), 0);
 }
 
-REGISTER_TYPED_TEST_CASE_P(AIOQueueTest, associate, recv, recvmsg, recv_queued, recv_split, send, sendmsg, sendfile);
+REGISTER_TYPED_TEST_CASE_P(AIOQueueTest, associate, recv, recv_cancel, recv_cancel_queued, recv_timeout, recv_timeout_completed, recvmsg, recv_queued, recv_split, send, sendmsg, sendfile);
 }
 }
 }
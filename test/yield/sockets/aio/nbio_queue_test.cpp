@@ -30,6 +30,12 @@
 #include "aio_queue_test.hpp"
 #include "partial_send_stream_socket.hpp"
 #include "yield/sockets/aio/nbio_queue.hpp"
+#include "yield/sockets/aio/splice_aiocb.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#endif
 
 namespace yield {
 namespace sockets {
@@ -37,6 +43,206 @@ namespace aio {
 INSTANTIATE_TYPED_TEST_CASE_P(NBIOQueue, AIOQueueTest, NBIOQueue);
 INSTANTIATE_TYPED_TEST_CASE_P(NBIOQueue, EventQueueTest, NBIOQueue);
 
+// Send on socket until its send buffer is full, returning the number of
+// bytes sent.
+static size_t fill_send_buffer(StreamSocket& socket) {
+  if (!socket.set_blocking_mode(false)) {
+    throw Exception();
+  }
+
+  char data[4096];
+  memset(data, 0, sizeof(data));
+  size_t sent_len = 0;
+  for (;;) {
+    ssize_t send_ret = socket.send(data, sizeof(data), 0);
+    if (send_ret > 0) {
+      sent_len += static_cast<size_t>(send_ret);
+    } else if (socket.want_send()) {
+      return sent_len;
+    } else {
+      throw Exception();
+    }
+  }
+}
+
+// Recv exactly len bytes from socket.
+static void drain(StreamSocket& socket, size_t len) {
+  char data[4096];
+  while (len > 0) {
+    ssize_t recv_ret
+    = socket.recv(data, len < sizeof(data) ? len : sizeof(data), 0);
+    if (recv_ret <= 0) {
+      throw Exception();
+    }
+    len -= static_cast<size_t>(recv_ret);
+  }
+}
+
+// A StreamSocket that records the flags of its last send.
+class SendFlagsStreamSocket : public PartialSendStreamSocket {
+public:
+  SendFlagsStreamSocket(StreamSocket& stream_socket)
+    : PartialSendStreamSocket(stream_socket),
+      send_flags(-1)
+  { }
+
+public:
+  int get_send_flags() const {
+    return send_flags;
+  }
+
+public:
+  // yield::sockets::Socket
+  ssize_t send(const void* buf, size_t buflen, const MessageFlags& flags) {
+    send_flags = flags;
+    return PartialSendStreamSocket::send(buf, buflen, flags);
+  }
+
+  ssize_t
+  sendmsg(
+    const iovec* iov,
+    int iovlen,
+    const MessageFlags& flags
+  ) {
+    send_flags = flags;
+    return PartialSendStreamSocket::sendmsg(iov, iovlen, flags);
+  }
+
+private:
+  int send_flags;
+};
+
+TEST(NBIOQueue, recv_lazy_buffer) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  auto_Object<recvAIOCB> aiocb = new recvAIOCB(sockets.first(), 4, 0);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  // No buffer is attached while the recv waits for data.
+  ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+  ASSERT_FALSE(aiocb->has_buffer());
+
+  ASSERT_EQ(sockets.second().send("test", 4, 0), 4);
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&aiocb.get()));
+  ASSERT_EQ(aiocb->get_return(), 4);
+  ASSERT_TRUE(aiocb->has_buffer());
+  ASSERT_EQ(aiocb->get_buffer().size(), 4u);
+  ASSERT_EQ(memcmp(aiocb->get_buffer().data(), "test", 4), 0);
+}
+
+TEST(NBIOQueue, recv_timeout_queued) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  auto_Object<recvAIOCB> aiocb1
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  auto_Object<recvAIOCB> aiocb2
+  = new recvAIOCB(sockets.first(), *new Buffer(2), 0);
+  aiocb2->set_timeout(Time(0.05));
+  if (
+    !aio_queue.enqueue(aiocb1->inc_ref())
+    ||
+    !aio_queue.enqueue(aiocb2->inc_ref())
+  ) {
+    throw Exception();
+  }
+
+  // aiocb2's timeout only runs once aiocb1 is done and aiocb2 is started.
+  ASSERT_EQ(aio_queue.timeddequeue(Time(0.1)), static_cast<Event*>(NULL));
+
+  ASSERT_EQ(sockets.second().send("m", 1, 0), 1);
+  {
+    auto_Object<recvAIOCB> out_aiocb
+    = Object::cast<recvAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(&out_aiocb.get(), &aiocb1.get());
+    ASSERT_EQ(out_aiocb->get_return(), 1);
+  }
+
+  Time start_time = Time::monotonic_now();
+  auto_Object<recvAIOCB> out_aiocb
+  = Object::cast<recvAIOCB>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), &aiocb2.get());
+  ASSERT_EQ(out_aiocb->get_error(), AIOCB::Error::TIMED_OUT);
+  ASSERT_GE(Time::monotonic_now() - start_time, Time(0.04));
+}
+
+TEST(NBIOQueue, send_recv_full_duplex) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  size_t filled_len = fill_send_buffer(sockets.first());
+
+  // The send blocks on a full send buffer and the recv on an empty
+  // receive buffer; neither should wait on the other.
+  auto_Object<sendAIOCB> send_aiocb
+  = new sendAIOCB(sockets.first(), Buffer::copy("send"), 0);
+  if (!aio_queue.enqueue(send_aiocb->inc_ref())) {
+    throw Exception();
+  }
+  auto_Object<recvAIOCB> recv_aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(4), 0);
+  if (!aio_queue.enqueue(recv_aiocb->inc_ref())) {
+    throw Exception();
+  }
+  ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+
+  ASSERT_EQ(sockets.second().send("recv", 4, 0), 4);
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&recv_aiocb.get()));
+  ASSERT_EQ(recv_aiocb->get_return(), 4);
+
+  drain(sockets.second(), filled_len);
+  out_aiocb = auto_Object<Event>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&send_aiocb.get()));
+  ASSERT_EQ(send_aiocb->get_return(), 4);
+
+  char test[4];
+  ASSERT_EQ(sockets.second().recv(test, 4, 0), 4);
+  ASSERT_EQ(memcmp(test, "send", 4), 0);
+}
+
+TEST(NBIOQueue, send_recv_ready_together) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  size_t filled_len = fill_send_buffer(sockets.first());
+
+  auto_Object<sendAIOCB> send_aiocb
+  = new sendAIOCB(sockets.first(), Buffer::copy("send"), 0);
+  if (!aio_queue.enqueue(send_aiocb->inc_ref())) {
+    throw Exception();
+  }
+  auto_Object<recvAIOCB> recv_aiocb
+  = new recvAIOCB(sockets.first(), *new Buffer(4), 0);
+  if (!aio_queue.enqueue(recv_aiocb->inc_ref())) {
+    throw Exception();
+  }
+  ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+
+  // Make the socket readable and writable before the queue looks at it,
+  // so both directions are reported in a single event.
+  ASSERT_EQ(sockets.second().send("recv", 4, 0), 4);
+  drain(sockets.second(), filled_len);
+
+  bool recv_completed = false, send_completed = false;
+  for (uint8_t aiocb_i = 0; aiocb_i < 2; ++aiocb_i) {
+    auto_Object<Event> out_aiocb = aio_queue.dequeue();
+    if (&out_aiocb.get() == static_cast<Event*>(&recv_aiocb.get())) {
+      recv_completed = true;
+    } else if (&out_aiocb.get() == static_cast<Event*>(&send_aiocb.get())) {
+      send_completed = true;
+    }
+  }
+  ASSERT_TRUE(recv_completed);
+  ASSERT_TRUE(send_completed);
+  ASSERT_EQ(recv_aiocb->get_return(), 4);
+  ASSERT_EQ(send_aiocb->get_return(), 4);
+}
+
 TEST(NBIOQueue, partial_send) {
   NBIOQueue aio_queue;
 
@@ -81,6 +287,153 @@ public:
   }
 };
 
+TEST(NBIOQueue, partial_sendmsg_queued) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  auto_Object<PartialSendStreamSocket>
+  partial_send_stream_socket = new PartialSendStreamSocket(sockets.first());
+
+  // The queued sends are gathered into one sendmsg, which only sends one
+  // byte at a time, so the bytes sent straddle the AIOCBs.
+  auto_Object<sendAIOCB> aiocbs[] = {
+    new sendAIOCB(*partial_send_stream_socket, Buffer::copy("ab"), 0),
+    new sendAIOCB(*partial_send_stream_socket, Buffer::copy("cd"), 0)
+  };
+  for (size_t aiocb_i = 0; aiocb_i < 2; ++aiocb_i) {
+    if (!aio_queue.enqueue(aiocbs[aiocb_i]->inc_ref())) {
+      throw Exception();
+    }
+  }
+
+  for (size_t aiocb_i = 0; aiocb_i < 2; ++aiocb_i) {
+    auto_Object<sendAIOCB> out_aiocb
+    = Object::cast<sendAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(&out_aiocb.get(), &aiocbs[aiocb_i].get());
+    ASSERT_EQ(out_aiocb->get_error(), 0);
+    ASSERT_EQ(out_aiocb->get_return(), 2);
+  }
+
+  char test[4];
+  ASSERT_EQ(sockets.second().recv(test, 4, 0), 4);
+  ASSERT_EQ(memcmp(test, "abcd", 4), 0);
+}
+
+TEST(NBIOQueue, send_flags) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  auto_Object<SendFlagsStreamSocket> send_flags_stream_socket
+  = new SendFlagsStreamSocket(sockets.first());
+
+  // A lone sendAIOCB takes the single-send path rather than sendmsg
+  // coalescing; its flags must still reach the socket.
+  auto_Object<sendAIOCB> aiocb
+  = new sendAIOCB(
+    *send_flags_stream_socket,
+    Buffer::copy("m"),
+    Socket::MessageFlags::MORE
+  );
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  auto_Object<sendAIOCB> out_aiocb
+  = Object::cast<sendAIOCB>(aio_queue.dequeue());
+  ASSERT_EQ(&out_aiocb.get(), &aiocb.get());
+  ASSERT_EQ(out_aiocb->get_return(), 1);
+  ASSERT_EQ(
+    send_flags_stream_socket->get_send_flags(),
+    static_cast<int>(Socket::MessageFlags(Socket::MessageFlags::MORE))
+  );
+}
+
+TEST(NBIOQueue, send_queued) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  size_t filled_len = fill_send_buffer(sockets.first());
+
+  auto_Object<sendAIOCB> aiocbs[] = {
+    new sendAIOCB(sockets.first(), Buffer::copy("a"), 0),
+    new sendAIOCB(sockets.first(), Buffer::copy("b"), 0),
+    new sendAIOCB(sockets.first(), Buffer::copy("c"), 0)
+  };
+  for (size_t aiocb_i = 0; aiocb_i < 3; ++aiocb_i) {
+    if (!aio_queue.enqueue(aiocbs[aiocb_i]->inc_ref())) {
+      throw Exception();
+    }
+  }
+  ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+
+  // Once the send buffer drains, every queued send completes, in order.
+  drain(sockets.second(), filled_len);
+  for (size_t aiocb_i = 0; aiocb_i < 3; ++aiocb_i) {
+    auto_Object<sendAIOCB> out_aiocb
+    = Object::cast<sendAIOCB>(aio_queue.dequeue());
+    ASSERT_EQ(&out_aiocb.get(), &aiocbs[aiocb_i].get());
+    ASSERT_EQ(out_aiocb->get_error(), 0);
+    ASSERT_EQ(out_aiocb->get_return(), 1);
+  }
+
+  char test[3];
+  ASSERT_EQ(sockets.second().recv(test, 3, 0), 3);
+  ASSERT_EQ(memcmp(test, "abc", 3), 0);
+}
+
+TEST(NBIOQueue, send_zerocopy) {
+  NBIOQueue aio_queue;
+
+  TCPSocket client_socket, listen_socket;
+  if (!listen_socket.bind(SocketAddress::IN_LOOPBACK)) {
+    throw Exception();
+  }
+  if (!listen_socket.listen()) {
+    throw Exception();
+  }
+  if (!client_socket.connect(*listen_socket.getsockname())) {
+    throw Exception();
+  }
+  auto_Object<StreamSocket> server_socket = listen_socket.accept();
+#ifdef __linux__
+  ASSERT_TRUE(client_socket.setsockopt(Socket::Option::ZEROCOPY, true));
+#else
+  ASSERT_FALSE(client_socket.setsockopt(Socket::Option::ZEROCOPY, true));
+#endif
+
+  // The sendAIOCB is only dequeued once the kernel is done with its buffer.
+  auto_Object<Buffer> buffer = new Buffer(Buffer::getpagesize(), 65536);
+  for (size_t i = 0; i < buffer->capacity(); ++i) {
+    buffer->put(static_cast<char>(i));
+  }
+  auto_Object<sendAIOCB> aiocb
+  = new sendAIOCB(
+    client_socket,
+    buffer->inc_ref(),
+    Socket::MessageFlags::ZEROCOPY
+  );
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&aiocb.get()));
+  ASSERT_EQ(aiocb->get_error(), 0);
+  ASSERT_EQ(aiocb->get_return(), 65536);
+#ifdef __linux__
+  ASSERT_GT(client_socket.get_zerocopy_send_count(), 0u);
+#endif
+
+  char test[65536];
+  for (size_t recv_len = 0; recv_len < sizeof(test); ) {
+    ssize_t recv_ret
+    = server_socket->recv(test + recv_len, sizeof(test) - recv_len, 0);
+    ASSERT_GT(recv_ret, 0);
+    recv_len += static_cast<size_t>(recv_ret);
+  }
+  ASSERT_EQ(memcmp(test, buffer->data(), sizeof(test)), 0);
+}
+
 TEST_F(NBIOQueuePartialSendFileTest, partial_sendfile) {
   NBIOQueue aio_queue;
 
@@ -119,6 +472,179 @@ TEST_F(NBIOQueuePartialSendFileTest, partial_sendfile) {
   ASSERT_EQ(memcmp(test, "test", 4), 0);
 }
 
+class NBIOQueueSpliceTest : public ::testing::Test {
+public:
+  void SetUp() {
+    TearDown();
+  }
+
+  void TearDown() {
+    yield::fs::FileSystem().unlink("NBIOQueueSpliceTest.txt");
+  }
+};
+
+TEST_F(NBIOQueueSpliceTest, splice_file_to_socket) {
+  NBIOQueue aio_queue;
+
+  {
+    auto_Object<yield::fs::File> file
+    = yield::fs::FileSystem().creat("NBIOQueueSpliceTest.txt");
+    file->write("test", 4);
+  }
+
+  StreamSocketPair sockets;
+  auto_Object<yield::fs::File> file
+  = yield::fs::FileSystem().open("NBIOQueueSpliceTest.txt");
+  auto_Object<spliceAIOCB> aiocb
+  = new spliceAIOCB(*file, sockets.first(), SIZE_MAX);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&aiocb.get()));
+#ifdef __linux__
+  ASSERT_EQ(aiocb->get_error(), 0);
+  ASSERT_EQ(aiocb->get_return(), 4);
+
+  char test[4];
+  ASSERT_EQ(sockets.second().recv(test, 4, 0), 4);
+  ASSERT_EQ(memcmp(test, "test", 4), 0);
+#else
+  ASSERT_EQ(aiocb->get_return(), -1);
+#endif
+}
+
+#ifdef __linux__
+static volatile sig_atomic_t sigpipe_count = 0;
+
+static void count_sigpipe(int) {
+  ++sigpipe_count;
+}
+
+TEST_F(NBIOQueueSpliceTest, splice_file_to_closed_socket) {
+  // A broken connection fails the splice without raising SIGPIPE, even
+  // when the process handles it.
+  struct sigaction sigpipe_action, old_sigpipe_action;
+  memset(&sigpipe_action, 0, sizeof(sigpipe_action));
+  sigpipe_action.sa_handler = count_sigpipe;
+  sigemptyset(&sigpipe_action.sa_mask);
+  ASSERT_EQ(sigaction(SIGPIPE, &sigpipe_action, &old_sigpipe_action), 0);
+  sigpipe_count = 0;
+
+  NBIOQueue aio_queue;
+
+  {
+    auto_Object<yield::fs::File> file
+    = yield::fs::FileSystem().creat("NBIOQueueSpliceTest.txt");
+    file->write("test", 4);
+  }
+
+  StreamSocketPair sockets;
+  ASSERT_TRUE(sockets.second().close());
+  auto_Object<yield::fs::File> file
+  = yield::fs::FileSystem().open("NBIOQueueSpliceTest.txt");
+  auto_Object<spliceAIOCB> aiocb
+  = new spliceAIOCB(*file, sockets.first(), SIZE_MAX);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  sigaction(SIGPIPE, &old_sigpipe_action, NULL);
+  ASSERT_EQ(aiocb->get_error(), static_cast<uint32_t>(EPIPE));
+  ASSERT_EQ(sigpipe_count, 0);
+}
+#endif
+
+TEST_F(NBIOQueueSpliceTest, splice_socket_to_file) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair sockets;
+  {
+    auto_Object<yield::fs::File> file
+    = yield::fs::FileSystem().creat("NBIOQueueSpliceTest.txt");
+    auto_Object<spliceAIOCB> aiocb
+    = new spliceAIOCB(sockets.first(), *file, 4);
+    if (!aio_queue.enqueue(aiocb->inc_ref())) {
+      throw Exception();
+    }
+    ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+
+    ASSERT_EQ(sockets.second().send("test", 4, 0), 4);
+    auto_Object<Event> out_aiocb = aio_queue.dequeue();
+    ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&aiocb.get()));
+#ifdef __linux__
+    ASSERT_EQ(aiocb->get_error(), 0);
+    ASSERT_EQ(aiocb->get_return(), 4);
+#else
+    ASSERT_EQ(aiocb->get_return(), -1);
+    return;
+#endif
+  }
+
+  auto_Object<yield::fs::File> file
+  = yield::fs::FileSystem().open("NBIOQueueSpliceTest.txt");
+  char test[4];
+  ASSERT_EQ(file->read(test, 4), 4);
+  ASSERT_EQ(memcmp(test, "test", 4), 0);
+}
+
+TEST(NBIOQueue, splice_socket_to_socket) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair from_sockets, to_sockets;
+  size_t filled_len = fill_send_buffer(to_sockets.first());
+  ASSERT_EQ(from_sockets.second().send("test", 4, 0), 4);
+  ASSERT_TRUE(from_sockets.second().shutdown(false, true));
+
+  // The splice moves data until the source's end-of-file, waiting on the
+  // full destination socket along the way.
+  auto_Object<spliceAIOCB> aiocb
+  = new spliceAIOCB(from_sockets.first(), to_sockets.first(), SIZE_MAX);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+#ifdef __linux__
+  ASSERT_EQ(aio_queue.timeddequeue(0), static_cast<Event*>(NULL));
+
+  drain(to_sockets.second(), filled_len);
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(&out_aiocb.get(), static_cast<Event*>(&aiocb.get()));
+  ASSERT_EQ(aiocb->get_error(), 0);
+  ASSERT_EQ(aiocb->get_return(), 4);
+
+  char test[4];
+  ASSERT_EQ(to_sockets.second().recv(test, 4, 0), 4);
+  ASSERT_EQ(memcmp(test, "test", 4), 0);
+#else
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(aiocb->get_return(), -1);
+#endif
+}
+
+#ifdef __linux__
+TEST(NBIOQueue, splice_socket_to_socket_blocking_mode) {
+  NBIOQueue aio_queue;
+
+  StreamSocketPair from_sockets, to_sockets;
+  ASSERT_EQ(from_sockets.second().send("test", 4, 0), 4);
+  ASSERT_TRUE(from_sockets.second().shutdown(false, true));
+
+  auto_Object<spliceAIOCB> aiocb
+  = new spliceAIOCB(from_sockets.first(), to_sockets.first(), SIZE_MAX);
+  if (!aio_queue.enqueue(aiocb->inc_ref())) {
+    throw Exception();
+  }
+  auto_Object<Event> out_aiocb = aio_queue.dequeue();
+  ASSERT_EQ(aiocb->get_return(), 4);
+
+  // The destination shares its file status flags with the splice's
+  // duplicate, and must be left in the blocking mode it was in.
+  ASSERT_EQ(fcntl(to_sockets.first(), F_GETFL) & O_NONBLOCK, 0);
+}
+#endif
+
 TEST(NBIOQueue, partial_sendmsg) {
   NBIOQueue aio_queue;
 
@@ -72,6 +72,43 @@ TEST(DatagramSocket, recvmsg) {
   ASSERT_EQ(peername, *sockets.second().getpeername());
 }
 
+TEST(DatagramSocket, recvmmsg) {
+  DatagramSocketPair sockets;
+  sockets.first().write("m", 1);
+  sockets.first().write("no", 2);
+  auto_Object<Buffer> buffer0 = new Buffer(2), buffer1 = new Buffer(2);
+  Buffer* buffers[2] = { &buffer0.get(), &buffer1.get() };
+  SocketAddress peernames[2];
+  ssize_t recvmmsg_ret = sockets.second().recvmmsg(buffers, 2, 0, peernames);
+  if (recvmmsg_ret == -1) {
+    throw Exception();
+  }
+#ifdef __linux__
+  ASSERT_EQ(recvmmsg_ret, 2);
+  ASSERT_EQ(*buffer1, "no");
+#else
+  ASSERT_EQ(recvmmsg_ret, 1);
+#endif
+  ASSERT_EQ(*buffer0, "m");
+}
+
+TEST(DatagramSocket, sendmmsg) {
+  DatagramSocketPair sockets;
+  auto_Object<Buffer> buffer0 = Buffer::copy("m"), buffer1 = Buffer::copy("no");
+  const Buffer* buffers[2] = { &buffer0.get(), &buffer1.get() };
+  ssize_t sendmmsg_ret = sockets.first().sendmmsg(buffers, 2, 0, NULL);
+  if (sendmmsg_ret == -1) {
+    throw Exception();
+  }
+  ASSERT_EQ(sendmmsg_ret, 2);
+  char mno[3];
+  ASSERT_EQ(sockets.second().read(mno, 3), 1);
+  ASSERT_EQ(mno[0], 'm');
+  ASSERT_EQ(sockets.second().read(mno, 3), 2);
+  ASSERT_EQ(mno[0], 'n');
+  ASSERT_EQ(mno[1], 'o');
+}
+
 TEST(DatagramSocket, sendmsg) {
   DatagramSocketPair sockets;
   iovec iov[2];
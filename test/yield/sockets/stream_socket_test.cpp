@@ -34,6 +34,11 @@
 #include "yield/sockets/stream_socket_pair.hpp"
 #include "yield/sockets/tcp_socket.hpp"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace yield {
 namespace sockets {
 INSTANTIATE_TYPED_TEST_CASE_P(StreamSocket, ChannelTest, StreamSocketPair);
@@ -55,10 +60,51 @@ TEST(StreamSocket, accept) {
   throw Exception();
 }
 
+TEST(StreamSocket, accept_nonblocking) {
+  StreamSocket client_stream_socket(TCPSocket::DOMAIN_DEFAULT),
+               listen_stream_socket(TCPSocket::DOMAIN_DEFAULT);
+  if (listen_stream_socket.bind(SocketAddress::IN_LOOPBACK)) {
+    if (listen_stream_socket.listen()) {
+      if (client_stream_socket.connect(*listen_stream_socket.getsockname())) {
+        if (listen_stream_socket.set_blocking_mode(false)) {
+          auto_Object<StreamSocket> server_stream_socket
+          = listen_stream_socket.accept();
+
+          // The accepted socket inherits the listen socket's blocking mode.
+          char buf;
+          ASSERT_EQ(server_stream_socket->recv(&buf, 1, 0), -1);
+          ASSERT_TRUE(server_stream_socket->want_recv());
+          return;
+        }
+      }
+    }
+  }
+
+  throw Exception();
+}
+
 TEST(StreamSocket, dup) {
   auto_Object<StreamSocket> socket_ = StreamSocketPair().first().dup();
 }
 
+#ifndef _WIN32
+TEST(StreamSocket, dup_set_blocking_mode) {
+  StreamSocketPair sockets;
+  ASSERT_TRUE(sockets.first().set_blocking_mode(false));
+
+  // A duplicate descriptor shares the file description and its blocking
+  // mode, which set_blocking_mode mustn't assume is unchanged.
+  int dup_fd = dup(sockets.first());
+  ASSERT_NE(dup_fd, -1);
+  ASSERT_NE(fcntl(dup_fd, F_SETFL, fcntl(dup_fd, F_GETFL) & ~O_NONBLOCK), -1);
+  close(dup_fd);
+  ASSERT_EQ(fcntl(sockets.first(), F_GETFL) & O_NONBLOCK, 0);
+
+  ASSERT_TRUE(sockets.first().set_blocking_mode(false));
+  ASSERT_EQ(fcntl(sockets.first(), F_GETFL) & O_NONBLOCK, O_NONBLOCK);
+}
+#endif
+
 TEST(StreamSocket, getsockname_exception) {
   try {
     StreamSocket(TCPSocket::DOMAIN_DEFAULT).getsockname();
@@ -57,6 +57,16 @@ TEST(TCPSocket, get_type_name) {
   );
 }
 
+TEST(TCPSocket, setsockopt_DEFER_ACCEPT) {
+#ifdef __linux__
+  if (!TCPSocket().setsockopt(TCPSocket::Option::DEFER_ACCEPT, 1)) {
+    throw Exception();
+  }
+#else
+  ASSERT_FALSE(TCPSocket().setsockopt(TCPSocket::Option::DEFER_ACCEPT, 1));
+#endif
+}
+
 TEST(TCPSocket, setsockopt_NODELAY) {
   if (!TCPSocket().setsockopt(TCPSocket::Option::NODELAY, true)) {
     throw Exception();
@@ -0,0 +1,105 @@
+// test/yield/sockets/udp_socket_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/auto_object.hpp"
+#include "yield/exception.hpp"
+#include "yield/sockets/udp_socket.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace sockets {
+class UDPSocketTest : public ::testing::Test {
+protected:
+  void SetUp() {
+    if (
+      !receiver.bind(SocketAddress::IN_LOOPBACK)
+      ||
+      !sender.connect(*receiver.getsockname())
+    ) {
+      throw Exception();
+    }
+  }
+
+  // Send "abcdefgh" as two four-byte segments and check that they arrive
+  // as such, whether or not the receiver coalesced them.
+  void send_segments() {
+    if (!sender.setsockopt(UDPSocket::Option::SEGMENT, 4)) {
+      throw Exception();
+    }
+
+    auto_Object<Buffer> data = Buffer::copy("abcdefgh");
+    const Buffer* send_buffers[1] = { &data.get() };
+    ASSERT_EQ(sender.sendmmsg(send_buffers, 1, 0, NULL), 1);
+
+    string received;
+    while (received.size() < 8) {
+      auto_Object<Buffer> buffer0 = new Buffer(8), buffer1 = new Buffer(8);
+      Buffer* recv_buffers[2] = { &buffer0.get(), &buffer1.get() };
+      SocketAddress peernames[2];
+      uint16_t segment_sizes[2];
+      ssize_t recvmmsg_ret
+      = receiver.recvmmsg(recv_buffers, 2, 0, peernames, segment_sizes);
+      if (recvmmsg_ret <= 0) {
+        throw Exception();
+      }
+      for (ssize_t msg_i = 0; msg_i < recvmmsg_ret; ++msg_i) {
+        ASSERT_EQ(segment_sizes[msg_i], 4);
+        ASSERT_EQ(peernames[msg_i], *sender.getsockname());
+        Buffer& buffer = *recv_buffers[msg_i];
+        received.append(static_cast<char*>(buffer), buffer.size());
+      }
+    }
+    ASSERT_EQ(received, "abcdefgh");
+  }
+
+protected:
+  UDPSocket receiver, sender;
+};
+
+TEST_F(UDPSocketTest, setsockopt_GRO) {
+#ifdef __linux__
+  if (!receiver.setsockopt(UDPSocket::Option::GRO, true)) {
+    throw Exception();
+  }
+  send_segments();
+#else
+  ASSERT_FALSE(receiver.setsockopt(UDPSocket::Option::GRO, true));
+#endif
+}
+
+TEST_F(UDPSocketTest, setsockopt_SEGMENT) {
+#ifdef __linux__
+  send_segments();
+#else
+  ASSERT_FALSE(sender.setsockopt(UDPSocket::Option::SEGMENT, 4));
+#endif
+}
+}
+}
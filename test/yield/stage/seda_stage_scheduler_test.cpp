@@ -29,11 +29,178 @@
 
 #include "stage_scheduler_test.hpp"
 #include "yield/stage/seda_stage_scheduler.hpp"
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
 
 namespace yield {
 namespace stage {
+using yield::thread::ProcessorSet;
+using yield::thread::ProcessorTopology;
+
+// Records the affinity of the thread that handles its events.
+class AffinityTestEventHandler : public TestEventHandler {
+public:
+  const ProcessorSet& get_affinity() const {
+    return affinity;
+  }
+
+  // EventHandler
+  void handle(Event& event) {
+#ifdef __linux__
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+      for (uint16_t processor_i = 0; processor_i < CPU_SETSIZE; ++processor_i) {
+        if (CPU_ISSET(processor_i, &cpu_set)) {
+          affinity.set(processor_i);
+        }
+      }
+    }
+#pragma GCC diagnostic warning "-Wold-style-cast"
+#endif
+    TestEventHandler::handle(event);
+  }
+
+private:
+  ProcessorSet affinity;
+};
+
+static bool is_subset(const ProcessorSet& subset, const ProcessorSet& set) {
+  for (
+    ssize_t processor_i = subset.find_next(0);
+    processor_i != -1;
+    processor_i = subset.find_next(static_cast<uint16_t>(processor_i + 1))
+  ) {
+    if (!set.isset(static_cast<uint16_t>(processor_i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Schedule a stage with placement and wait for its thread to handle an event.
+static YO_NEW_REF Stage&
+schedule(
+  StageScheduler& stage_scheduler,
+  const StageScheduler::Placement& placement,
+  AffinityTestEventHandler& event_handler
+) {
+  Stage* stage = new Stage(event_handler.inc_ref());
+  stage_scheduler.schedule(
+    *stage,
+    StageScheduler::ConcurrencyLevel::DEFAULT,
+    placement
+  );
+  stage->handle(*new TestEvent);
+  while (event_handler.get_seen_events_count() < 1) {
+    yield::thread::Thread::sleep(0.01);
+  }
+  return *stage;
+}
+
 typedef StageSchedulerScheduleTest<SEDAStageScheduler> SEDAStageSchedulerScheduleTest;
 TEST_F(SEDAStageSchedulerScheduleTest, schedule) {
 }
+
+TEST_F(SEDAStageSchedulerScheduleTest, schedule_colocate) {
+  auto_Object<AffinityTestEventHandler> event_handler1
+  = new AffinityTestEventHandler;
+  auto_Object<AffinityTestEventHandler> event_handler2
+  = new AffinityTestEventHandler;
+  auto_Object<StageScheduler> stage_scheduler = new SEDAStageScheduler;
+  auto_Object<Stage> stage1
+  = schedule(
+      *stage_scheduler,
+      StageScheduler::Placement::SPREAD,
+      *event_handler1
+    );
+  auto_Object<Stage> stage2
+  = schedule(
+      *stage_scheduler,
+      StageScheduler::Placement::colocate(*stage1),
+      *event_handler2
+    );
+
+#ifdef __linux__
+  // stage2 shares a cache, or at least the package, with stage1.
+  const ProcessorSet& affinity1 = event_handler1->get_affinity();
+  const ProcessorSet& affinity2 = event_handler2->get_affinity();
+  ASSERT_FALSE(affinity1.empty());
+  ASSERT_TRUE(is_subset(affinity1, affinity2));
+
+  uint16_t processor_i = 0;
+  while (!affinity1.isset(processor_i)) {
+    processor_i++;
+  }
+  ProcessorTopology processor_topology;
+  ssize_t package_i
+  = ProcessorTopology::find(processor_topology.get_packages(), processor_i);
+  if (package_i != -1) {
+    ASSERT_TRUE(
+      is_subset(affinity2, *processor_topology.get_packages()[package_i])
+    );
+  }
+#endif
+}
+
+TEST_F(SEDAStageSchedulerScheduleTest, schedule_pack) {
+  auto_Object<AffinityTestEventHandler> event_handler
+  = new AffinityTestEventHandler;
+  auto_Object<StageScheduler> stage_scheduler = new SEDAStageScheduler;
+  auto_Object<Stage> stage
+  = schedule(
+      *stage_scheduler,
+      StageScheduler::Placement::pack(),
+      *event_handler
+    );
+
+#ifdef __linux__
+  ProcessorTopology processor_topology;
+  if (!processor_topology.get_numa_nodes().empty()) {
+    const ProcessorSet& numa_node = *processor_topology.get_numa_nodes()[0];
+    ASSERT_TRUE(is_subset(event_handler->get_affinity(), numa_node));
+    ASSERT_TRUE(is_subset(numa_node, event_handler->get_affinity()));
+  }
+#endif
+}
+
+TEST_F(SEDAStageSchedulerScheduleTest, schedule_pin) {
+  auto_Object<AffinityTestEventHandler> event_handler
+  = new AffinityTestEventHandler;
+  auto_Object<StageScheduler> stage_scheduler = new SEDAStageScheduler;
+  ProcessorSet processor_set;
+  processor_set.set(0);
+  auto_Object<Stage> stage
+  = schedule(
+      *stage_scheduler,
+      StageScheduler::Placement::pin(processor_set),
+      *event_handler
+    );
+
+#ifdef __linux__
+  ASSERT_EQ(event_handler->get_affinity().count(), 1);
+  ASSERT_TRUE(event_handler->get_affinity().isset(0));
+#endif
+}
+
+TEST_F(SEDAStageSchedulerScheduleTest, schedule_spread) {
+  auto_Object<AffinityTestEventHandler> event_handler
+  = new AffinityTestEventHandler;
+  auto_Object<StageScheduler> stage_scheduler = new SEDAStageScheduler;
+  auto_Object<Stage> stage
+  = schedule(
+      *stage_scheduler,
+      StageScheduler::Placement::SPREAD,
+      *event_handler
+    );
+
+#ifdef __linux__
+  // The scheduler's first SPREAD thread gets the first core.
+  ProcessorTopology processor_topology;
+  const ProcessorSet& core = *processor_topology.get_cores()[0];
+  ASSERT_TRUE(is_subset(event_handler->get_affinity(), core));
+  ASSERT_TRUE(is_subset(core, event_handler->get_affinity()));
+#endif
+}
 }
 }
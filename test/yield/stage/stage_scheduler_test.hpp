@@ -54,6 +54,21 @@ public:
       yield::thread::Thread::sleep(0.1);
     }
   }
+
+  void run(const StageScheduler::Placement& placement) {
+    auto_Object<TestEventHandler> event_handler = new TestEventHandler;
+    auto_Object<Stage> stage = new Stage(event_handler->inc_ref());
+    auto_Object<StageScheduler> stage_scheduler = new StageSchedulerType;
+    stage_scheduler->schedule(
+      *stage,
+      StageScheduler::ConcurrencyLevel::DEFAULT,
+      placement
+    );
+    stage->handle(*new TestEvent);
+    while (event_handler->get_seen_events_count() < 1) {
+      yield::thread::Thread::sleep(0.01);
+    }
+  }
 };
 }
 }
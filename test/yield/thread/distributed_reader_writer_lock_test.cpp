@@ -0,0 +1,241 @@
+// yield/thread/distributed_reader_writer_lock_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/auto_object.hpp"
+#include "yield/time.hpp"
+#include "yield/thread/distributed_reader_writer_lock.hpp"
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/reader_writer_lock.hpp"
+#include "yield/thread/runnable.hpp"
+#include "yield/thread/thread.hpp"
+#include "gtest/gtest.h"
+
+#include <iostream>
+
+namespace yield {
+namespace thread {
+template <class ReaderWriterLockType>
+class DistributedReaderWriterLockTestThread : public Runnable {
+public:
+  DistributedReaderWriterLockTestThread(
+    ReaderWriterLockType& rwlock,
+    uint32_t iteration_count,
+    uint32_t write_period,
+    uint64_t* value
+  ) : iteration_count(iteration_count),
+      rwlock(rwlock),
+      torn_read_count(0),
+      value(value),
+      write_period(write_period)
+  { }
+
+public:
+  uint32_t get_torn_read_count() const {
+    return torn_read_count;
+  }
+
+public:
+  // yield::thread::Runnable
+  void run() {
+    for (
+      uint32_t iteration_i = 1;
+      iteration_i <= iteration_count;
+      iteration_i++
+    ) {
+      if (write_period != 0 && iteration_i % write_period == 0) {
+        rwlock.wrlock();
+        value[0]++;
+        value[1]++;
+        rwlock.wrunlock();
+      } else {
+        rwlock.rdlock();
+        if (value[0] != value[1]) {
+          torn_read_count++;
+        }
+        rwlock.rdunlock();
+      }
+    }
+  }
+
+private:
+  uint32_t iteration_count;
+  ReaderWriterLockType& rwlock;
+  uint32_t torn_read_count;
+  uint64_t* value;
+  uint32_t write_period;
+};
+
+template <class ReaderWriterLockType>
+static Time
+run_threads(
+  ReaderWriterLockType& rwlock,
+  uint16_t thread_count,
+  uint32_t iteration_count,
+  uint32_t write_period,
+  uint64_t* value,
+  uint32_t& torn_read_count
+) {
+  typedef DistributedReaderWriterLockTestThread<ReaderWriterLockType>
+  TestThread;
+  vector<TestThread*> runnables;
+  vector<Thread*> threads;
+
+  Time start_time(Time::monotonic_now());
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    TestThread* runnable
+    = new TestThread(rwlock, iteration_count, write_period, value);
+    runnables.push_back(runnable);
+    threads.push_back(new Thread(Object::inc_ref(*runnable)));
+  }
+
+  torn_read_count = 0;
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    while (threads[thread_i]->is_running()) {
+      Thread::yield();
+    }
+    torn_read_count += runnables[thread_i]->get_torn_read_count();
+    Thread::dec_ref(*threads[thread_i]);
+    Runnable::dec_ref(*runnables[thread_i]);
+  }
+
+  return Time::monotonic_now() - start_time;
+}
+
+TEST(DistributedReaderWriterLock, rdlock) {
+  DistributedReaderWriterLock rwlock;
+  ASSERT_TRUE(rwlock.rdlock());
+  ASSERT_TRUE(rwlock.rdlock());
+  ASSERT_FALSE(rwlock.trywrlock());
+  rwlock.rdunlock();
+  ASSERT_FALSE(rwlock.trywrlock());
+  rwlock.rdunlock();
+  ASSERT_TRUE(rwlock.trywrlock());
+  rwlock.wrunlock();
+}
+
+TEST(DistributedReaderWriterLock, rdunlock) {
+  DistributedReaderWriterLock rwlock;
+  for (uint8_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(rwlock.rdlock());
+    rwlock.rdunlock();
+    ASSERT_TRUE(rwlock.wrlock());
+    rwlock.wrunlock();
+  }
+}
+
+TEST(DistributedReaderWriterLock, threaded) {
+  DistributedReaderWriterLock rwlock;
+  uint64_t value[2] = { 0, 0 };
+  uint32_t torn_read_count;
+  run_threads(rwlock, 4, 20000, 100, value, torn_read_count);
+  ASSERT_EQ(torn_read_count, 0u);
+  ASSERT_EQ(value[0], 4u * 200u);
+  ASSERT_EQ(value[1], value[0]);
+}
+
+TEST(DistributedReaderWriterLock, tryrdlock) {
+  DistributedReaderWriterLock rwlock;
+  ASSERT_TRUE(rwlock.tryrdlock());
+  rwlock.rdunlock();
+  ASSERT_TRUE(rwlock.wrlock());
+  ASSERT_FALSE(rwlock.tryrdlock());
+  rwlock.wrunlock();
+  ASSERT_TRUE(rwlock.tryrdlock());
+  rwlock.rdunlock();
+}
+
+TEST(DistributedReaderWriterLock, trywrlock) {
+  DistributedReaderWriterLock rwlock;
+  ASSERT_TRUE(rwlock.trywrlock());
+  ASSERT_FALSE(rwlock.trywrlock());
+  rwlock.wrunlock();
+}
+
+TEST(DistributedReaderWriterLock, wrlock) {
+  DistributedReaderWriterLock rwlock;
+  ASSERT_TRUE(rwlock.wrlock());
+  rwlock.wrunlock();
+}
+
+// Read-mostly scaling from one thread to one per online logical processor.
+// Run with --gtest_also_run_disabled_tests.
+TEST(DistributedReaderWriterLock, DISABLED_scaling) {
+  const uint32_t iteration_count = 1000000;
+  const uint32_t write_period = 1000;
+  uint16_t thread_count_max
+  = ProcessorSet::get_online_logical_processor_count();
+
+  for (
+    uint16_t thread_count = 1;
+    thread_count <= thread_count_max;
+    thread_count = thread_count < thread_count_max
+                   && thread_count * 2 > thread_count_max
+                   ? thread_count_max : thread_count * 2
+  ) {
+    uint64_t value[2] = { 0, 0 };
+    uint32_t torn_read_count;
+
+    ReaderWriterLock rwlock;
+    Time rwlock_time
+    = run_threads(
+        rwlock,
+        thread_count,
+        iteration_count,
+        write_period,
+        value,
+        torn_read_count
+      );
+
+    DistributedReaderWriterLock distributed_rwlock;
+    Time distributed_rwlock_time
+    = run_threads(
+        distributed_rwlock,
+        thread_count,
+        iteration_count,
+        write_period,
+        value,
+        torn_read_count
+      );
+
+    std::cout << thread_count << " threads: "
+              << "ReaderWriterLock "
+              << static_cast<double>(thread_count) * iteration_count
+              / rwlock_time.ns() * 1000.0
+              << " Mops/s, DistributedReaderWriterLock "
+              << static_cast<double>(thread_count) * iteration_count
+              / distributed_rwlock_time.ns() * 1000.0
+              << " Mops/s" << std::endl;
+
+    if (thread_count == thread_count_max) {
+      break;
+    }
+  }
+}
+}
+}
@@ -29,9 +29,115 @@
 
 #include "mutex_test.hpp"
 #include "yield/thread/lightweight_mutex.hpp"
+#include "yield/thread/processor_set.hpp"
+
+#include <iostream>
 
 namespace yield {
 namespace thread {
 INSTANTIATE_TYPED_TEST_CASE_P(LightweightMutex, MutexTest, LightweightMutex);
+
+template <class MutexType>
+class LightweightMutexTestThread : public Runnable {
+public:
+  LightweightMutexTestThread(
+    MutexType& mutex,
+    uint32_t iteration_count,
+    uint64_t& value
+  ) : iteration_count(iteration_count), mutex(mutex), value(value)
+  { }
+
+public:
+  // yield::thread::Runnable
+  void run() {
+    for (
+      uint32_t iteration_i = 0;
+      iteration_i < iteration_count;
+      iteration_i++
+    ) {
+      mutex.lock();
+      value++;
+      mutex.unlock();
+    }
+  }
+
+private:
+  uint32_t iteration_count;
+  MutexType& mutex;
+  uint64_t& value;
+};
+
+template <class MutexType>
+static Time
+run_threads(
+  MutexType& mutex,
+  uint16_t thread_count,
+  uint32_t iteration_count,
+  uint64_t& value
+) {
+  vector<Thread*> threads;
+
+  Time start_time(Time::monotonic_now());
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    threads.push_back(
+      new Thread(
+        *new LightweightMutexTestThread<MutexType>(
+          mutex,
+          iteration_count,
+          value
+        )
+      )
+    );
+  }
+
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    threads[thread_i]->join();
+    Thread::dec_ref(*threads[thread_i]);
+  }
+
+  return Time::monotonic_now() - start_time;
+}
+
+// Lock throughput under contention, against the pthread-based Mutex, from
+// one thread to one per online logical processor. The spin phase only
+// pays off with more than one processor.
+// Run with --gtest_also_run_disabled_tests.
+TEST(LightweightMutex, DISABLED_contended_scaling) {
+  const uint32_t iteration_count = 1000000;
+  uint16_t thread_count_max
+  = ProcessorSet::get_online_logical_processor_count();
+
+  for (
+    uint16_t thread_count = 1;
+    thread_count <= thread_count_max;
+    thread_count = thread_count < thread_count_max
+                   && thread_count * 2 > thread_count_max
+                   ? thread_count_max : thread_count * 2
+  ) {
+    uint64_t value = 0;
+
+    Mutex mutex;
+    Time mutex_time = run_threads(mutex, thread_count, iteration_count, value);
+
+    LightweightMutex lightweight_mutex;
+    Time lightweight_mutex_time
+    = run_threads(lightweight_mutex, thread_count, iteration_count, value);
+
+    ASSERT_EQ(value, 2ull * thread_count * iteration_count);
+
+    std::cout << thread_count << " threads: "
+              << "Mutex "
+              << static_cast<double>(thread_count) * iteration_count
+              / mutex_time.ns() * 1000.0
+              << " Mops/s, LightweightMutex "
+              << static_cast<double>(thread_count) * iteration_count
+              / lightweight_mutex_time.ns() * 1000.0
+              << " Mops/s" << std::endl;
+
+    if (thread_count == thread_count_max) {
+      break;
+    }
+  }
+}
 }
 }
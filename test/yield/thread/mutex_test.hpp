@@ -30,6 +30,7 @@
 #ifndef _YIELD_THREAD_MUTEX_TEST_HPP_
 #define _YIELD_THREAD_MUTEX_TEST_HPP_
 
+#include "yield/auto_object.hpp"
 #include "yield/exception.hpp"
 #include "yield/time.hpp"
 #include "yield/thread/runnable.hpp"
@@ -70,6 +71,32 @@ protected:
     MutexType& mutex;
   };
 
+  class IncrementingThread : public Runnable {
+  public:
+    IncrementingThread(MutexType& mutex, uint32_t& value, uint8_t& exit_count)
+      : exit_count(exit_count), mutex(mutex), value(value) {
+    }
+
+  public:
+    // yield::thread::Runnable
+    void run() {
+      for (uint32_t i = 0; i < 10000; i++) {
+        mutex.lock();
+        value++;
+        mutex.unlock();
+      }
+
+      mutex.lock();
+      exit_count++;
+      mutex.unlock();
+    }
+
+  private:
+    uint8_t& exit_count;
+    MutexType& mutex;
+    uint32_t& value;
+  };
+
 protected:
   MutexType* mutex;
 };
@@ -88,6 +115,44 @@ TYPED_TEST_P(MutexTest, lock) {
   // thread.join();
 }
 
+TYPED_TEST_P(MutexTest, contended) {
+  uint8_t exit_count = 0;
+  uint32_t value = 0;
+
+  auto_Object<Thread> thread1
+  = new Thread(
+    *new typename MutexTest<TypeParam>::IncrementingThread(
+      *this->mutex,
+      value,
+      exit_count
+    )
+  );
+  auto_Object<Thread> thread2
+  = new Thread(
+    *new typename MutexTest<TypeParam>::IncrementingThread(
+      *this->mutex,
+      value,
+      exit_count
+    )
+  );
+
+  for (;;) {
+    this->mutex->lock();
+    if (exit_count == 2) {
+      this->mutex->unlock();
+      break;
+    }
+    this->mutex->unlock();
+    Thread::yield();
+  }
+
+  while (thread1->is_running() || thread2->is_running()) {
+    Thread::yield();
+  }
+
+  ASSERT_EQ(value, 20000u);
+}
+
 TYPED_TEST_P(MutexTest, trylock) {
   // Thread thread(*new typename MutexTest<TypeParam>::OtherThread(*this->mutex));
 
@@ -100,7 +165,7 @@ TYPED_TEST_P(MutexTest, trylock) {
   // thread.join();
 }
 
-REGISTER_TYPED_TEST_CASE_P(MutexTest, lock, trylock);
+REGISTER_TYPED_TEST_CASE_P(MutexTest, contended, lock, trylock);
 }
 }
 
@@ -65,6 +65,18 @@ TEST(ProcessorSet, empty) {
   ASSERT_FALSE(processor_set.empty());
 }
 
+TEST(ProcessorSet, find_next) {
+  ProcessorSet processor_set;
+  ASSERT_EQ(processor_set.find_next(0), -1);
+  processor_set.set(1);
+  processor_set.set(3);
+  ASSERT_EQ(processor_set.find_next(0), 1);
+  ASSERT_EQ(processor_set.find_next(1), 1);
+  ASSERT_EQ(processor_set.find_next(2), 3);
+  ASSERT_EQ(processor_set.find_next(4), -1);
+  ASSERT_EQ(processor_set.find_next(UINT16_MAX), -1);
+}
+
 TEST(ProcessorSet, isset) {
   ProcessorSet processor_set;
   processor_set.set(0);
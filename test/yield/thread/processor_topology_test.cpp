@@ -0,0 +1,113 @@
+// yield/thread/processor_topology_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/processor_topology.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace thread {
+// Check that a grouping partitions the online logical processors.
+static void
+assert_partition(
+  const ProcessorTopology& topology,
+  const vector<ProcessorSet*>& sets
+) {
+  ASSERT_FALSE(sets.empty());
+
+  uint16_t count = 0;
+  for (size_t set_i = 0; set_i < sets.size(); set_i++) {
+    ASSERT_FALSE(sets[set_i]->empty());
+    count = static_cast<uint16_t>(count + sets[set_i]->count());
+  }
+  ASSERT_EQ(count, topology.get_online_logical_processors().count());
+
+  for (uint16_t processor_i = 0; processor_i < 1024; processor_i++) {
+    if (topology.get_online_logical_processors().isset(processor_i)) {
+      ASSERT_GE(ProcessorTopology::find(sets, processor_i), 0);
+    } else {
+      ASSERT_EQ(ProcessorTopology::find(sets, processor_i), -1);
+    }
+  }
+}
+
+TEST(ProcessorTopology, count_cores) {
+  ASSERT_EQ(
+    ProcessorTopology::count_cores(),
+    ProcessorTopology().get_cores().size()
+  );
+}
+
+TEST(ProcessorTopology, get_caches) {
+  ProcessorTopology topology;
+  ASSERT_TRUE(topology.get_caches(0).empty());
+  for (uint8_t level = 2; level <= 3; level++) {
+    if (!topology.get_caches(level).empty()) {
+      assert_partition(topology, topology.get_caches(level));
+    }
+  }
+}
+
+TEST(ProcessorTopology, get_cores) {
+  ProcessorTopology topology;
+  assert_partition(topology, topology.get_cores());
+  ASSERT_EQ(
+    topology.get_cores().size(),
+    ProcessorSet::get_online_physical_processor_count()
+  );
+  ASSERT_LE(
+    topology.get_cores().size(),
+    ProcessorSet::get_online_logical_processor_count()
+  );
+}
+
+TEST(ProcessorTopology, get_numa_nodes) {
+  ProcessorTopology topology;
+  assert_partition(topology, topology.get_numa_nodes());
+  ASSERT_EQ(
+    topology.get_numa_node_ids().size(),
+    topology.get_numa_nodes().size()
+  );
+}
+
+TEST(ProcessorTopology, get_online_logical_processors) {
+  ProcessorTopology topology;
+  ASSERT_EQ(
+    topology.get_online_logical_processors().count(),
+    ProcessorSet::get_online_logical_processor_count()
+  );
+}
+
+TEST(ProcessorTopology, get_packages) {
+  ProcessorTopology topology;
+  assert_partition(topology, topology.get_packages());
+  ASSERT_LE(topology.get_packages().size(), topology.get_cores().size());
+}
+}
+}
@@ -29,11 +29,17 @@
 
 #include "yield/auto_object.hpp"
 #include "yield/time.hpp"
+#include "yield/thread/processor_set.hpp"
 #include "yield/thread/runnable.hpp"
 #include "yield/thread/semaphore.hpp"
 #include "yield/thread/thread.hpp"
 #include "gtest/gtest.h"
 
+#include <iostream>
+#ifdef __linux__
+#include <semaphore.h>
+#endif
+
 namespace yield {
 namespace thread {
 class SemaphoreTest : public ::testing::Test {
@@ -86,12 +92,23 @@ TEST_F(SemaphoreTest, threaded) {
   thread.join();
 }
 
+TEST_F(SemaphoreTest, threaded_wait) {
+  Thread thread(*new OtherThread(exit_count, *semaphore));
+  Thread::sleep(0.05);
+  ASSERT_EQ(exit_count, 0);
+  semaphore->post();
+  while (exit_count < 1) {
+    Thread::self()->yield();
+  }
+  thread.join();
+}
+
 TEST_F(SemaphoreTest, timedwait) {
   semaphore->post();
   ASSERT_TRUE(semaphore->timedwait(0.1));
-  Time start_time(Time::now());
+  Time start_time(Time::monotonic_now());
   semaphore->timedwait(0.1);
-  Time elapsed_time(Time::now() - start_time);
+  Time elapsed_time(Time::monotonic_now() - start_time);
   ASSERT_GE(elapsed_time, Time(0.1));
 }
 
@@ -107,5 +124,126 @@ TEST_F(SemaphoreTest, wait) {
   semaphore->post();
   ASSERT_TRUE(semaphore->wait());
 }
+
+#ifdef __linux__
+// The POSIX semaphore that the futex-based Semaphore replaces on Linux.
+class POSIXSemaphore {
+public:
+  POSIXSemaphore() {
+    sem_init(&sem, 0, 0);
+  }
+
+  ~POSIXSemaphore() {
+    sem_destroy(&sem);
+  }
+
+public:
+  void post() {
+    sem_post(&sem);
+  }
+
+  bool wait() {
+    return sem_wait(&sem) == 0;
+  }
+
+private:
+  sem_t sem;
+};
+
+template <class SemaphoreType>
+class SemaphoreTestThread : public Runnable {
+public:
+  SemaphoreTestThread(SemaphoreType& semaphore, uint32_t iteration_count)
+    : iteration_count(iteration_count), semaphore(semaphore)
+  { }
+
+public:
+  // yield::thread::Runnable
+  void run() {
+    for (
+      uint32_t iteration_i = 0;
+      iteration_i < iteration_count;
+      iteration_i++
+    ) {
+      semaphore.wait();
+      semaphore.post();
+    }
+  }
+
+private:
+  uint32_t iteration_count;
+  SemaphoreType& semaphore;
+};
+
+// Pass half as many posts as there are threads around between them, so
+// that waiters block and posters wake them.
+template <class SemaphoreType>
+static Time
+run_threads(
+  SemaphoreType& semaphore,
+  uint16_t thread_count,
+  uint32_t iteration_count
+) {
+  for (uint16_t post_i = 0; post_i < (thread_count + 1) / 2; post_i++) {
+    semaphore.post();
+  }
+
+  vector<Thread*> threads;
+
+  Time start_time(Time::monotonic_now());
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    threads.push_back(
+      new Thread(
+        *new SemaphoreTestThread<SemaphoreType>(semaphore, iteration_count)
+      )
+    );
+  }
+
+  for (uint16_t thread_i = 0; thread_i < thread_count; thread_i++) {
+    threads[thread_i]->join();
+    Thread::dec_ref(*threads[thread_i]);
+  }
+
+  return Time::monotonic_now() - start_time;
+}
+
+// Wait/post throughput under contention, against sem_t, from one thread to
+// one per online logical processor.
+// Run with --gtest_also_run_disabled_tests.
+TEST(Semaphore, DISABLED_contended_scaling) {
+  const uint32_t iteration_count = 200000;
+  uint16_t thread_count_max
+  = ProcessorSet::get_online_logical_processor_count();
+
+  for (
+    uint16_t thread_count = 1;
+    thread_count <= thread_count_max;
+    thread_count = thread_count < thread_count_max
+                   && thread_count * 2 > thread_count_max
+                   ? thread_count_max : thread_count * 2
+  ) {
+    POSIXSemaphore posix_semaphore;
+    Time posix_semaphore_time
+    = run_threads(posix_semaphore, thread_count, iteration_count);
+
+    Semaphore semaphore;
+    Time semaphore_time
+    = run_threads(semaphore, thread_count, iteration_count);
+
+    std::cout << thread_count << " threads: "
+              << "sem_t "
+              << static_cast<double>(thread_count) * iteration_count
+              / posix_semaphore_time.ns() * 1000.0
+              << " Mops/s, Semaphore "
+              << static_cast<double>(thread_count) * iteration_count
+              / semaphore_time.ns() * 1000.0
+              << " Mops/s" << std::endl;
+
+    if (thread_count == thread_count_max) {
+      break;
+    }
+  }
+}
+#endif
 }
 }
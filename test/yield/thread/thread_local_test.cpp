@@ -0,0 +1,110 @@
+// yield/thread/thread_local_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/thread/runnable.hpp"
+#include "yield/thread/thread.hpp"
+#include "yield/thread/thread_local.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace thread {
+class ThreadLocalTestThread : public Runnable {
+public:
+  ThreadLocalTestThread(ThreadLocal<int>& thread_local_int)
+    : other_value(NULL), thread_local_int(thread_local_int)
+  { }
+
+public:
+  int* get_other_value() const {
+    return other_value;
+  }
+
+public:
+  // yield::thread::Runnable
+  void run() {
+    int value = 2;
+    thread_local_int.set(&value);
+    other_value = thread_local_int.get();
+    thread_local_int.set(NULL);
+  }
+
+private:
+  int* other_value;
+  ThreadLocal<int>& thread_local_int;
+};
+
+
+TEST(ThreadLocal, get) {
+  ThreadLocal<int> thread_local_int;
+  ASSERT_EQ(thread_local_int.get(), static_cast<int*>(NULL));
+}
+
+TEST(ThreadLocal, reuse) {
+  int value = 1;
+  {
+    ThreadLocal<int> thread_local_int;
+    thread_local_int.set(&value);
+  }
+
+  // A key that recycles the deleted key's slot must not see its value.
+  ThreadLocal<int> thread_local_int;
+  ASSERT_EQ(thread_local_int.get(), static_cast<int*>(NULL));
+}
+
+TEST(ThreadLocal, set) {
+  ThreadLocal<int> thread_local_int1, thread_local_int2;
+  int value1 = 1, value2 = 2;
+  thread_local_int1.set(&value1);
+  thread_local_int2.set(&value2);
+  ASSERT_EQ(thread_local_int1.get(), &value1);
+  ASSERT_EQ(thread_local_int2.get(), &value2);
+  thread_local_int1.set(NULL);
+  ASSERT_EQ(thread_local_int1.get(), static_cast<int*>(NULL));
+  ASSERT_EQ(thread_local_int2.get(), &value2);
+}
+
+TEST(ThreadLocal, threaded) {
+  ThreadLocal<int> thread_local_int;
+  int value = 1;
+  thread_local_int.set(&value);
+
+  ThreadLocalTestThread* runnable
+  = new ThreadLocalTestThread(thread_local_int);
+  auto_Object<Thread> thread(new Thread(Object::inc_ref(*runnable)));
+  while (thread->is_running()) {
+    Thread::yield();
+  }
+
+  ASSERT_NE(runnable->get_other_value(), static_cast<int*>(NULL));
+  ASSERT_NE(runnable->get_other_value(), &value);
+  ASSERT_EQ(thread_local_int.get(), &value);
+  Runnable::dec_ref(*runnable);
+}
+}
+}
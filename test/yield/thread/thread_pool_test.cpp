@@ -0,0 +1,177 @@
+// yield/thread/thread_pool_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "yield/atomic.hpp"
+#include "yield/thread/processor_set.hpp"
+#include "yield/thread/runnable.hpp"
+#include "yield/thread/task_group.hpp"
+#include "yield/thread/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace yield {
+namespace thread {
+class ThreadPoolTest : public ::testing::Test {
+protected:
+  class CountingRunnable : public Runnable {
+  public:
+    CountingRunnable(Atomic<uint32_t>& run_count)
+      : run_count(run_count)
+    { }
+
+    // yield::thread::Runnable
+    void run() {
+      run_count.fetch_add(1, MEMORY_ORDER_RELAXED);
+    }
+
+  private:
+    Atomic<uint32_t>& run_count;
+  };
+};
+
+TEST_F(ThreadPoolTest, affinity) {
+  ProcessorSet logical_processor_set;
+  logical_processor_set.set(0);
+  ThreadPool thread_pool(0, &logical_processor_set);
+  ASSERT_EQ(thread_pool.get_thread_count(), 1);
+
+  Atomic<uint32_t> run_count(0);
+  TaskGroup task_group(thread_pool);
+  task_group.run(*new CountingRunnable(run_count));
+  task_group.wait();
+  ASSERT_EQ(run_count.load(), 1u);
+}
+
+TEST_F(ThreadPoolTest, get_thread_count) {
+  ThreadPool thread_pool(3);
+  ASSERT_EQ(thread_pool.get_thread_count(), 3);
+}
+
+TEST_F(ThreadPoolTest, nested_task_group) {
+  ThreadPool thread_pool(2);
+  Atomic<uint32_t> run_count(0);
+
+  TaskGroup outer_task_group(thread_pool);
+  for (uint8_t outer_i = 0; outer_i < 8; outer_i++) {
+    outer_task_group.run(
+      [&thread_pool, &run_count]() {
+        TaskGroup inner_task_group(thread_pool);
+        for (uint8_t inner_i = 0; inner_i < 8; inner_i++) {
+          inner_task_group.run(
+            [&run_count]() {
+              run_count.fetch_add(1, MEMORY_ORDER_RELAXED);
+            }
+          );
+        }
+        inner_task_group.wait();
+      }
+    );
+  }
+  outer_task_group.wait();
+
+  ASSERT_EQ(run_count.load(), 64u);
+}
+
+TEST_F(ThreadPoolTest, parallel_for) {
+  ThreadPool thread_pool(4);
+  vector<uint32_t> values(10000, 0);
+
+  thread_pool.parallel_for(
+    0,
+    values.size(),
+    64,
+    [&values](size_t begin, size_t end) {
+      ASSERT_LE(end - begin, 64u);
+      for (size_t i = begin; i < end; i++) {
+        values[i]++;
+      }
+    }
+  );
+
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(values[i], 1u);
+  }
+}
+
+TEST_F(ThreadPoolTest, parallel_reduce) {
+  ThreadPool thread_pool(4);
+
+  uint64_t sum
+  = thread_pool.parallel_reduce(
+      1,
+      100001,
+      100,
+      static_cast<uint64_t>(0),
+      [](size_t begin, size_t end) {
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; i++) {
+          sum += i;
+        }
+        return sum;
+      },
+      [](uint64_t left, uint64_t right) {
+        return left + right;
+      }
+    );
+
+  ASSERT_EQ(sum, 5000050000ull);
+
+  ASSERT_EQ(
+    thread_pool.parallel_reduce(
+      0,
+      0,
+      1,
+      42,
+      [](size_t, size_t) {
+        return 0;
+      },
+      [](int left, int right) {
+        return left + right;
+      }
+    ),
+    42
+  );
+}
+
+TEST_F(ThreadPoolTest, submit) {
+  Atomic<uint32_t> run_count(0);
+
+  {
+    ThreadPool thread_pool(2);
+    TaskGroup task_group(thread_pool);
+    for (uint16_t task_i = 0; task_i < 1000; task_i++) {
+      task_group.run(*new CountingRunnable(run_count));
+    }
+    task_group.wait();
+  }
+
+  ASSERT_EQ(run_count.load(), 1000u);
+}
+}
+}
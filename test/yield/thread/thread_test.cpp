@@ -30,11 +30,32 @@
 #include "yield/auto_object.hpp"
 #include "yield/exception.hpp"
 #include "yield/time.hpp"
+#include "yield/thread/runnable.hpp"
 #include "yield/thread/thread.hpp"
 #include "gtest/gtest.h"
 
 namespace yield {
 namespace thread {
+class ThreadSelfTestThread : public Runnable {
+public:
+  ThreadSelfTestThread() : self(NULL) { }
+
+public:
+  Thread* get_self() const {
+    return self;
+  }
+
+public:
+  // yield::thread::Runnable
+  void run() {
+    self = &Thread::self().get();
+  }
+
+private:
+  Thread* self;
+};
+
+
 TEST(Thread, key_create) {
   uintptr_t key = Thread::self()->key_create();
   if (key != 0) {
@@ -62,6 +83,22 @@ TEST(Thread, getspecific) {
   Thread::self()->key_delete(key);
 }
 
+TEST(Thread, self) {
+  auto_Object<Thread> self1 = Thread::self();
+  auto_Object<Thread> self2 = Thread::self();
+  ASSERT_EQ(&self1.get(), &self2.get());
+}
+
+TEST(Thread, self_started) {
+  ThreadSelfTestThread* runnable = new ThreadSelfTestThread;
+  auto_Object<Thread> thread(new Thread(Object::inc_ref(*runnable)));
+  while (thread->is_running()) {
+    Thread::yield();
+  }
+  ASSERT_EQ(runnable->get_self(), &thread.get());
+  Runnable::dec_ref(*runnable);
+}
+
 TEST(Thread, set_name) {
   Thread::self()->set_name("test thread");
 }
@@ -79,9 +116,9 @@ TEST(Thread, setspecific) {
 }
 
 TEST(Thread, sleep) {
-  Time start_time(Time::now());
+  Time start_time(Time::monotonic_now());
   Thread::sleep(0.05);
-  Time slept_time(Time::now() - start_time);
+  Time slept_time(Time::monotonic_now() - start_time);
   ASSERT_GE(slept_time.ms(), 50);
 }
 
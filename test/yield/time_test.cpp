@@ -30,6 +30,10 @@
 #include "yield/time.hpp"
 #include "gtest/gtest.h"
 
+#ifdef __linux__
+#include <time.h>
+#endif
+
 namespace yield {
 #ifndef _WIN32
 TEST(Time, as_timespec) {
@@ -51,6 +55,17 @@ TEST(Time, as_timeval) {
 }
 #endif
 
+TEST(Time, coarse_monotonic_now) {
+  Time time1(Time::coarse_monotonic_now());
+  Time monotonic_time(Time::monotonic_now());
+  // The coarse clock lags by at most a few ticks.
+  ASSERT_LE(time1, monotonic_time);
+  ASSERT_LT(monotonic_time - time1, Time(0.1));
+
+  Time time2(Time::coarse_monotonic_now());
+  ASSERT_GE(time2, time1);
+}
+
 TEST(Time, copy) {
   Time timeout(10.0);
   Time timeout_copy(timeout);
@@ -73,6 +88,29 @@ TEST(Time, from_timeval) {
 }
 #endif
 
+TEST(Time, monotonic_now) {
+  Time time1(Time::monotonic_now());
+  ASSERT_GT(static_cast<uint64_t>(time1), 0);
+  for (uint32_t i = 0; i < 100000; i++) {
+    Time time2(Time::monotonic_now());
+    ASSERT_GE(time2, time1);
+    time1 = time2;
+  }
+
+#ifdef __linux__
+  // A calibrated TSC should stay close to CLOCK_MONOTONIC.
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  Time clock_monotonic_time(ts);
+  time1 = Time::monotonic_now();
+  if (time1 >= clock_monotonic_time) {
+    ASSERT_LT(time1 - clock_monotonic_time, Time(0.01));
+  } else {
+    ASSERT_LT(clock_monotonic_time - time1, Time(0.01));
+  }
+#endif
+}
+
 TEST(Time, now) {
   Time time1(Time::now());
   ASSERT_GT(static_cast<uint64_t>(time1), 0);
@@ -0,0 +1,244 @@
+// yield/timer_wheel_test.cpp
+
+// Copyright (c) 2012 Minor Gordon
+// All rights reserved
+
+// This source file is part of the Yield project.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the Yield project nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Minor Gordon BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "yield/auto_object.hpp"
+#include "yield/event_handler.hpp"
+#include "yield/timer_wheel.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+
+namespace yield {
+class TimerEventCounter : public EventHandler {
+public:
+  TimerEventCounter() : timer_event_count(0) { }
+
+  size_t get_timer_event_count() const {
+    return timer_event_count;
+  }
+
+  // yield::EventHandler
+  void handle(YO_NEW_REF Event& event) {
+    ASSERT_EQ(event.get_type_id(), TimerEvent::TYPE_ID);
+    timer_event_count++;
+    Event::dec_ref(event);
+  }
+
+private:
+  size_t timer_event_count;
+};
+
+
+TEST(TimerWheel, arm) {
+  TimerWheel timer_wheel;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.01));
+  timer_wheel.arm(timer_event->inc_ref());
+  ASSERT_TRUE(timer_event->is_armed());
+  ASSERT_EQ(timer_wheel.get_armed_timer_count(), 1u);
+  ASSERT_LE(timer_wheel.get_next_timeout(Time::monotonic_now()), Time(0.011));
+}
+
+TEST(TimerWheel, arm_again) {
+  TimerWheel timer_wheel;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.01));
+  timer_wheel.arm(timer_event->inc_ref());
+  timer_wheel.arm(timer_event->inc_ref());
+  ASSERT_EQ(timer_wheel.get_armed_timer_count(), 1u);
+  timer_wheel.cancel(*timer_event);
+  ASSERT_FALSE(timer_event->is_armed());
+}
+
+TEST(TimerWheel, cancel) {
+  TimerWheel timer_wheel;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.01));
+  ASSERT_FALSE(timer_wheel.cancel(*timer_event));
+  timer_wheel.arm(timer_event->inc_ref());
+  ASSERT_TRUE(timer_wheel.cancel(*timer_event));
+  ASSERT_FALSE(timer_event->is_armed());
+  ASSERT_TRUE(timer_wheel.empty());
+  ASSERT_EQ(
+    timer_wheel.get_next_timeout(Time::monotonic_now()),
+    Time::FOREVER
+  );
+  ASSERT_EQ(
+    timer_wheel.expire(timer_event->get_deadline() + Time(1.0)),
+    static_cast<TimerEvent*>(NULL)
+  );
+}
+
+TEST(TimerWheel, destructor) {
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(1.0));
+  {
+    TimerWheel timer_wheel;
+    timer_wheel.arm(timer_event->inc_ref());
+  }
+  ASSERT_FALSE(timer_event->is_armed());
+}
+
+TEST(TimerWheel, expire) {
+  TimerWheel timer_wheel;
+  auto_Object<TimerEvent> timer_event = new TimerEvent(Time(0.01));
+  timer_wheel.arm(timer_event->inc_ref());
+  Time deadline = timer_event->get_deadline();
+
+  ASSERT_EQ(
+    timer_wheel.expire(deadline - Time::NS_IN_US),
+    static_cast<TimerEvent*>(NULL)
+  );
+  ASSERT_TRUE(timer_event->is_armed());
+
+  // Due on the first tick at or after its deadline.
+  TimerEvent* expired_timer_event
+  = timer_wheel.expire(deadline + Time::NS_IN_MS);
+  ASSERT_EQ(expired_timer_event, &timer_event.get());
+  TimerEvent::dec_ref(*expired_timer_event);
+  ASSERT_FALSE(timer_event->is_armed());
+  ASSERT_TRUE(timer_wheel.empty());
+}
+
+TEST(TimerWheel, expire_EventHandler) {
+  TimerWheel timer_wheel;
+  for (uint32_t i = 1; i <= 10; i++) {
+    timer_wheel.arm(*new TimerEvent(Time(i * Time::NS_IN_MS)));
+  }
+
+  TimerEventCounter timer_event_counter;
+  Time now = Time::monotonic_now();
+  timer_wheel.expire(now + Time(0.0055), timer_event_counter);
+  ASSERT_GE(timer_event_counter.get_timer_event_count(), 4u);
+  ASSERT_LE(timer_event_counter.get_timer_event_count(), 6u);
+  timer_wheel.expire(now + Time(1.0), timer_event_counter);
+  ASSERT_EQ(timer_event_counter.get_timer_event_count(), 10u);
+  ASSERT_TRUE(timer_wheel.empty());
+}
+
+TEST(TimerWheel, expire_far) {
+  // Far enough out to cascade through every wheel.
+  TimerWheel timer_wheel(Time(Time::NS_IN_US));
+  Time timeout(static_cast<uint64_t>(1) << 40);
+  auto_Object<TimerEvent> timer_event = new TimerEvent(timeout);
+  timer_wheel.arm(timer_event->inc_ref());
+  Time deadline = timer_event->get_deadline();
+
+  Time next_timeout = timer_wheel.get_next_timeout(Time::monotonic_now());
+  ASSERT_LE(next_timeout, timeout);
+  ASSERT_EQ(
+    timer_wheel.expire(deadline - Time::NS_IN_US),
+    static_cast<TimerEvent*>(NULL)
+  );
+  ASSERT_LE(
+    timer_wheel.get_next_timeout(deadline - Time::NS_IN_US),
+    2 * Time::NS_IN_US
+  );
+
+  TimerEvent* expired_timer_event
+  = timer_wheel.expire(deadline + Time::NS_IN_US);
+  ASSERT_EQ(expired_timer_event, &timer_event.get());
+  TimerEvent::dec_ref(*expired_timer_event);
+}
+
+TEST(TimerWheel, expire_random) {
+  // Compare against brute force at arbitrary points in time.
+  TimerWheel timer_wheel(Time(Time::NS_IN_US));
+  vector<TimerEvent*> timer_events;
+  srand(42);
+  for (uint32_t i = 0; i < 1000; i++) {
+    uint64_t timeout_us = static_cast<uint64_t>(rand()) % 1000000;
+    if (i % 10 == 0) {
+      timeout_us *= 1000;
+    }
+    TimerEvent* timer_event = new TimerEvent(Time(timeout_us * 1000));
+    timer_wheel.arm(timer_event->inc_ref());
+    timer_events.push_back(timer_event);
+  }
+
+  Time now = Time::monotonic_now();
+  size_t expired_timer_count = 0;
+  while (expired_timer_count < timer_events.size()) {
+    now += static_cast<uint64_t>(rand()) % (100 * Time::NS_IN_MS);
+    if (expired_timer_count % 10 == 0) {
+      now += static_cast<uint64_t>(rand()) % (100 * Time::NS_IN_S);
+    }
+
+    for (;;) {
+      TimerEvent* timer_event = timer_wheel.expire(now);
+      if (timer_event == NULL) {
+        break;
+      }
+      ASSERT_LE(timer_event->get_deadline(), now);
+      expired_timer_count++;
+      TimerEvent::dec_ref(*timer_event);
+    }
+
+    for (
+      vector<TimerEvent*>::const_iterator timer_event_i
+      = timer_events.begin();
+      timer_event_i != timer_events.end();
+      ++timer_event_i
+    ) {
+      if ((*timer_event_i)->is_armed()) {
+        // Late by at most a tick.
+        ASSERT_GT(
+          (*timer_event_i)->get_deadline(),
+          now - Time::NS_IN_US
+        );
+      }
+    }
+  }
+
+  ASSERT_TRUE(timer_wheel.empty());
+  for (
+    vector<TimerEvent*>::iterator timer_event_i = timer_events.begin();
+    timer_event_i != timer_events.end();
+    ++timer_event_i
+  ) {
+    TimerEvent::dec_ref(**timer_event_i);
+  }
+}
+
+TEST(TimerWheel, expire_periodic) {
+  TimerWheel timer_wheel;
+  auto_Object<TimerEvent> timer_event
+  = new TimerEvent(Time(0.01), Time(0.01));
+  timer_wheel.arm(timer_event->inc_ref());
+  Time deadline = timer_event->get_deadline();
+
+  for (uint32_t i = 0; i < 3; i++) {
+    TimerEvent* expired_timer_event
+    = timer_wheel.expire(deadline + Time::NS_IN_MS);
+    ASSERT_EQ(expired_timer_event, &timer_event.get());
+    TimerEvent::dec_ref(*expired_timer_event);
+    ASSERT_TRUE(timer_event->is_armed());
+    ASSERT_EQ(timer_event->get_deadline(), deadline + Time(0.01));
+    deadline = timer_event->get_deadline();
+  }
+
+  ASSERT_TRUE(timer_wheel.cancel(*timer_event));
+}
+}